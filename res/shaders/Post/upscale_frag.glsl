@@ -0,0 +1,38 @@
+#version 420
+
+layout(location = 0) in vec2 inUV;
+
+out vec4 frag_color;
+
+layout (binding = 0) uniform sampler2D s_screenTex;
+
+//Size of a single texel in the low resolution source
+uniform vec2 u_SourceTexelSize;
+
+//How much sharpening to apply after the bilinear upscale
+//0 is plain bilinear
+uniform float u_Sharpness = 0.5;
+
+void main() 
+{
+	//Hardware bilinear does the actual upscale
+	vec4 source = texture(s_screenTex, inUV);
+
+	//Cross shaped neighbourhood in source texels
+	vec3 north = texture(s_screenTex, inUV + vec2(0.0, u_SourceTexelSize.y)).rgb;
+	vec3 south = texture(s_screenTex, inUV - vec2(0.0, u_SourceTexelSize.y)).rgb;
+	vec3 east = texture(s_screenTex, inUV + vec2(u_SourceTexelSize.x, 0.0)).rgb;
+	vec3 west = texture(s_screenTex, inUV - vec2(u_SourceTexelSize.x, 0.0)).rgb;
+
+	//Scale the sharpening back where the neighbourhood already has a lot of contrast
+	//so edges don't ring (the same idea as contrast adaptive sharpening)
+	vec3 minCol = min(source.rgb, min(min(north, south), min(east, west)));
+	vec3 maxCol = max(source.rgb, max(max(north, south), max(east, west)));
+	vec3 amount = sqrt(clamp(min(minCol, 1.0 - maxCol) / max(maxCol, vec3(0.0001)), 0.0, 1.0));
+	vec3 weight = -amount * mix(0.0, 0.2, u_Sharpness);
+
+	vec3 sharpened = (source.rgb + (north + south + east + west) * weight) / (1.0 + 4.0 * weight);
+
+	frag_color.rgb = clamp(sharpened, 0.0, 1.0);
+	frag_color.a = source.a;
+}
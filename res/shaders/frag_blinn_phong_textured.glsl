@@ -31,10 +31,23 @@ uniform float u_TextureMix;
 
 uniform vec3  u_CamPos;
 
+// How far this mesh has faded over to its impostor, 0 draws all of it
+uniform float u_ImpostorFade;
+
 out vec4 frag_color;
 
+const float BAYER[16] = float[](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+
 // https://learnopengl.com/Advanced-Lighting/Advanced-Lighting
 void main() {
+	// Dither away the pixels the impostor is taking over
+	if (u_ImpostorFade > 0.0)
+	{
+		ivec2 pixel = ivec2(gl_FragCoord.xy) % 4;
+		if ((BAYER[pixel.y * 4 + pixel.x] + 0.5) / 16.0 < u_ImpostorFade)
+			discard;
+	}
+
 	// Lecture 5
 	vec3 ambient;
 	if (u_SpecularOnly || u_NoLight)
@@ -0,0 +1,24 @@
+#version 410
+
+layout(location = 0) in vec2 inUV;
+layout(location = 1) in float inFade;
+
+uniform sampler2D s_Atlas;
+// Light on the impostors, they were captured without any
+uniform vec3 u_Lighting;
+
+out vec4 frag_color;
+
+const float BAYER[16] = float[](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+
+void main() {
+	// The mesh keeps the pixels under the fade and the impostor gets the rest, so together they cover everything once
+	ivec2 pixel = ivec2(gl_FragCoord.xy) % 4;
+	if ((BAYER[pixel.y * 4 + pixel.x] + 0.5) / 16.0 >= inFade)
+		discard;
+
+	vec4 colour = texture(s_Atlas, inUV);
+	if (colour.a < 0.5)
+		discard;
+	frag_color = vec4(colour.rgb * u_Lighting, 1.0);
+}
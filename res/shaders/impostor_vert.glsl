@@ -0,0 +1,44 @@
+#version 410
+
+// One corner of the card, x from -0.5 to 0.5 across it and y from 0 to 1 up it
+layout(location = 0) in vec2 inCorner;
+// Per instance, where it stands and how far it's turned around z (radians)
+layout(location = 1) in vec4 inPositionYaw;
+// Per instance, its scale and how far it's faded over from the mesh
+layout(location = 2) in vec2 inScaleFade;
+
+layout(location = 0) out vec2 outUV;
+layout(location = 1) out float outFade;
+
+uniform mat4 u_ViewProjection;
+uniform vec3 u_CamPos;
+
+// How many views are in the atlas, spread evenly around z
+uniform int u_Views;
+// Width and height of the card, where its bottom is, and where its middle is (in the mesh's space)
+uniform vec2 u_Size;
+uniform float u_Bottom;
+uniform vec2 u_Centre;
+
+const float PI = 3.14159265;
+
+void main() {
+	float yaw = inPositionYaw.w;
+	float scale = inScaleFade.x;
+	vec2 turned = vec2(cos(yaw) * u_Centre.x - sin(yaw) * u_Centre.y, sin(yaw) * u_Centre.x + cos(yaw) * u_Centre.y);
+	vec3 middle = inPositionYaw.xyz + vec3(turned * scale, 0.0);
+
+	// The card stays upright and turns to face the camera
+	vec2 toCamera = u_CamPos.xy - middle.xy;
+	vec2 dir = length(toCamera) > 0.0001 ? normalize(toCamera) : vec2(1.0, 0.0);
+	vec3 right = vec3(-dir.y, dir.x, 0.0);
+
+	vec3 position = middle + right * (inCorner.x * u_Size.x * scale) + vec3(0.0, 0.0, (u_Bottom + inCorner.y * u_Size.y) * scale);
+	gl_Position = u_ViewProjection * vec4(position, 1.0);
+
+	// The view that was taken from closest to where the camera is, in the mesh's own space
+	float angle = atan(dir.y, dir.x) - yaw;
+	float view = mod(floor(angle / (2.0 * PI) * float(u_Views) + 0.5), float(u_Views));
+	outUV = vec2((view + inCorner.x + 0.5) / float(u_Views), inCorner.y);
+	outFade = inScaleFade.y;
+}
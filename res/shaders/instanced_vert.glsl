@@ -0,0 +1,33 @@
+#version 410
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec2 inUV;
+// Per instance (see InstanceBatch), the model matrix takes slots 4 to 7 and the normal matrix 8 to 10
+layout(location = 4) in mat4 inModel;
+layout(location = 8) in mat3 inNormalMatrix;
+
+layout(location = 0) out vec3 outPos;
+layout(location = 1) out vec3 outColor;
+layout(location = 2) out vec3 outNormal;
+layout(location = 3) out vec2 outUV;
+
+uniform mat4 u_ViewProjection;
+
+// Same as vertex_shader.glsl, but each instance brings its own matrices
+void main() {
+	vec4 worldPos = inModel * vec4(inPosition, 1.0);
+	gl_Position = u_ViewProjection * worldPos;
+
+	// Pass vertex pos in world space to frag shader
+	outPos = worldPos.xyz;
+
+	// Normals
+	outNormal = inNormalMatrix * inNormal;
+
+	// Pass our UV coords to the fragment shader
+	outUV = inUV;
+
+	outColor = inColor;
+}
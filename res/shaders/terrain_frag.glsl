@@ -0,0 +1,27 @@
+#version 410
+
+layout(location = 0) in vec3 inPos;
+layout(location = 1) in vec3 inNormal;
+
+uniform float u_HeightScale;
+
+out vec4 frag_color;
+
+// The terrain has its own sun rather than the scene's light
+const vec3 SUN = normalize(vec3(0.4, 0.3, 0.85));
+const vec3 GRASS = vec3(0.30, 0.45, 0.20);
+const vec3 ROCK = vec3(0.45, 0.42, 0.38);
+const vec3 SNOW = vec3(0.92, 0.92, 0.95);
+
+void main() {
+	vec3 normal = normalize(inNormal);
+
+	// Rock on the steep parts, snow on the flatter high ones
+	float slope = 1.0 - normal.z;
+	vec3 colour = mix(GRASS, ROCK, smoothstep(0.2, 0.4, slope));
+	float snow = smoothstep(0.55, 0.8, inPos.z / max(u_HeightScale, 0.001)) * (1.0 - smoothstep(0.25, 0.45, slope));
+	colour = mix(colour, SNOW, snow);
+
+	float light = 0.5 + 0.5 * max(dot(normal, SUN), 0.0);
+	frag_color = vec4(colour * light, 1.0);
+}
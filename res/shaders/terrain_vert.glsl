@@ -0,0 +1,50 @@
+#version 410
+
+// A corner of the shared grid mesh, 0 to u_GridSize each way
+layout(location = 0) in vec2 inGrid;
+
+layout(location = 0) out vec3 outPos;
+layout(location = 1) out vec3 outNormal;
+
+uniform mat4 u_ViewProjection;
+uniform vec3 u_CamPos;
+
+// The chunk's heights, and where the chunk is
+uniform sampler2D s_Height;
+uniform vec2 u_ChunkOrigin;
+uniform float u_ChunkSize;
+// Quads across the chunk's heights
+uniform float u_Resolution;
+
+// Quads across the grid mesh, and the node it's drawing
+uniform float u_GridSize;
+uniform vec2 u_NodeOrigin;
+uniform float u_NodeSize;
+// Distances where the vertices start and finish sliding onto the next level's grid
+uniform vec2 u_MorphRange;
+
+float Height(vec2 position) {
+	vec2 texel = (position - u_ChunkOrigin) / u_ChunkSize * u_Resolution;
+	return textureLod(s_Height, (texel + 0.5) / (u_Resolution + 1.0), 0.0).r;
+}
+
+void main() {
+	vec2 position = u_NodeOrigin + inGrid / u_GridSize * u_NodeSize;
+	float distance = length(vec3(position, Height(position)) - u_CamPos);
+
+	// Odd vertices slide back onto the even ones before them, so by the end of the range this is the next level's grid
+	float morph = clamp((distance - u_MorphRange.x) / (u_MorphRange.y - u_MorphRange.x), 0.0, 1.0);
+	vec2 grid = inGrid - fract(inGrid * 0.5) * 2.0 * morph;
+	position = u_NodeOrigin + grid / u_GridSize * u_NodeSize;
+
+	float height = Height(position);
+	float spacing = u_ChunkSize / u_Resolution;
+	float left = Height(position - vec2(spacing, 0.0));
+	float right = Height(position + vec2(spacing, 0.0));
+	float down = Height(position - vec2(0.0, spacing));
+	float up = Height(position + vec2(0.0, spacing));
+
+	outPos = vec3(position, height);
+	outNormal = normalize(vec3(left - right, down - up, 2.0 * spacing));
+	gl_Position = u_ViewProjection * vec4(outPos, 1.0);
+}
@@ -1,8 +1,8 @@
 #include "CameraControlBehaviour.h"
 
-#include "Application.h"
 #include "Timing.h"
 #include "Transform.h"
+#include "Utilities/Input.h"
 
 
 void CameraControlBehaviour::OnLoad(entt::handle entity) {
@@ -12,12 +12,12 @@ void CameraControlBehaviour::OnLoad(entt::handle entity) {
 void CameraControlBehaviour::Update(entt::handle entity)
 {
 	float dt = Timing::Instance().DeltaTime;
-	GLFWwindow* window = Application::Instance().Window;
+	//Input comes through Input so it can be recorded and replayed
 	double mx, my;
-	glfwGetCursorPos(window, &mx, &my);
+	Input::GetCursorPos(mx, my);
 	Transform& transform = entity.get<Transform>();
 
-	if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_1) == GLFW_PRESS) {
+	if (Input::IsMouseButtonDown(GLFW_MOUSE_BUTTON_1)) {
 		if (!_isPressed) {
 			_isPressed = true;
 			_prevMouseX = mx;
@@ -37,26 +37,26 @@ void CameraControlBehaviour::Update(entt::handle entity)
 	}
 
 	glm::vec3 movement = glm::vec3(0.0f);
-	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
+	if (Input::IsKeyDown(GLFW_KEY_A)) {
 		movement.x += -1.0f * dt;
 	}
-	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
+	if (Input::IsKeyDown(GLFW_KEY_D)) {
 		movement.x += 1.0f * dt;
 	}
-	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
+	if (Input::IsKeyDown(GLFW_KEY_W)) {
 		movement.z += -1.0f * dt;
 	}
-	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
+	if (Input::IsKeyDown(GLFW_KEY_S)) {
 		movement.z += 1.0f * dt;
 	}
-	if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) {
+	if (Input::IsKeyDown(GLFW_KEY_SPACE)) {
 		movement.y += 1.0f * dt;
 	}
-	if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS) {
+	if (Input::IsKeyDown(GLFW_KEY_LEFT_CONTROL)) {
 		movement.y += -1.0f * dt;
 	}
 	movement *= 2.0f;
-	if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT)) {
+	if (Input::IsKeyDown(GLFW_KEY_LEFT_SHIFT)) {
 		movement *= 1.5f;
 	}
 	transform.MoveLocal(movement);
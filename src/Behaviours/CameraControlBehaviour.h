@@ -10,8 +10,8 @@ public:
 	void Update(entt::handle entity) override;
 
 protected:
-	double _prevMouseX, _prevMouseY;
-	float _rotationX, _rotationY;
-	bool _isPressed;
+	double _prevMouseX = 0.0, _prevMouseY = 0.0;
+	float _rotationX = 0.0f, _rotationY = 0.0f;
+	bool _isPressed = false;
 	glm::quat _initial;
 };
@@ -0,0 +1,60 @@
+#include "CameraPathBehaviour.h"
+#include "Transform.h"
+#include "Timing.h"
+#include <cmath>
+
+void CameraPathBehaviour::OnLoad(entt::handle entity)
+{
+	Reset();
+}
+
+void CameraPathBehaviour::Reset()
+{
+	_nextPoint = 1;
+	_hasStarted = false;
+}
+
+void CameraPathBehaviour::Update(entt::handle entity)
+{
+	if (Points.empty())
+		return;
+
+	Transform& transform = entity.get<Transform>();
+
+	//Snap to the start of the path the first time through
+	if (!_hasStarted)
+	{
+		_position = Points[0];
+		_nextPoint = Points.size() > 1 ? 1 : 0;
+		_hasStarted = true;
+	}
+
+	//Whole laps end up back in the same place, so only walk what's left over
+	//*If every point is in the same place there's nowhere to go, and the walk below would never finish
+	float loopLength = 0.0f;
+	for (size_t i = 0; i < Points.size(); i++)
+		loopLength += glm::length(Points[(i + 1) % Points.size()] - Points[i]);
+	float distance = loopLength > 0.0f ? fmodf(Speed * Timing::Instance().DeltaTime, loopLength) : 0.0f;
+
+	//Walk the distance for this frame along the path, carrying over past waypoints
+	while (distance > 0.0f && Points.size() > 1)
+	{
+		glm::vec3 toNext = Points[_nextPoint] - _position;
+		float remaining = glm::length(toNext);
+
+		if (remaining > distance)
+		{
+			_position += toNext * (distance / remaining);
+			distance = 0.0f;
+		}
+		else
+		{
+			_position = Points[_nextPoint];
+			distance -= remaining;
+			_nextPoint = (_nextPoint + 1) % int(Points.size());
+		}
+	}
+
+	transform.SetLocalPosition(_position);
+	transform.LookAt(Target);
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "IBehaviour.h"
+#include <GLM/glm.hpp>
+#include <vector>
+
+//Flies an object along a looping set of waypoints while looking at a target
+//*Works like FollowPathBehaviour, but also aims the object, so it can drive a camera
+class CameraPathBehaviour : public IBehaviour
+{
+public:
+	CameraPathBehaviour() = default;
+	~CameraPathBehaviour() = default;
+
+	void OnLoad(entt::handle entity) override;
+	void Update(entt::handle entity) override;
+
+	//Goes back to the first waypoint
+	void Reset();
+
+	//Points to fly through (loops back to the first)
+	std::vector<glm::vec3> Points;
+	//The point to keep looking at
+	glm::vec3 Target = glm::vec3(0.0f);
+	//Units per second
+	float Speed = 1.0f;
+
+protected:
+	int _nextPoint = 1;
+	glm::vec3 _position = glm::vec3(0.0f);
+	bool _hasStarted = false;
+};
@@ -9,5 +9,5 @@ void RotateObjectBehaviour::Update(entt::handle entity)
 	float dt = Timing::Instance().DeltaTime;
 	Transform& transform = entity.get<Transform>();
 
-	transform.RotateLocal(0, 0, 1.0f);
+	transform.RotateLocal(0, 0, Speed * dt);
 }
@@ -9,4 +9,7 @@ public:
 	~RotateObjectBehaviour() = default;
 
 	void Update(entt::handle entity) override;
+
+	//Degrees per second
+	float Speed = 60.0f;
 };
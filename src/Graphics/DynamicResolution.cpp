@@ -0,0 +1,145 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+void DynamicResolution::Update(float frameTimeMs)
+{
+	if (!Enabled)
+	{
+		_state = State::Disabled;
+		return;
+	}
+
+	//Smooth out the frame time so single spikes don't drop the resolution
+	if (_filteredFrameTime <= 0.0f)
+		_filteredFrameTime = frameTimeMs;
+	else
+		_filteredFrameTime = _filteredFrameTime * Smoothing + frameTimeMs * (1.0f - Smoothing);
+
+	//Relative error, positive means we have headroom
+	_error = (TargetFrameTime - _filteredFrameTime) / TargetFrameTime;
+	if (std::abs(_error) < Deadband)
+		_error = 0.0f;
+
+	float minFraction = MinScale * MinScale;
+	float maxFraction = MaxScale * MaxScale;
+
+	//Integrate, but don't let it wind up past what the output can reach
+	_integral = std::clamp(_integral + _error, -1.0f / IntegralGain, 1.0f / IntegralGain);
+
+	float fraction = 1.0f + ProportionalGain * _error + IntegralGain * _integral;
+	if (fraction <= minFraction || fraction >= maxFraction)
+	{
+		//Back the integral off so it sits right at the limit instead of beyond it
+		_integral -= _error;
+	}
+	float previous = _pixelFraction;
+	_pixelFraction = std::clamp(fraction, minFraction, maxFraction);
+
+	if (_pixelFraction <= minFraction)
+		_state = State::AtMinimum;
+	else if (_pixelFraction >= maxFraction)
+		_state = State::AtMaximum;
+	else if (_pixelFraction > previous)
+		_state = State::Raising;
+	else if (_pixelFraction < previous)
+		_state = State::Lowering;
+	else
+		_state = State::Holding;
+}
+
+void DynamicResolution::Apply(PostEffect* sceneBuffer, unsigned fullWidth, unsigned fullHeight)
+{
+	//Snap the scale to our step size so small changes don't reallocate the buffer
+	float scale = Enabled ? GetScale() : 1.0f;
+	scale = std::clamp(std::round(scale / StepSize) * StepSize, MinScale, MaxScale);
+
+	unsigned width = std::max(1u, unsigned(std::lround(fullWidth * scale)));
+	unsigned height = std::max(1u, unsigned(std::lround(fullHeight * scale)));
+
+	//The resize callback reshapes the buffer to full size, so check against the buffer too
+	if (width == sceneBuffer->GetWidth() && height == sceneBuffer->GetHeight() &&
+		fullWidth == _fullWidth && fullHeight == _fullHeight)
+	{
+		return;
+	}
+
+	//Bilinear filtering on the scene buffer is what gives us the upscale
+	sceneBuffer->SetFilter(GL_LINEAR);
+	sceneBuffer->Reshape(width, height);
+
+	_appliedScale = scale;
+	_fullWidth = fullWidth;
+	_fullHeight = fullHeight;
+	_width = width;
+	_height = height;
+}
+
+void DynamicResolution::Reset()
+{
+	_pixelFraction = MaxScale * MaxScale;
+	_filteredFrameTime = 0.0f;
+	_error = 0.0f;
+	_integral = 0.0f;
+	_state = Enabled ? State::Holding : State::Disabled;
+}
+
+float DynamicResolution::GetScale() const
+{
+	return std::sqrt(_pixelFraction);
+}
+
+float DynamicResolution::GetAppliedScale() const
+{
+	return _appliedScale;
+}
+
+float DynamicResolution::GetFilteredFrameTime() const
+{
+	return _filteredFrameTime;
+}
+
+float DynamicResolution::GetError() const
+{
+	return _error;
+}
+
+float DynamicResolution::GetIntegral() const
+{
+	return _integral;
+}
+
+unsigned DynamicResolution::GetWidth() const
+{
+	return _width;
+}
+
+unsigned DynamicResolution::GetHeight() const
+{
+	return _height;
+}
+
+DynamicResolution::State DynamicResolution::GetState() const
+{
+	return _state;
+}
+
+const char* DynamicResolution::GetStateName() const
+{
+	switch (_state)
+	{
+	case State::Disabled: return "Disabled";
+	case State::Holding: return "Holding";
+	case State::Raising: return "Raising";
+	case State::Lowering: return "Lowering";
+	case State::AtMinimum: return "At Minimum";
+	case State::AtMaximum: return "At Maximum";
+	default: return "Unknown";
+	}
+}
+
+bool DynamicResolution::IsScaled() const
+{
+	return _width != _fullWidth || _height != _fullHeight;
+}
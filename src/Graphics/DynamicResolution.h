@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Graphics/Post/PostEffect.h"
+
+//Drives the resolution of the scene buffer from the frame time
+//*Uses a PI controller on the fraction of pixels rendered, since
+//*fill cost scales with area and not with the per axis scale
+class DynamicResolution
+{
+public:
+	//Where the controller currently is
+	enum class State
+	{
+		Disabled,
+		Holding,
+		Raising,
+		Lowering,
+		AtMinimum,
+		AtMaximum
+	};
+
+	//Feeds the controller the last frame time (in ms) and updates the scale
+	void Update(float frameTimeMs);
+
+	//Resizes the scene buffer so it matches the current scale of the full resolution
+	//*Only reshapes when the quantized size actually changes
+	void Apply(PostEffect* sceneBuffer, unsigned fullWidth, unsigned fullHeight);
+
+	//Resets the controller back to full resolution
+	void Reset();
+
+	//Getters
+	float GetScale() const;
+	float GetAppliedScale() const;
+	float GetFilteredFrameTime() const;
+	float GetError() const;
+	float GetIntegral() const;
+	unsigned GetWidth() const;
+	unsigned GetHeight() const;
+	State GetState() const;
+	const char* GetStateName() const;
+	//Is the scene buffer smaller than the screen (and needs upscaling)
+	bool IsScaled() const;
+
+	//Is the controller allowed to change the scale
+	bool Enabled = true;
+	//Frame time we're trying to hit (in ms)
+	float TargetFrameTime = 1000.0f / 60.0f;
+	//Range the per axis scale is kept within
+	float MinScale = 0.5f;
+	float MaxScale = 1.0f;
+	//Controller gains (applied to the relative frame time error)
+	float ProportionalGain = 0.25f;
+	float IntegralGain = 0.04f;
+	//Relative error that is treated as on target
+	float Deadband = 0.05f;
+	//Smoothing for the measured frame time (0 - 1, higher is smoother)
+	float Smoothing = 0.9f;
+	//Size of a resolution step, so we don't reallocate every frame
+	float StepSize = 0.05f;
+
+private:
+	//Fraction of the pixels being rendered (scale squared)
+	float _pixelFraction = 1.0f;
+	float _filteredFrameTime = 0.0f;
+	float _error = 0.0f;
+	float _integral = 0.0f;
+	State _state = State::Holding;
+
+	//What the scene buffer is actually set to
+	float _appliedScale = 1.0f;
+	unsigned _fullWidth = 0;
+	unsigned _fullHeight = 0;
+	unsigned _width = 0;
+	unsigned _height = 0;
+};
@@ -1,4 +1,5 @@
 #include "Framebuffer.h"
+#include "Utilities/ResourceTracker.h"
 
 GLuint Framebuffer::_fullscreenQuadVBO = 0;
 GLuint Framebuffer::_fullscreenQuadVAO = 0;
@@ -14,8 +15,11 @@ DepthTarget::~DepthTarget()
 
 void DepthTarget::Unload()
 {
+	ResourceTracker::Untrack(ResourceTracker::Category::FramebufferDepth, _texture.GetHandle());
 	//Deletes the texture at the specific handle
 	glDeleteTextures(1, &_texture.GetHandle());
+	//Zero it so unloading twice can't delete a texture that reused the name
+	_texture.GetHandle() = GL_NONE;
 }
 
 ColorTarget::~ColorTarget()
@@ -26,7 +30,13 @@ ColorTarget::~ColorTarget()
 
 void ColorTarget::Unload()
 {
-	glDeleteTextures(_numAttachments, &_textures[0].GetHandle());
+	//The handles aren't next to each other in memory, so they get deleted one at a time
+	for (unsigned i = 0; i < _numAttachments; i++)
+	{
+		ResourceTracker::Untrack(ResourceTracker::Category::FramebufferColour, _textures[i].GetHandle());
+		glDeleteTextures(1, &_textures[i].GetHandle());
+		_textures[i].GetHandle() = GL_NONE;
+	}
 }
 
 Framebuffer::Framebuffer()
@@ -35,6 +45,7 @@ Framebuffer::Framebuffer()
 
 Framebuffer::~Framebuffer()
 {
+	ReleaseReadbacks();
 	Unload();
 }
 
@@ -82,6 +93,8 @@ void Framebuffer::Init()
 
 		//Sets up as a framebuffer texture
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, _depth._texture.GetHandle(), 0);
+		ResourceTracker::Track(ResourceTracker::Category::FramebufferDepth, _depth._texture.GetHandle(),
+			ResourceTracker::TextureBytes(_depth._texture.GetHandle()));
 
 		glBindTexture(GL_TEXTURE_2D, GL_NONE);
 	}
@@ -115,6 +128,8 @@ void Framebuffer::Init()
 
 			//Sets up as a framebuffer texture
 			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, _color._textures[i].GetHandle(), 0);
+			ResourceTracker::Track(ResourceTracker::Category::FramebufferColour, _color._textures[i].GetHandle(),
+				ResourceTracker::TextureBytes(_color._textures[i].GetHandle()));
 		}
 
 		delete[] textureHandles;
@@ -189,6 +204,27 @@ void Framebuffer::SetSize(unsigned width, unsigned height)
 	_height = height;
 }
 
+void Framebuffer::SetFilter(GLenum filter)
+{
+	_filter = filter;
+
+	//If we're not initialized the filter gets picked up in Init
+	if (!_isInit)
+		return;
+
+	if (_depthActive)
+	{
+		glTextureParameteri(_depth._texture.GetHandle(), GL_TEXTURE_MIN_FILTER, _filter);
+		glTextureParameteri(_depth._texture.GetHandle(), GL_TEXTURE_MAG_FILTER, _filter);
+	}
+
+	for (unsigned i = 0; i < _color._numAttachments; i++)
+	{
+		glTextureParameteri(_color._textures[i].GetHandle(), GL_TEXTURE_MIN_FILTER, _filter);
+		glTextureParameteri(_color._textures[i].GetHandle(), GL_TEXTURE_MAG_FILTER, _filter);
+	}
+}
+
 void Framebuffer::SetViewport() const
 {
 	glViewport(0, 0, _width, _height);
@@ -231,6 +267,123 @@ void Framebuffer::DrawToBackbuffer()
 	glBindFramebuffer(GL_READ_FRAMEBUFFER, GL_NONE);
 }
 
+void Framebuffer::ReadColorPixels(unsigned colorBuffer, std::vector<uint8_t>& pixels) const
+{
+	pixels.resize(size_t(_width) * _height * 4);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, _FBO);
+	glReadBuffer(GL_COLOR_ATTACHMENT0 + colorBuffer);
+	//Rows are tightly packed
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, _width, _height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, GL_NONE);
+}
+
+bool Framebuffer::ReadColorPixelsAsync(unsigned colorBuffer, ReadbackCallback callback, uint64_t tag)
+{
+	//Free up anything that's finished first
+	PollReadbacks();
+
+	//Waiting here would stall, so drop the frame instead
+	if (_readbacksInFlight == READBACK_BUFFERS)
+	{
+		_droppedReadbacks++;
+		return false;
+	}
+
+	PendingReadback& readback = _readbacks[_readbackWrite];
+	size_t size = size_t(_width) * _height * 4;
+
+	//(Re)create the pixel buffer when the framebuffer size changes
+	if (readback._pbo == GL_NONE)
+		glGenBuffers(1, &readback._pbo);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, readback._pbo);
+	if (readback._size != size)
+	{
+		glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+		readback._size = size;
+		ResourceTracker::Track(ResourceTracker::Category::ReadbackBuffer, readback._pbo, size);
+	}
+
+	//With a pack buffer bound the pointer is an offset into it, so this returns straight away
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, _FBO);
+	glReadBuffer(GL_COLOR_ATTACHMENT0 + colorBuffer);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, _width, _height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, GL_NONE);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, GL_NONE);
+
+	readback._fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	readback._width = _width;
+	readback._height = _height;
+	readback._tag = tag;
+	readback._callback = callback;
+
+	_readbackWrite = (_readbackWrite + 1) % READBACK_BUFFERS;
+	_readbacksInFlight++;
+	return true;
+}
+
+void Framebuffer::PollReadbacks(bool wait)
+{
+	while (_readbacksInFlight > 0)
+	{
+		PendingReadback& readback = _readbacks[_readbackRead];
+
+		//Flushing makes sure the fence actually gets to the GPU, the timeout is in ns
+		GLenum status = glClientWaitSync(readback._fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? 1000000000 : 0);
+		if (status == GL_TIMEOUT_EXPIRED && wait)
+			continue;
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+			break;
+
+		glDeleteSync(readback._fence);
+		readback._fence = nullptr;
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readback._pbo);
+		const uint8_t* pixels = (const uint8_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, readback._size, GL_MAP_READ_BIT);
+		if (pixels != nullptr)
+		{
+			if (readback._callback)
+				readback._callback(pixels, readback._width, readback._height, readback._tag);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, GL_NONE);
+		readback._callback = nullptr;
+
+		_readbackRead = (_readbackRead + 1) % READBACK_BUFFERS;
+		_readbacksInFlight--;
+	}
+}
+
+int Framebuffer::GetPendingReadbacks() const
+{
+	return _readbacksInFlight;
+}
+
+uint64_t Framebuffer::GetDroppedReadbacks() const
+{
+	return _droppedReadbacks;
+}
+
+void Framebuffer::ReleaseReadbacks()
+{
+	for (int i = 0; i < READBACK_BUFFERS; i++)
+	{
+		if (_readbacks[i]._fence != nullptr)
+			glDeleteSync(_readbacks[i]._fence);
+		if (_readbacks[i]._pbo != GL_NONE)
+		{
+			ResourceTracker::Untrack(ResourceTracker::Category::ReadbackBuffer, _readbacks[i]._pbo);
+			glDeleteBuffers(1, &_readbacks[i]._pbo);
+		}
+		_readbacks[i] = PendingReadback();
+	}
+	_readbackWrite = 0;
+	_readbackRead = 0;
+	_readbacksInFlight = 0;
+}
+
 void Framebuffer::Clear()
 {
 	glBindFramebuffer(GL_FRAMEBUFFER, _FBO);
@@ -295,6 +448,8 @@ void Framebuffer::InitFullscreenQuad()
 	glBindBuffer(GL_ARRAY_BUFFER, _fullscreenQuadVBO);
 	//Buffers the vbo data
 	glBufferData(GL_ARRAY_BUFFER, vertexSize + texCoordSize, VBO_DATA, GL_STATIC_DRAW);
+	ResourceTracker::Track(ResourceTracker::Category::VertexArray, _fullscreenQuadVAO, 0);
+	ResourceTracker::Track(ResourceTracker::Category::VertexBuffer, _fullscreenQuadVBO, vertexSize + texCoordSize);
 
 #pragma warning(push)
 #pragma warning(disable : 4312)
@@ -1,5 +1,6 @@
 #pragma once
 #include <vector>
+#include <functional>
 #include <Texture2D.h>
 #include <Shader.h>
 
@@ -29,9 +30,27 @@ struct ColorTarget
 	unsigned int _numAttachments = 0;
 };
 
+//A readback that's waiting on the GPU
+struct PendingReadback
+{
+	//Pixel buffer the pixels get copied into
+	GLuint _pbo = GL_NONE;
+	size_t _size = 0;
+	//Signalled once the copy is done
+	GLsync _fence = nullptr;
+	unsigned _width = 0;
+	unsigned _height = 0;
+	uint64_t _tag = 0;
+	std::function<void(const uint8_t*, unsigned, unsigned, uint64_t)> _callback;
+};
+
 class Framebuffer
 {
 public:
+	//Gets the pixels (RGBA8, bottom row first), their size, and the tag the readback was started with
+	//*The pixels are only valid during the call
+	typedef std::function<void(const uint8_t* pixels, unsigned width, unsigned height, uint64_t tag)> ReadbackCallback;
+
 	Framebuffer();
 	~Framebuffer();
 
@@ -64,6 +83,10 @@ public:
 	//Sets the size of the framebuffer
 	void SetSize(unsigned width, unsigned height);
 
+	//Sets the filter used when sampling the targets as textures
+	//*Applies to existing targets as well as ones created later
+	void SetFilter(GLenum filter);
+
 	//Sets the viewport to fullscreen (using the size of framebuffer)
 	void SetViewport() const;
 	
@@ -78,6 +101,27 @@ public:
 	//Draws the contents of the framebuffer to the back buffer
 	void DrawToBackbuffer();
 
+	//Reads a color target back into RGBA8 pixels (bottom row first)
+	//*This is synchronous, it waits for the GPU to finish the framebuffer
+	void ReadColorPixels(unsigned colorBuffer, std::vector<uint8_t>& pixels) const;
+
+	//Starts reading a color target back into a pixel buffer without waiting on the GPU
+	//*The callback gets the pixels from PollReadbacks once the copy is done (usually 2-3 frames later)
+	//*Returns false (and drops the frame) if every buffer in the ring is still in use
+	bool ReadColorPixelsAsync(unsigned colorBuffer, ReadbackCallback callback, uint64_t tag = 0);
+	//Hands finished readbacks to their callbacks, oldest first
+	//*With wait set it blocks until all of them are done (for flushing at the end)
+	void PollReadbacks(bool wait = false);
+	//How many readbacks are still waiting on the GPU
+	int GetPendingReadbacks() const;
+	//How many async readbacks were dropped because the ring was full
+	uint64_t GetDroppedReadbacks() const;
+	//Deletes the pixel buffers (any readbacks in flight are thrown away)
+	void ReleaseReadbacks();
+
+	//Size of the pixel buffer ring, enough for the GPU to be a few frames behind
+	static const int READBACK_BUFFERS = 3;
+
 	//Clears the framebuffer using our clear flag
 	void Clear();
 	//Checks to make sure the framebuffer is... OK
@@ -109,6 +153,14 @@ protected:
 	//Clearflag is nothing by default
 	GLbitfield _clearFlag = 0;
 
+	//Ring of pixel buffers for async readback
+	PendingReadback _readbacks[READBACK_BUFFERS];
+	//Next buffer to write into, and the oldest one still in flight
+	int _readbackWrite = 0;
+	int _readbackRead = 0;
+	int _readbacksInFlight = 0;
+	uint64_t _droppedReadbacks = 0;
+
 	//Is the framebuffer initialized
 	bool _isInit = false;
 	//Depth attachment?
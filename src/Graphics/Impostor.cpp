@@ -0,0 +1,107 @@
+#include "Impostor.h"
+
+#include <algorithm>
+#include <GLM/gtc/matrix_transform.hpp>
+
+ImpostorAtlas::sptr ImpostorAtlas::Create(const VertexArrayObject::sptr& vao, const MeshData& mesh, const ShaderMaterial::sptr& material, int views, int tileSize)
+{
+	glm::vec3 min, max;
+	if (!mesh.GetBounds(min, max) || vao == nullptr || material == nullptr || material->Shader == nullptr)
+		return nullptr;
+
+	sptr impostor = std::make_shared<ImpostorAtlas>();
+	impostor->_views = std::max(views, 1);
+
+	//The card turns around the middle of the mesh, so it has to be as wide as the furthest point from there
+	impostor->_centre = glm::vec2(min.x + max.x, min.y + max.y) * 0.5f;
+	float radius = 0.0f;
+	for (const VertexPosNormTexCol& vertex : mesh.Vertices)
+		radius = std::max(radius, glm::length(glm::vec2(vertex.Position.x, vertex.Position.y) - impostor->_centre));
+	impostor->_size = glm::vec2(2.0f * radius, max.z - min.z);
+	impostor->_bottom = min.z;
+
+	impostor->_atlas.AddColorTarget(GL_RGBA8);
+	impostor->_atlas.AddDepthTarget();
+	impostor->_atlas.SetFilter(GL_LINEAR);
+	impostor->_atlas.Init(unsigned(tileSize * impostor->_views), unsigned(tileSize));
+
+	//Put everything back afterwards, this can happen partway through a frame
+	GLint previousFramebuffer = 0;
+	GLint previousViewport[4];
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+	glGetIntegerv(GL_VIEWPORT, previousViewport);
+	GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+
+	//Clear to nothing, so the card can cut around the mesh
+	impostor->_atlas.Bind();
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glEnable(GL_DEPTH_TEST);
+
+	//Unlit, the lighting gets put on when the card is drawn
+	const Shader::sptr& shader = material->Shader;
+	shader->Bind();
+	GLint noLight = 0;
+	GLint noLightLocation = glGetUniformLocation(shader->GetHandle(), "u_NoLight");
+	if (noLightLocation != -1)
+		glGetUniformiv(shader->GetHandle(), noLightLocation, &noLight);
+	shader->SetUniform("u_NoLight", 1);
+	shader->SetUniform("u_ImpostorFade", 0.0f);
+	material->Apply();
+
+	glm::vec3 target(impostor->_centre, 0.0f);
+	float distance = radius + impostor->_size.y + 1.0f;
+	glm::mat4 projection = glm::ortho(-radius, radius, min.z, max.z, 0.01f, 2.0f * distance);
+	for (int i = 0; i < impostor->_views; i++)
+	{
+		float angle = glm::radians(360.0f) * i / impostor->_views;
+		glm::vec3 eye = target + glm::vec3(cosf(angle), sinf(angle), 0.0f) * distance;
+		glm::mat4 view = glm::lookAt(eye, target, glm::vec3(0.0f, 0.0f, 1.0f));
+
+		glViewport(i * tileSize, 0, tileSize, tileSize);
+		shader->SetUniformMatrix("u_ModelViewProjection", projection * view);
+		shader->SetUniformMatrix("u_Model", glm::mat4(1.0f));
+		shader->SetUniformMatrix("u_NormalMatrix", glm::mat3(1.0f));
+		shader->SetUniformMatrix("u_View", view);
+		shader->SetUniform("u_CamPos", eye);
+		vao->Render();
+	}
+
+	shader->SetUniform("u_NoLight", int(noLight));
+	glBindFramebuffer(GL_FRAMEBUFFER, GLuint(previousFramebuffer));
+	glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+	if (!depthTest)
+		glDisable(GL_DEPTH_TEST);
+
+	return impostor;
+}
+
+void ImpostorAtlas::Bind(int textureSlot) const
+{
+	_atlas.BindColorAsTexture(0, textureSlot);
+}
+
+void ImpostorAtlas::Unbind(int textureSlot) const
+{
+	_atlas.UnbindTexture(textureSlot);
+}
+
+int ImpostorAtlas::GetViews() const
+{
+	return _views;
+}
+
+glm::vec2 ImpostorAtlas::GetSize() const
+{
+	return _size;
+}
+
+float ImpostorAtlas::GetBottom() const
+{
+	return _bottom;
+}
+
+glm::vec2 ImpostorAtlas::GetCentre() const
+{
+	return _centre;
+}
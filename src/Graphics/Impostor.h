@@ -0,0 +1,39 @@
+#pragma once
+#include <GLM/glm.hpp>
+#include <memory>
+
+#include <ShaderMaterial.h>
+#include <VertexArrayObject.h>
+
+#include "Graphics/Framebuffer.h"
+#include "Graphics/MeshData.h"
+
+//Pictures of a mesh taken from a ring of directions around z, side by side in one texture
+//*Far away copies of the mesh can then be drawn as a single card facing the camera, showing the closest picture
+class ImpostorAtlas
+{
+public:
+	typedef std::shared_ptr<ImpostorAtlas> sptr;
+
+	//Renders the mesh with its material (unlit) from views directions, each into a tileSize square
+	//*mesh is only used for its size, vao is what gets drawn. Returns nullptr if there's nothing to draw it with
+	static sptr Create(const VertexArrayObject::sptr& vao, const MeshData& mesh, const ShaderMaterial::sptr& material, int views = 8, int tileSize = 128);
+
+	void Bind(int textureSlot) const;
+	void Unbind(int textureSlot) const;
+
+	int GetViews() const;
+	//Width and height of the card in the mesh's units
+	glm::vec2 GetSize() const;
+	//Height of the bottom of the card
+	float GetBottom() const;
+	//Middle of the card on the ground, in the mesh's space
+	glm::vec2 GetCentre() const;
+
+private:
+	Framebuffer _atlas;
+	int _views = 0;
+	glm::vec2 _size = glm::vec2(0.0f);
+	float _bottom = 0.0f;
+	glm::vec2 _centre = glm::vec2(0.0f);
+};
@@ -0,0 +1,114 @@
+#include "InstanceBatch.h"
+
+#include <cmath>
+#include <cstddef>
+
+#include <GameObjectTag.h>
+#include <RendererComponent.h>
+#include <Transform.h>
+
+#include "Graphics/StaticBatch.h"
+#include "Utilities/ResourceTracker.h"
+
+void InstanceBatch::Instances::Render(const VertexArrayObject::sptr& vao) const
+{
+	glBindVertexArray(vao->GetHandle());
+	glDrawElementsInstanced(GL_TRIANGLES, IndexCount, GL_UNSIGNED_INT, nullptr, Count);
+	glBindVertexArray(GL_NONE);
+}
+
+InstanceBatch::InstanceBatch(float cellSize) :
+	_cellSize(cellSize > 0.0f ? cellSize : 1.0f)
+{
+}
+
+void InstanceBatch::Add(const MeshData& mesh, const ShaderMaterial::sptr& material, const glm::mat4& model)
+{
+	glm::vec3 position = glm::vec3(model[3]);
+	int x = int(std::floor(position.x / _cellSize));
+	int y = int(std::floor(position.y / _cellSize));
+
+	Cell& cell = _cells[std::make_tuple(&mesh, material.get(), x, y)];
+	cell.Mesh = &mesh;
+	cell.Material = material;
+	cell.Instances.push_back({ model, glm::transpose(glm::inverse(glm::mat3(model))) });
+}
+
+void InstanceBatch::Build(entt::registry& registry, std::vector<entt::entity>& entities)
+{
+	for (auto& pair : _cells)
+	{
+		Cell& cell = pair.second;
+		glm::vec3 meshMin, meshMax;
+		if (cell.Instances.empty() || !cell.Mesh->GetBounds(meshMin, meshMax))
+			continue;
+
+		//The box around every copy's corners
+		StaticBatch::Bounds bounds = { glm::vec3(INFINITY), glm::vec3(-INFINITY) };
+		for (const Instance& instance : cell.Instances)
+		{
+			for (int i = 0; i < 8; i++)
+			{
+				glm::vec3 corner(i & 1 ? meshMax.x : meshMin.x, i & 2 ? meshMax.y : meshMin.y, i & 4 ? meshMax.z : meshMin.z);
+				glm::vec3 world = glm::vec3(instance.Model * glm::vec4(corner, 1.0f));
+				bounds.Min = glm::min(bounds.Min, world);
+				bounds.Max = glm::max(bounds.Max, world);
+			}
+		}
+
+		//Each cell gets its own copy of the mesh, so the instance buffer can be part of its vertex array
+		VertexArrayObject::sptr vao = cell.Mesh->Bake();
+		Instances instances;
+		instances.Count = GLsizei(cell.Instances.size());
+		instances.IndexCount = GLsizei(cell.Mesh->Indices.size());
+		GLuint handle = GL_NONE;
+		glGenBuffers(1, &handle);
+		instances.Buffer = std::shared_ptr<GLuint>(new GLuint(handle), [](GLuint* buffer) {
+			ResourceTracker::Untrack(ResourceTracker::Category::VertexBuffer, *buffer);
+			glDeleteBuffers(1, buffer);
+			delete buffer;
+		});
+
+		glBindVertexArray(vao->GetHandle());
+		glBindBuffer(GL_ARRAY_BUFFER, handle);
+		glBufferData(GL_ARRAY_BUFFER, cell.Instances.size() * sizeof(Instance), cell.Instances.data(), GL_STATIC_DRAW);
+		//Matrices go in one slot per column
+		for (GLuint i = 0; i < 4; i++)
+		{
+			glEnableVertexAttribArray(MODEL_SLOT + i);
+			glVertexAttribPointer(MODEL_SLOT + i, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(offsetof(Instance, Model) + i * sizeof(glm::vec4)));
+			glVertexAttribDivisor(MODEL_SLOT + i, 1);
+		}
+		for (GLuint i = 0; i < 3; i++)
+		{
+			glEnableVertexAttribArray(NORMAL_MATRIX_SLOT + i);
+			glVertexAttribPointer(NORMAL_MATRIX_SLOT + i, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(offsetof(Instance, NormalMatrix) + i * sizeof(glm::vec3)));
+			glVertexAttribDivisor(NORMAL_MATRIX_SLOT + i, 1);
+		}
+		glBindVertexArray(GL_NONE);
+		glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
+		ResourceTracker::Track(ResourceTracker::Category::VertexBuffer, handle, cell.Instances.size() * sizeof(Instance), instances.Buffer);
+
+		entt::entity entity = registry.create();
+		registry.emplace<Transform>(entity);
+		registry.emplace<RendererComponent>(entity).SetMesh(vao).SetMaterial(cell.Material);
+		registry.emplace<GameObjectTag>(entity).Name = "Instance Batch";
+		registry.emplace<StaticBatch::Bounds>(entity, bounds);
+		registry.emplace<Instances>(entity, instances);
+		entities.push_back(entity);
+	}
+	_cells.clear();
+}
+
+size_t InstanceBatch::GetCellCount() const
+{
+	return _cells.size();
+}
+
+size_t InstanceBatch::GetInstanceCount() const
+{
+	size_t total = 0;
+	for (const auto& pair : _cells)
+		total += pair.second.Instances.size();
+	return total;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <GLM/glm.hpp>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include <ShaderMaterial.h>
+#include <VertexArrayObject.h>
+#include <entt/entt.hpp>
+
+#include "Graphics/MeshData.h"
+
+//Draws every copy of a mesh in a square cell on the ground with one instanced draw, the other way of cutting
+//*down draws to StaticBatch. The mesh is only stored once and each copy just adds its model and normal matrices,
+//*so it uses far less memory than baking, but the vertex shader has to move every vertex into world space
+//*The material's shader has to read the matrices from the per instance attributes (see instanced_vert.glsl)
+class InstanceBatch
+{
+public:
+	//Goes on the instanced entities (with a StaticBatch::Bounds for culling), the render loop draws them with this
+	struct Instances
+	{
+		GLsizei Count = 0;
+		GLsizei IndexCount = 0;
+		//The per instance matrices, deleted along with the last copy of this
+		std::shared_ptr<GLuint> Buffer;
+
+		//Draws every instance of the mesh, the shader and material need to be bound already
+		void Render(const VertexArrayObject::sptr& vao) const;
+	};
+
+	InstanceBatch(float cellSize);
+
+	//Adds a copy of the mesh moved by model, it goes in the cell under model's position
+	//*The mesh has to stay alive (and the same) until Build
+	void Add(const MeshData& mesh, const ShaderMaterial::sptr& material, const glm::mat4& model);
+
+	//Uploads every cell and makes an entity to draw each one (a Transform, RendererComponent, Bounds and Instances)
+	//*The cells are emptied afterwards
+	void Build(entt::registry& registry, std::vector<entt::entity>& entities);
+
+	size_t GetCellCount() const;
+	size_t GetInstanceCount() const;
+
+private:
+	//Attribute slots the matrices start at, after the mesh's own 4
+	static const GLuint MODEL_SLOT = 4;
+	static const GLuint NORMAL_MATRIX_SLOT = 8;
+
+	struct Instance
+	{
+		glm::mat4 Model;
+		glm::mat3 NormalMatrix;
+	};
+
+	struct Cell
+	{
+		const MeshData* Mesh = nullptr;
+		ShaderMaterial::sptr Material;
+		std::vector<Instance> Instances;
+	};
+
+	float _cellSize;
+	//Ordered, so the entities always come out in the same order
+	std::map<std::tuple<const MeshData*, ShaderMaterial*, int, int>, Cell> _cells;
+};
@@ -1,4 +1,5 @@
 #include "LUT.h"
+#include "Utilities/ResourceTracker.h"
 #pragma warning(disable : 4996)
 LUT3D::LUT3D()
 {
@@ -9,28 +10,66 @@ LUT3D::LUT3D(std::string path)
 	loadFromFile(path);
 }
 
+LUT3D::~LUT3D()
+{
+	ResourceTracker::Untrack(ResourceTracker::Category::LUTData, uint64_t(uintptr_t(this)));
+	if (_handle != GL_NONE)
+	{
+		ResourceTracker::Untrack(ResourceTracker::Category::Texture3D, _handle);
+		glDeleteTextures(1, &_handle);
+	}
+}
+
 void LUT3D::loadFromFile(std::string path)
 {
 	std::string filePath = path;
 	std::ifstream LUTstream;
 	LUTstream.open(filePath);
 
-	while (!LUTstream.eof())
+	if (!parse(LUTstream, data, _size))
 	{
-		std::string _line;
-		std::getline(LUTstream, _line);
+		printf("Failed to load LUT %s\n", filePath.c_str());
+		return;
+	}
+	//The table stays around after it's uploaded, so it counts against the CPU
+	ResourceTracker::Track(ResourceTracker::Category::LUTData, uint64_t(uintptr_t(this)), data.capacity() * sizeof(glm::vec3));
+
+	upload(data, _size);
+}
 
-		if (_line.empty())
+bool LUT3D::parse(std::istream& stream, std::vector<glm::vec3>& table, int& size)
+{
+	table.clear();
+	size = 64;
+
+	std::string _line;
+	while (std::getline(stream, _line))
+	{
+		if (_line.empty() || _line[0] == '#')
 			continue;
 
 		glm::vec3 lineData;
 		if (sscanf(_line.c_str(), "%f %f %f", &lineData.x, &lineData.y, &lineData.z) == 3)
-			data.push_back(lineData);
+		{
+			table.push_back(lineData);
+		}
+		else if (_line.compare(0, 11, "LUT_3D_SIZE") == 0)
+		{
+			size = atoi(_line.c_str() + 11);
+			table.reserve(size_t(size) * size * size);
+		}
 	}
 
+	//Should have a colour for every cell
+	return size > 0 && table.size() == size_t(size) * size * size;
+}
+
+void LUT3D::upload(const std::vector<glm::vec3>& table, int size)
+{
 	glEnable(GL_TEXTURE_3D);
 
-	glGenTextures(1, &_handle);
+	if (_handle == GL_NONE)
+		glGenTextures(1, &_handle);
 	bind();
 	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -38,8 +77,9 @@ void LUT3D::loadFromFile(std::string path)
 	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_REPEAT);
 
-	glTexImage3D(GL_TEXTURE_3D, 0, GL_RGB, 64, 64, 64, 0, GL_RGB, GL_FLOAT, &data[0]);
+	glTexImage3D(GL_TEXTURE_3D, 0, GL_RGB, size, size, size, 0, GL_RGB, GL_FLOAT, &table[0]);
 	unbind();
+	ResourceTracker::Track(ResourceTracker::Category::Texture3D, _handle, ResourceTracker::TextureBytes(_handle));
 
 	glDisable(GL_TEXTURE_3D);
 }
@@ -64,4 +104,9 @@ void LUT3D::unbind(int textureSlot)
 {
 	glActiveTexture(GL_TEXTURE0 + textureSlot);
 	unbind();
+}
+
+bool LUT3D::isLoaded() const
+{
+	return _handle != GL_NONE;
 }
\ No newline at end of file
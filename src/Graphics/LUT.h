@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <fstream>
+#include <istream>
 #include <string>
 #include <glad/glad.h>
 #include "glm/common.hpp"
@@ -10,13 +11,28 @@ class LUT3D
 public:
 	LUT3D();
 	LUT3D(std::string path);
+	//Deletes the texture
+	~LUT3D();
+	//Owns a texture, so it can't be copied
+	LUT3D(const LUT3D&) = delete;
+	LUT3D& operator=(const LUT3D&) = delete;
 	void loadFromFile(std::string path);
+	//Uploads parsed table data to the 3D texture
+	void upload(const std::vector<glm::vec3>& table, int size);
+
+	//Reads the table out of a .cube file, this doesn't touch GL so it works without a context
+	//*size is read from LUT_3D_SIZE (64 if the file doesn't say)
+	static bool parse(std::istream& stream, std::vector<glm::vec3>& table, int& size);
 	void bind();
 	void unbind();
 
 	void bind(int textureSlot);
 	void unbind(int textureSlot);
+
+	//Did the table load and upload
+	bool isLoaded() const;
 private:
 	GLuint _handle = GL_NONE;
 	std::vector<glm::vec3> data;
+	int _size = 64;
 };
\ No newline at end of file
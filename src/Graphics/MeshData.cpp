@@ -0,0 +1,135 @@
+#include "MeshData.h"
+
+#include <cstdlib>
+#include <fstream>
+
+#include <Logging.h>
+
+#include "Graphics/ObjFormat.h"
+#include "Graphics/VertexPacking.h"
+
+bool MeshData::LoadObj(const std::string& fileName, MeshData& mesh, const glm::vec4& colour)
+{
+	std::ifstream file(fileName);
+	if (!file.is_open())
+	{
+		LOG_ERROR("Failed to open {}", fileName);
+		return false;
+	}
+
+	mesh.Clear();
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> uvs;
+	std::vector<glm::vec3> normals;
+	//Corners that are used more than once share a vertex
+	ObjFormat::CornerMap lookup;
+	std::vector<uint32_t> face;
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		const char* text = line.c_str();
+		while (*text == ' ' || *text == '\t')
+			text++;
+		char* end;
+
+		if (text[0] == 'v' && text[1] == ' ')
+		{
+			glm::vec3 position;
+			position.x = strtof(text + 2, &end);
+			position.y = strtof(end, &end);
+			position.z = strtof(end, &end);
+			positions.push_back(position);
+		}
+		else if (text[0] == 'v' && text[1] == 't')
+		{
+			glm::vec2 uv;
+			uv.x = strtof(text + 2, &end);
+			uv.y = strtof(end, &end);
+			uvs.push_back(uv);
+		}
+		else if (text[0] == 'v' && text[1] == 'n')
+		{
+			glm::vec3 normal;
+			normal.x = strtof(text + 2, &end);
+			normal.y = strtof(end, &end);
+			normal.z = strtof(end, &end);
+			normals.push_back(normal);
+		}
+		else if (text[0] == 'f' && text[1] == ' ')
+		{
+			const char* lineEnd = line.c_str() + line.size();
+			face.clear();
+			text += 2;
+			ObjFormat::RawCorner raw;
+			ObjFormat::Corner corner;
+			bool inserted;
+			while (true)
+			{
+				while (*text == ' ' || *text == '\t')
+					text++;
+				if (!ObjFormat::ReadCorner(text, lineEnd, raw))
+					break;
+				if (!ObjFormat::ResolveCorner(raw, positions.size(), uvs.size(), normals.size(), corner))
+					continue;
+
+				uint32_t index = lookup.Insert(corner, uint32_t(mesh.Vertices.size()), inserted);
+				if (inserted)
+					mesh.Vertices.push_back(ObjFormat::MakeVertex(corner, positions, uvs, uvs.size(), normals, normals.size(), colour));
+				face.push_back(index);
+			}
+			ObjFormat::AddFace(face, mesh.Indices);
+		}
+	}
+
+	return true;
+}
+
+void MeshData::Append(const MeshData& other, const glm::mat4& model, const glm::mat3& normalMatrix)
+{
+	uint32_t offset = uint32_t(Vertices.size());
+	Vertices.reserve(Vertices.size() + other.Vertices.size());
+	for (const VertexPosNormTexCol& source : other.Vertices)
+	{
+		VertexPosNormTexCol vertex = source;
+		vertex.Position = glm::vec3(model * glm::vec4(source.Position, 1.0f));
+		glm::vec3 normal = normalMatrix * source.Normal;
+		float length = glm::length(normal);
+		vertex.Normal = length > 0.0f ? normal / length : normal;
+		Vertices.push_back(vertex);
+	}
+
+	Indices.reserve(Indices.size() + other.Indices.size());
+	for (uint32_t index : other.Indices)
+		Indices.push_back(index + offset);
+}
+
+void MeshData::Clear()
+{
+	Vertices.clear();
+	Indices.clear();
+}
+
+VertexArrayObject::sptr MeshData::Bake() const
+{
+	return VertexPacking::Bake(*this, VertexPacking::Choose(*this));
+}
+
+size_t MeshData::GetTriangleCount() const
+{
+	return Indices.size() / 3;
+}
+
+bool MeshData::GetBounds(glm::vec3& min, glm::vec3& max) const
+{
+	if (Vertices.empty())
+		return false;
+
+	min = max = Vertices[0].Position;
+	for (const VertexPosNormTexCol& vertex : Vertices)
+	{
+		min = glm::min(min, vertex.Position);
+		max = glm::max(max, vertex.Position);
+	}
+	return true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <GLM/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <VertexTypes.h>
+#include <VertexArrayObject.h>
+
+//A mesh kept on the CPU, so it can be changed or merged before it goes to the GPU
+//*(the toolkit's ObjLoader and MeshBuilder only hand back the finished vertex array)
+class MeshData
+{
+public:
+	std::vector<VertexPosNormTexCol> Vertices;
+	std::vector<uint32_t> Indices;
+
+	//Reads a .obj file (triangulating any bigger faces), every vertex gets the colour
+	//*Returns false if the file can't be opened
+	//*This is the simple one line at a time reader, ObjParser::Load is quicker and is checked against this
+	static bool LoadObj(const std::string& fileName, MeshData& mesh, const glm::vec4& colour = glm::vec4(1.0f));
+
+	//Adds a copy of another mesh moved by model, the normals get moved by normalMatrix
+	void Append(const MeshData& other, const glm::mat4& model, const glm::mat3& normalMatrix);
+	void Clear();
+
+	//Uploads it into a new vertex array, in the smallest layout VertexPacking can fit it in
+	VertexArrayObject::sptr Bake() const;
+
+	size_t GetTriangleCount() const;
+	//Box around every vertex, false if there aren't any
+	bool GetBounds(glm::vec3& min, glm::vec3& max) const;
+};
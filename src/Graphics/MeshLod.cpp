@@ -0,0 +1,276 @@
+#include "MeshLod.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstddef>
+
+#include <RendererComponent.h>
+#include <Transform.h>
+
+#include "Graphics/MeshOptimizer.h"
+#include "Graphics/ObjParser.h"
+#include "Graphics/MeshSimplifier.h"
+#include "imgui.h"
+
+std::unordered_map<std::string, LodChain::sptr> LodChain::_cache;
+
+bool LodSystem::Enabled = true;
+float LodSystem::MaxScreenError = 0.003f;
+float LodSystem::Hysteresis = 0.15f;
+bool LodSystem::ImpostorsEnabled = true;
+float LodSystem::ImpostorDistance = 40.0f;
+float LodSystem::ImpostorFadeWidth = 8.0f;
+glm::vec3 LodSystem::ImpostorLighting = glm::vec3(1.0f);
+std::vector<size_t> LodSystem::_levelCounts;
+size_t LodSystem::_triangles = 0;
+std::unordered_map<ImpostorAtlas*, std::vector<LodSystem::ImpostorInstance>> LodSystem::_impostors;
+size_t LodSystem::_impostorCount = 0;
+Shader::sptr LodSystem::_impostorShader = nullptr;
+GLuint LodSystem::_impostorVao = 0;
+GLuint LodSystem::_cornerBuffer = 0;
+GLuint LodSystem::_instanceBuffer = 0;
+
+LodChain::sptr LodChain::Create(const MeshData& mesh, int levels, float ratio)
+{
+	sptr chain = std::make_shared<LodChain>();
+
+	glm::vec3 min, max;
+	if (mesh.GetBounds(min, max))
+	{
+		chain->Centre = (min + max) * 0.5f;
+		for (const VertexPosNormTexCol& vertex : mesh.Vertices)
+			chain->Radius = std::max(chain->Radius, glm::length(vertex.Position - chain->Centre));
+	}
+	//Each level is made from the one before, so the errors add up
+	MeshData previous = mesh;
+	if (MeshOptimizer::Enabled)
+		MeshOptimizer::Optimize(previous);
+	chain->Levels.push_back({ previous.Bake(), previous.GetTriangleCount(), 0.0f });
+	float error = 0.0f;
+	for (int i = 1; i < levels; i++)
+	{
+		size_t target = size_t(previous.GetTriangleCount() * ratio);
+		if (target < 8)
+			break;
+
+		MeshData simplified;
+		float levelError;
+		MeshSimplifier::Simplify(previous, target, simplified, levelError);
+		//Not worth a level if hardly anything went
+		if (simplified.GetTriangleCount() == 0 || simplified.GetTriangleCount() > previous.GetTriangleCount() * 0.9f)
+			break;
+
+		error += levelError;
+		if (MeshOptimizer::Enabled)
+			MeshOptimizer::Optimize(simplified);
+		chain->Levels.push_back({ simplified.Bake(), simplified.GetTriangleCount(), error });
+		previous = std::move(simplified);
+	}
+	return chain;
+}
+
+LodChain::sptr LodChain::LoadFromFile(const std::string& fileName)
+{
+	auto it = _cache.find(fileName);
+	if (it != _cache.end())
+		return it->second;
+
+	MeshData mesh;
+	ObjParser::Load(fileName, mesh);
+	sptr chain = Create(mesh);
+	_cache[fileName] = chain;
+	return chain;
+}
+
+void LodChain::ClearCache()
+{
+	_cache.clear();
+}
+
+void LodSystem::Update(entt::registry& registry, const glm::vec3& cameraPosition, const glm::mat4& projection)
+{
+	//Perspective shrinks things with distance, orthographic doesn't
+	bool orthographic = projection[3][3] == 1.0f;
+	float scale = projection[1][1];
+
+	std::fill(_levelCounts.begin(), _levelCounts.end(), 0);
+	_triangles = 0;
+	//Keep the lists' memory around, the same atlases are usually back next frame
+	for (auto& impostors : _impostors)
+		impostors.second.clear();
+	_impostorCount = 0;
+
+	registry.view<LodGroup, RendererComponent, Transform>().each([&](LodGroup& group, RendererComponent& renderer, const Transform& transform) {
+		if (group.Chain == nullptr || group.Chain->Levels.empty())
+			return;
+		const LodChain& chain = *group.Chain;
+
+		int level = 0;
+		float fade = 0.0f;
+		if (Enabled)
+		{
+			const glm::mat4& world = transform.WorldTransform();
+			glm::vec3 centre = glm::vec3(world * glm::vec4(chain.Centre, 1.0f));
+			float worldScale = std::max(glm::length(glm::vec3(world[0])), std::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+			float radius = chain.Radius * worldScale;
+			float distance = glm::length(centre - cameraPosition);
+
+			float screenSize;
+			if (orthographic)
+				screenSize = radius * scale;
+			else
+				screenSize = distance > radius ? radius * scale / distance : FLT_MAX;
+			level = SelectLevel(chain, screenSize, group.Current);
+
+			if (ImpostorsEnabled && chain.Impostor != nullptr && !orthographic)
+			{
+				fade = glm::clamp((distance - ImpostorDistance) / std::max(ImpostorFadeWidth, 0.001f), 0.0f, 1.0f);
+				if (fade > 0.0f)
+				{
+					//Cards only turn around z, so only the yaw and size of the object matter
+					float yaw = atan2f(world[0][1], world[0][0]);
+					_impostors[chain.Impostor.get()].push_back({ glm::vec3(world[3]), yaw, glm::length(glm::vec3(world[0])), fade });
+					_impostorCount++;
+					_triangles += 2;
+				}
+			}
+		}
+
+		group.Current = level;
+		group.Fade = fade;
+		//Fully faded out meshes get taken away so they aren't drawn at all
+		const VertexArrayObject::sptr& mesh = fade >= 1.0f ? nullptr : chain.Levels[level].Mesh;
+		if (renderer.Mesh != mesh)
+			renderer.Mesh = mesh;
+		if (mesh == nullptr)
+			return;
+
+		if (_levelCounts.size() <= size_t(level))
+			_levelCounts.resize(level + 1, 0);
+		_levelCounts[level]++;
+		_triangles += chain.Levels[level].Triangles;
+	});
+}
+
+int LodSystem::RenderImpostors(const glm::mat4& viewProjection, const glm::vec3& cameraPosition)
+{
+	if (_impostorCount == 0)
+		return 0;
+
+	if (_impostorShader == nullptr)
+	{
+		_impostorShader = Shader::Create();
+		_impostorShader->LoadShaderPartFromFile("shaders/impostor_vert.glsl", GL_VERTEX_SHADER);
+		_impostorShader->LoadShaderPartFromFile("shaders/impostor_frag.glsl", GL_FRAGMENT_SHADER);
+		_impostorShader->Link();
+
+		//One quad shared by every card, the instance buffer gets filled each frame
+		const float corners[] = { -0.5f, 0.0f, 0.5f, 0.0f, -0.5f, 1.0f, 0.5f, 1.0f };
+		glGenVertexArrays(1, &_impostorVao);
+		glBindVertexArray(_impostorVao);
+		glGenBuffers(1, &_cornerBuffer);
+		glBindBuffer(GL_ARRAY_BUFFER, _cornerBuffer);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+
+		glGenBuffers(1, &_instanceBuffer);
+		glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffer);
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(ImpostorInstance), (void*)offsetof(ImpostorInstance, Position));
+		glVertexAttribDivisor(1, 1);
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(ImpostorInstance), (void*)offsetof(ImpostorInstance, Scale));
+		glVertexAttribDivisor(2, 1);
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	_impostorShader->Bind();
+	_impostorShader->SetUniformMatrix("u_ViewProjection", viewProjection);
+	_impostorShader->SetUniform("u_CamPos", cameraPosition);
+	_impostorShader->SetUniform("u_Lighting", ImpostorLighting);
+	_impostorShader->SetUniform("s_Atlas", 0);
+
+	int draws = 0;
+	glBindVertexArray(_impostorVao);
+	glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffer);
+	for (const auto& impostors : _impostors)
+	{
+		if (impostors.second.empty())
+			continue;
+		const ImpostorAtlas& atlas = *impostors.first;
+		_impostorShader->SetUniform("u_Views", atlas.GetViews());
+		_impostorShader->SetUniform("u_Size", atlas.GetSize());
+		_impostorShader->SetUniform("u_Bottom", atlas.GetBottom());
+		_impostorShader->SetUniform("u_Centre", atlas.GetCentre());
+		atlas.Bind(0);
+
+		//Orphan the old contents so the driver doesn't wait on last frame's draw
+		GLsizeiptr size = GLsizeiptr(impostors.second.size() * sizeof(ImpostorInstance));
+		glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, size, impostors.second.data());
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, GLsizei(impostors.second.size()));
+
+		atlas.Unbind(0);
+		draws++;
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+	return draws;
+}
+
+void LodSystem::Release()
+{
+	_impostors.clear();
+	_impostorCount = 0;
+	_impostorShader = nullptr;
+	if (_impostorVao != 0)
+	{
+		glDeleteVertexArrays(1, &_impostorVao);
+		glDeleteBuffers(1, &_cornerBuffer);
+		glDeleteBuffers(1, &_instanceBuffer);
+		_impostorVao = _cornerBuffer = _instanceBuffer = 0;
+	}
+}
+
+int LodSystem::SelectLevel(const LodChain& chain, float screenSize, int current)
+{
+	int count = int(chain.Levels.size());
+	int level = std::min(std::max(current, 0), count - 1);
+
+	//A level is fine while it's no bigger on screen than this
+	auto limit = [&](int index) {
+		float error = std::max(chain.Levels[index].Error, chain.Radius * 1e-6f);
+		return MaxScreenError * chain.Radius / error;
+	};
+
+	//Coarser while we're comfortably small enough for the next one, finer while we're well past this one
+	while (level + 1 < count && screenSize * (1.0f + Hysteresis) < limit(level + 1))
+		level++;
+	while (level > 0 && screenSize * (1.0f - Hysteresis) > limit(level))
+		level--;
+	return level;
+}
+
+void LodSystem::RenderImGui()
+{
+	if (!ImGui::CollapsingHeader("Level of Detail"))
+		return;
+
+	ImGui::Checkbox("Enabled", &Enabled);
+	ImGui::SliderFloat("Max Screen Error", &MaxScreenError, 0.0005f, 0.02f, "%.4f");
+	ImGui::SliderFloat("Hysteresis", &Hysteresis, 0.0f, 0.5f);
+	ImGui::Checkbox("Impostors", &ImpostorsEnabled);
+	ImGui::SliderFloat("Impostor Distance", &ImpostorDistance, 5.0f, 200.0f);
+	ImGui::SliderFloat("Impostor Fade Width", &ImpostorFadeWidth, 0.0f, 40.0f);
+	ImGui::Text("Triangles: %zu", _triangles);
+	for (size_t i = 0; i < _levelCounts.size(); i++)
+		ImGui::Text("Level %zu: %zu objects", i, _levelCounts[i]);
+	ImGui::Text("Impostors: %zu objects", _impostorCount);
+}
+
+size_t LodSystem::GetTriangleCount()
+{
+	return _triangles;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <GLM/glm.hpp>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <Shader.h>
+#include <VertexArrayObject.h>
+#include <entt/entt.hpp>
+
+#include "Graphics/Impostor.h"
+#include "Graphics/MeshData.h"
+
+//A mesh and copies of it simplified a few times over, shared between everything that draws it
+class LodChain
+{
+public:
+	typedef std::shared_ptr<LodChain> sptr;
+
+	struct Level
+	{
+		VertexArrayObject::sptr Mesh;
+		size_t Triangles;
+		//Roughly how far this level's surface is from the full mesh, in the mesh's units
+		float Error;
+	};
+
+	//Level 0 is the mesh itself, every level after has about ratio times the triangles of the one before
+	//*Stops early once simplifying stops getting anywhere
+	static sptr Create(const MeshData& mesh, int levels = 4, float ratio = 0.5f);
+	//Loads and builds a chain for a .obj, files that have been loaded before share their chain
+	static sptr LoadFromFile(const std::string& fileName);
+	//Lets go of the loaded chains (their meshes stay alive while something still uses them)
+	static void ClearCache();
+
+	std::vector<Level> Levels;
+	//Sphere around the full mesh, in the mesh's space
+	glm::vec3 Centre = glm::vec3(0.0f);
+	float Radius = 0.0f;
+	//Optional, far away copies turn into cards showing this
+	ImpostorAtlas::sptr Impostor;
+
+private:
+	static std::unordered_map<std::string, sptr> _cache;
+};
+
+//Goes on an entity with a RendererComponent, LodSystem swaps its mesh for the level that suits its size on screen
+struct LodGroup
+{
+	LodChain::sptr Chain;
+	int Current = 0;
+	//How far it's faded into its impostor, 1 means only the impostor is drawn (and the mesh is taken away)
+	float Fade = 0.0f;
+};
+
+//Picks a level for every LodGroup once a frame
+//*A level is used once its error would cover less than MaxScreenError of the screen's height, and it
+//*has to be Hysteresis past that before switching back, so things near a threshold don't flicker between levels
+//*Chains with an impostor dither over to it across ImpostorFadeWidth once they're past ImpostorDistance
+class LodSystem abstract
+{
+public:
+	//Call after the world matrices are updated and before drawing
+	static void Update(entt::registry& registry, const glm::vec3& cameraPosition, const glm::mat4& projection);
+	//Draws the impostors Update picked, one instanced draw per atlas, returns how many draws that took
+	static int RenderImpostors(const glm::mat4& viewProjection, const glm::vec3& cameraPosition);
+	//Frees the impostor shader and buffers (call before the window goes)
+	static void Release();
+
+	//Which level suits an object covering screenSize (its radius over half the screen's height), starting from current
+	static int SelectLevel(const LodChain& chain, float screenSize, int current);
+
+	//Draws the LOD settings and what got picked last frame (call inside an ImGui window)
+	static void RenderImGui();
+
+	//Triangles in the levels LodSystem picked last frame, impostor cards included
+	static size_t GetTriangleCount();
+
+	//Off draws everything at level 0
+	static bool Enabled;
+	//How much of half the screen's height a level's error can cover
+	static float MaxScreenError;
+	//Fraction past a threshold needed to switch
+	static float Hysteresis;
+	//Off keeps drawing meshes however far away they are
+	static bool ImpostorsEnabled;
+	//Distance from the camera where the fade to impostors starts, and how long it takes
+	static float ImpostorDistance;
+	static float ImpostorFadeWidth;
+	//Multiplies the impostors' colour, they're captured unlit
+	static glm::vec3 ImpostorLighting;
+
+private:
+	//Where the card goes, which way the object faces, how big it is and how far it's faded in
+	struct ImpostorInstance
+	{
+		glm::vec3 Position;
+		float Yaw;
+		float Scale;
+		float Fade;
+	};
+
+	static std::vector<size_t> _levelCounts;
+	static size_t _triangles;
+	static std::unordered_map<ImpostorAtlas*, std::vector<ImpostorInstance>> _impostors;
+	static size_t _impostorCount;
+	static Shader::sptr _impostorShader;
+	static GLuint _impostorVao;
+	static GLuint _cornerBuffer;
+	static GLuint _instanceBuffer;
+};
@@ -0,0 +1,307 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <json.hpp>
+#include <Logging.h>
+
+#include "Graphics/ObjParser.h"
+#include "Graphics/VertexPacking.h"
+
+bool MeshOptimizer::Enabled = true;
+
+namespace
+{
+	//Hashes and compares vertices by their bytes, every attribute has to match exactly
+	struct VertexHash
+	{
+		size_t operator()(const VertexPosNormTexCol* vertex) const
+		{
+			uint32_t words[sizeof(VertexPosNormTexCol) / sizeof(uint32_t)];
+			memcpy(words, vertex, sizeof(words));
+			uint32_t hash = 2166136261u;
+			for (uint32_t word : words)
+				hash = (hash ^ word) * 16777619u;
+			return hash;
+		}
+	};
+
+	struct VertexEqual
+	{
+		bool operator()(const VertexPosNormTexCol* a, const VertexPosNormTexCol* b) const
+		{
+			return memcmp(a, b, sizeof(VertexPosNormTexCol)) == 0;
+		}
+	};
+
+	double MillisecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+void MeshOptimizer::Optimize(MeshData& mesh)
+{
+	WeldVertices(mesh);
+	OptimizeVertexCache(mesh);
+	OptimizeVertexFetch(mesh);
+}
+
+void MeshOptimizer::WeldVertices(MeshData& mesh)
+{
+	std::vector<VertexPosNormTexCol> welded;
+	welded.reserve(mesh.Vertices.size());
+	std::vector<uint32_t> remap(mesh.Vertices.size());
+	{
+		std::unordered_map<const VertexPosNormTexCol*, uint32_t, VertexHash, VertexEqual> lookup;
+		lookup.reserve(mesh.Vertices.size());
+		for (size_t i = 0; i < mesh.Vertices.size(); i++)
+		{
+			auto it = lookup.emplace(&mesh.Vertices[i], uint32_t(welded.size()));
+			if (it.second)
+				welded.push_back(mesh.Vertices[i]);
+			remap[i] = it.first->second;
+		}
+	}
+
+	for (uint32_t& index : mesh.Indices)
+		index = remap[index];
+	mesh.Vertices.swap(welded);
+}
+
+void MeshOptimizer::OptimizeVertexCache(MeshData& mesh, int cacheSize)
+{
+	size_t vertexCount = mesh.Vertices.size();
+	size_t triangleCount = mesh.Indices.size() / 3;
+	if (triangleCount == 0)
+		return;
+
+	//The triangles around each vertex, packed into one list
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+		offsets[mesh.Indices[i] + 1]++;
+	for (size_t v = 0; v < vertexCount; v++)
+		offsets[v + 1] += offsets[v];
+	std::vector<uint32_t> around(triangleCount * 3);
+	{
+		std::vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < triangleCount * 3; i++)
+			around[next[mesh.Indices[i]]++] = uint32_t(i / 3);
+	}
+
+	//Triangles each vertex still has to be drawn in, and when it last went into the cache
+	std::vector<uint32_t> live(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+		live[v] = offsets[v + 1] - offsets[v];
+	std::vector<uint32_t> stamps(vertexCount, 0);
+	std::vector<bool> emitted(triangleCount, false);
+	uint32_t time = uint32_t(cacheSize) + 1;
+
+	std::vector<uint32_t> deadEnds;
+	std::vector<uint32_t> candidates;
+	size_t scan = 0;
+	//Somewhere to carry on from when the fan runs out, the most recently used vertices first
+	auto skipDeadEnd = [&]() -> int64_t {
+		while (!deadEnds.empty())
+		{
+			uint32_t vertex = deadEnds.back();
+			deadEnds.pop_back();
+			if (live[vertex] > 0)
+				return vertex;
+		}
+		for (; scan < vertexCount; scan++)
+		{
+			if (live[scan] > 0)
+				return int64_t(scan);
+		}
+		return -1;
+	};
+
+	std::vector<uint32_t> indices;
+	indices.reserve(triangleCount * 3);
+	int64_t fan = skipDeadEnd();
+	while (fan >= 0)
+	{
+		//Draw everything left around this vertex
+		candidates.clear();
+		for (uint32_t a = offsets[fan]; a < offsets[fan + 1]; a++)
+		{
+			uint32_t triangle = around[a];
+			if (emitted[triangle])
+				continue;
+			emitted[triangle] = true;
+			for (int c = 0; c < 3; c++)
+			{
+				uint32_t vertex = mesh.Indices[size_t(triangle) * 3 + c];
+				indices.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				live[vertex]--;
+				if (time - stamps[vertex] > uint32_t(cacheSize))
+					stamps[vertex] = time++;
+			}
+		}
+
+		//Then fan around whichever vertex will still be in the cache once all its triangles are drawn, the oldest one if there's a choice
+		int64_t best = -1;
+		int64_t bestPriority = -1;
+		for (uint32_t vertex : candidates)
+		{
+			if (live[vertex] == 0)
+				continue;
+			int64_t priority = 0;
+			if (time - stamps[vertex] + 2 * live[vertex] <= uint32_t(cacheSize))
+				priority = time - stamps[vertex];
+			if (priority > bestPriority)
+			{
+				best = vertex;
+				bestPriority = priority;
+			}
+		}
+		fan = best >= 0 ? best : skipDeadEnd();
+	}
+
+	//Anything past the last whole triangle stays where it was
+	indices.insert(indices.end(), mesh.Indices.begin() + triangleCount * 3, mesh.Indices.end());
+	mesh.Indices.swap(indices);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(MeshData& mesh)
+{
+	const uint32_t unused = UINT32_MAX;
+	std::vector<uint32_t> remap(mesh.Vertices.size(), unused);
+	std::vector<VertexPosNormTexCol> vertices;
+	vertices.reserve(mesh.Vertices.size());
+	for (uint32_t& index : mesh.Indices)
+	{
+		if (remap[index] == unused)
+		{
+			remap[index] = uint32_t(vertices.size());
+			vertices.push_back(mesh.Vertices[index]);
+		}
+		index = remap[index];
+	}
+	mesh.Vertices.swap(vertices);
+}
+
+MeshOptimizer::Stats MeshOptimizer::Analyze(const MeshData& mesh, int cacheSize)
+{
+	Stats stats;
+	stats.Vertices = mesh.Vertices.size();
+	stats.Triangles = mesh.GetTriangleCount();
+	if (stats.Triangles == 0 || stats.Vertices == 0)
+		return stats;
+
+	//A vertex is still in a FIFO cache until cacheSize misses after the one that put it there
+	std::vector<int64_t> stamps(mesh.Vertices.size(), INT64_MIN / 2);
+	int64_t misses = 0;
+	for (size_t i = 0; i < stats.Triangles * 3; i++)
+	{
+		uint32_t vertex = mesh.Indices[i];
+		if (misses - stamps[vertex] >= cacheSize)
+			stamps[vertex] = misses++;
+	}
+	stats.Acmr = float(double(misses) / stats.Triangles);
+	stats.Atvr = float(double(misses) / stats.Vertices);
+	return stats;
+}
+
+bool MeshOptimizer::WriteReport(const std::string& folder, const std::string& outputPath)
+{
+	namespace fs = std::filesystem;
+	std::vector<fs::path> files;
+	std::error_code error;
+	for (const fs::directory_entry& entry : fs::directory_iterator(folder, error))
+	{
+		if (entry.path().extension() == ".obj")
+			files.push_back(entry.path());
+	}
+	std::sort(files.begin(), files.end());
+	if (files.empty())
+	{
+		LOG_ERROR("No meshes found in {}", folder);
+		return false;
+	}
+
+	//Corners is what a loader that gives every face corner its own vertex uploads, which never reuses anything (ACMR 3)
+	//*The byte counts are the optimized vertices in the full float layout, then in the layout VertexPacking picks
+	printf("%-22s %10s %10s %10s %10s %12s %12s %10s %10s %10s %10s  %s\n", "Mesh", "Triangles", "Corners", "Loaded", "Optimized", "ACMR before", "ACMR after",
+		"ATVR after", "Time (ms)", "Bytes", "Packed", "Layout");
+	nlohmann::json root;
+	bool matched = true;
+	for (const fs::path& file : files)
+	{
+		MeshData mesh;
+		if (!ObjParser::Load(file.string(), mesh))
+			continue;
+		size_t corners = mesh.Indices.size();
+
+		//Every model also goes through the single threaded reader, the threaded one has to give exactly the same mesh
+		MeshData reference;
+		std::string difference;
+		bool matches = MeshData::LoadObj(file.string(), reference) && ObjParser::Matches(mesh, reference, difference);
+		if (!matches)
+		{
+			LOG_ERROR("ObjParser read {} differently to MeshData::LoadObj: {}", file.filename().string(), difference);
+			matched = false;
+		}
+		Stats before = Analyze(mesh);
+
+		auto start = std::chrono::steady_clock::now();
+		WeldVertices(mesh);
+		size_t welded = mesh.Vertices.size();
+		double weldTime = MillisecondsSince(start);
+		start = std::chrono::steady_clock::now();
+		OptimizeVertexCache(mesh);
+		double cacheTime = MillisecondsSince(start);
+		start = std::chrono::steady_clock::now();
+		OptimizeVertexFetch(mesh);
+		double fetchTime = MillisecondsSince(start);
+		Stats after = Analyze(mesh);
+		VertexPacking::Layout layout = VertexPacking::Choose(mesh);
+		size_t fullBytes = after.Vertices * VertexPacking::GetFullStride();
+		size_t packedBytes = after.Vertices * layout.Stride;
+
+		printf("%-22s %10zu %10zu %10zu %10zu %12.3f %12.3f %10.3f %10.2f %10zu %10zu  %s\n", file.filename().string().c_str(), after.Triangles,
+			corners, before.Vertices, after.Vertices, before.Acmr, after.Acmr, after.Atvr, weldTime + cacheTime + fetchTime,
+			fullBytes, packedBytes, VertexPacking::GetName(layout).c_str());
+
+		nlohmann::json entry;
+		entry["name"] = file.filename().string();
+		entry["triangles"] = after.Triangles;
+		entry["vertices"]["corners"] = corners;
+		entry["vertices"]["loaded"] = before.Vertices;
+		entry["vertices"]["welded"] = welded;
+		entry["vertices"]["optimized"] = after.Vertices;
+		entry["acmr"]["before"] = before.Acmr;
+		entry["acmr"]["after"] = after.Acmr;
+		entry["atvr"]["before"] = before.Atvr;
+		entry["atvr"]["after"] = after.Atvr;
+		entry["optimize_ms"]["weld"] = weldTime;
+		entry["optimize_ms"]["vertex_cache"] = cacheTime;
+		entry["optimize_ms"]["vertex_fetch"] = fetchTime;
+		entry["vertex_bytes"]["corners"] = corners * VertexPacking::GetFullStride();
+		entry["vertex_bytes"]["full"] = fullBytes;
+		entry["vertex_bytes"]["packed"] = packedBytes;
+		entry["layout"] = VertexPacking::GetName(layout);
+		entry["max_error"]["position"] = layout.PositionError;
+		entry["max_error"]["uv"] = layout.UVError;
+		entry["matches_reference"] = matches;
+		root["meshes"].push_back(entry);
+	}
+	root["cache_size"] = 16;
+
+	std::ofstream output(outputPath);
+	if (!output.is_open())
+	{
+		LOG_ERROR("Failed to write mesh report to {}", outputPath);
+		return false;
+	}
+	output << root.dump(4);
+	return matched;
+}
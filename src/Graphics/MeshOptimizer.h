@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+#include "Graphics/MeshData.h"
+
+//Gets a mesh ready for the GPU: identical vertices are merged, triangles are put in an order that
+//*reuses the post-transform vertex cache (Tipsify, Sander et al.), then vertices are put in the order
+//*the triangles first use them, so fetching them walks forwards through memory
+class MeshOptimizer abstract
+{
+public:
+	//How well a triangle order uses a FIFO vertex cache
+	struct Stats
+	{
+		size_t Vertices = 0;
+		size_t Triangles = 0;
+		//Average cache misses per triangle (3 is no reuse at all, 0.5 is the best a big grid can do)
+		float Acmr = 0.0f;
+		//Misses per vertex, 1 means every vertex is only transformed once
+		float Atvr = 0.0f;
+	};
+
+	//All three steps in order
+	static void Optimize(MeshData& mesh);
+
+	//Vertices that are the same in every attribute become one
+	static void WeldVertices(MeshData& mesh);
+	//Reorders the triangles, cacheSize is the cache the order gets tuned for
+	static void OptimizeVertexCache(MeshData& mesh, int cacheSize = 16);
+	//Reorders the vertices by first use, and drops any that nothing uses
+	static void OptimizeVertexFetch(MeshData& mesh);
+
+	//Simulates a FIFO cache of cacheSize vertices over the triangles
+	static Stats Analyze(const MeshData& mesh, int cacheSize = 16);
+
+	//Loads every .obj in a folder, prints its vertex counts and cache stats before and after optimizing and how much
+	//*smaller VertexPacking gets its vertices, and writes them as json to outputPath
+	//*Each model is also read with MeshData::LoadObj to check ObjParser gives the same mesh
+	//*Returns false if the folder has no meshes, a model didn't match or the file can't be written
+	static bool WriteReport(const std::string& folder, const std::string& outputPath);
+
+	//Off leaves meshes in the order they were loaded in (for comparing against)
+	static bool Enabled;
+};
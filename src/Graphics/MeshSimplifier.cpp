@@ -0,0 +1,301 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+
+float MeshSimplifier::BoundaryWeight = 10.0f;
+
+namespace
+{
+	//Sum of squared distances to a set of planes, as a symmetric 4x4 matrix
+	struct Quadric
+	{
+		double A2 = 0.0, AB = 0.0, AC = 0.0, AD = 0.0;
+		double B2 = 0.0, BC = 0.0, BD = 0.0;
+		double C2 = 0.0, CD = 0.0;
+		double D2 = 0.0;
+
+		void AddPlane(const glm::dvec3& normal, double d, double weight)
+		{
+			A2 += weight * normal.x * normal.x; AB += weight * normal.x * normal.y; AC += weight * normal.x * normal.z; AD += weight * normal.x * d;
+			B2 += weight * normal.y * normal.y; BC += weight * normal.y * normal.z; BD += weight * normal.y * d;
+			C2 += weight * normal.z * normal.z; CD += weight * normal.z * d;
+			D2 += weight * d * d;
+		}
+
+		void Add(const Quadric& other)
+		{
+			A2 += other.A2; AB += other.AB; AC += other.AC; AD += other.AD;
+			B2 += other.B2; BC += other.BC; BD += other.BD;
+			C2 += other.C2; CD += other.CD;
+			D2 += other.D2;
+		}
+
+		double Evaluate(const glm::dvec3& p) const
+		{
+			double result = A2 * p.x * p.x + 2.0 * AB * p.x * p.y + 2.0 * AC * p.x * p.z + 2.0 * AD * p.x
+				+ B2 * p.y * p.y + 2.0 * BC * p.y * p.z + 2.0 * BD * p.y
+				+ C2 * p.z * p.z + 2.0 * CD * p.z
+				+ D2;
+			return std::max(result, 0.0);
+		}
+	};
+
+	struct Triangle
+	{
+		//Welded positions, then the original vertex each corner takes its other attributes from
+		uint32_t Positions[3];
+		uint32_t Vertices[3];
+		bool Removed = false;
+
+		bool Has(uint32_t position) const
+		{
+			return Positions[0] == position || Positions[1] == position || Positions[2] == position;
+		}
+	};
+
+	//Moving From onto To, the versions go stale if either end changes before it comes up
+	struct Collapse
+	{
+		double Cost;
+		uint32_t From;
+		uint32_t To;
+		uint32_t FromVersion;
+		uint32_t ToVersion;
+
+		bool operator>(const Collapse& other) const
+		{
+			return Cost > other.Cost;
+		}
+	};
+
+	struct PositionHash
+	{
+		size_t operator()(const glm::vec3& position) const
+		{
+			uint32_t bits[3];
+			memcpy(bits, &position, sizeof(bits));
+			return (size_t(bits[0]) * 73856093) ^ (size_t(bits[1]) * 19349663) ^ (size_t(bits[2]) * 83492791);
+		}
+	};
+
+	uint64_t EdgeKey(uint32_t a, uint32_t b)
+	{
+		return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+	}
+
+	glm::dvec3 FaceNormal(const glm::dvec3& a, const glm::dvec3& b, const glm::dvec3& c)
+	{
+		return glm::cross(b - a, c - a);
+	}
+}
+
+void MeshSimplifier::Simplify(const MeshData& mesh, size_t targetTriangles, MeshData& out, float& error)
+{
+	out.Clear();
+	error = 0.0f;
+
+	//Vertices that only differ by uv or normal become one position
+	std::vector<glm::dvec3> positions;
+	std::vector<uint32_t> positionOf(mesh.Vertices.size());
+	{
+		std::unordered_map<glm::vec3, uint32_t, PositionHash> lookup;
+		for (size_t i = 0; i < mesh.Vertices.size(); i++)
+		{
+			auto it = lookup.emplace(mesh.Vertices[i].Position, uint32_t(positions.size()));
+			if (it.second)
+				positions.push_back(glm::dvec3(mesh.Vertices[i].Position));
+			positionOf[i] = it.first->second;
+		}
+	}
+
+	std::vector<Triangle> triangles;
+	triangles.reserve(mesh.Indices.size() / 3);
+	for (size_t i = 0; i + 2 < mesh.Indices.size(); i += 3)
+	{
+		Triangle triangle;
+		for (int c = 0; c < 3; c++)
+		{
+			triangle.Vertices[c] = mesh.Indices[i + c];
+			triangle.Positions[c] = positionOf[mesh.Indices[i + c]];
+		}
+		if (triangle.Positions[0] == triangle.Positions[1] || triangle.Positions[1] == triangle.Positions[2] || triangle.Positions[0] == triangle.Positions[2])
+			continue;
+		triangles.push_back(triangle);
+	}
+
+	//Every position starts with the planes of the triangles around it
+	std::vector<Quadric> quadrics(positions.size());
+	std::vector<std::vector<uint32_t>> around(positions.size());
+	std::unordered_map<uint64_t, int> edgeUses;
+	for (uint32_t t = 0; t < triangles.size(); t++)
+	{
+		const Triangle& triangle = triangles[t];
+		glm::dvec3 normal = FaceNormal(positions[triangle.Positions[0]], positions[triangle.Positions[1]], positions[triangle.Positions[2]]);
+		double length = glm::length(normal);
+		for (int c = 0; c < 3; c++)
+		{
+			around[triangle.Positions[c]].push_back(t);
+			edgeUses[EdgeKey(triangle.Positions[c], triangle.Positions[(c + 1) % 3])]++;
+		}
+		if (length <= 0.0)
+			continue;
+		normal /= length;
+		double d = -glm::dot(normal, positions[triangle.Positions[0]]);
+		for (int c = 0; c < 3; c++)
+			quadrics[triangle.Positions[c]].AddPlane(normal, d, 1.0);
+	}
+
+	//Open edges get a plane standing up along them, so they can slide along themselves but not inwards
+	for (const Triangle& triangle : triangles)
+	{
+		glm::dvec3 normal = FaceNormal(positions[triangle.Positions[0]], positions[triangle.Positions[1]], positions[triangle.Positions[2]]);
+		for (int c = 0; c < 3; c++)
+		{
+			uint32_t a = triangle.Positions[c];
+			uint32_t b = triangle.Positions[(c + 1) % 3];
+			if (edgeUses[EdgeKey(a, b)] != 1)
+				continue;
+			glm::dvec3 side = glm::cross(positions[b] - positions[a], normal);
+			double length = glm::length(side);
+			if (length <= 0.0)
+				continue;
+			side /= length;
+			double d = -glm::dot(side, positions[a]);
+			quadrics[a].AddPlane(side, d, BoundaryWeight);
+			quadrics[b].AddPlane(side, d, BoundaryWeight);
+		}
+	}
+
+	std::vector<uint32_t> versions(positions.size(), 0);
+	std::vector<bool> removed(positions.size(), false);
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue;
+
+	//Only ever moves an end onto the other one, so no new positions (or attributes) have to be made up
+	auto push = [&](uint32_t a, uint32_t b) {
+		Quadric sum = quadrics[a];
+		sum.Add(quadrics[b]);
+		double toB = sum.Evaluate(positions[b]);
+		double toA = sum.Evaluate(positions[a]);
+		if (toB <= toA)
+			queue.push({ toB, a, b, versions[a], versions[b] });
+		else
+			queue.push({ toA, b, a, versions[b], versions[a] });
+	};
+
+	for (const Triangle& triangle : triangles)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			uint32_t a = triangle.Positions[c];
+			uint32_t b = triangle.Positions[(c + 1) % 3];
+			if (a < b)
+				push(a, b);
+			else if (edgeUses[EdgeKey(a, b)] == 1)
+				push(b, a);
+		}
+	}
+
+	size_t live = triangles.size();
+	double worst = 0.0;
+	std::unordered_set<uint32_t> neighbours;
+	while (live > targetTriangles && !queue.empty())
+	{
+		Collapse collapse = queue.top();
+		queue.pop();
+		if (removed[collapse.From] || removed[collapse.To] ||
+			versions[collapse.From] != collapse.FromVersion || versions[collapse.To] != collapse.ToVersion)
+			continue;
+
+		//Don't let any triangle that stays fold over or go flat
+		bool folds = false;
+		for (uint32_t t : around[collapse.From])
+		{
+			const Triangle& triangle = triangles[t];
+			if (triangle.Removed || triangle.Has(collapse.To))
+				continue;
+			glm::dvec3 before[3], after[3];
+			for (int c = 0; c < 3; c++)
+			{
+				before[c] = positions[triangle.Positions[c]];
+				after[c] = triangle.Positions[c] == collapse.From ? positions[collapse.To] : before[c];
+			}
+			glm::dvec3 oldNormal = FaceNormal(before[0], before[1], before[2]);
+			glm::dvec3 newNormal = FaceNormal(after[0], after[1], after[2]);
+			if (glm::dot(oldNormal, newNormal) <= 0.0 || glm::length(newNormal) <= 1e-6 * glm::length(oldNormal))
+			{
+				folds = true;
+				break;
+			}
+		}
+		if (folds)
+			continue;
+
+		worst = std::max(worst, collapse.Cost);
+		for (uint32_t t : around[collapse.From])
+		{
+			Triangle& triangle = triangles[t];
+			if (triangle.Removed)
+				continue;
+			if (triangle.Has(collapse.To))
+			{
+				triangle.Removed = true;
+				live--;
+				continue;
+			}
+			for (int c = 0; c < 3; c++)
+			{
+				if (triangle.Positions[c] == collapse.From)
+					triangle.Positions[c] = collapse.To;
+			}
+			around[collapse.To].push_back(t);
+		}
+		around[collapse.From].clear();
+		around[collapse.From].shrink_to_fit();
+		removed[collapse.From] = true;
+		quadrics[collapse.To].Add(quadrics[collapse.From]);
+		versions[collapse.To]++;
+
+		//Every edge out of the kept end costs something different now
+		std::vector<uint32_t>& list = around[collapse.To];
+		list.erase(std::remove_if(list.begin(), list.end(), [&](uint32_t t) { return triangles[t].Removed; }), list.end());
+		neighbours.clear();
+		for (uint32_t t : list)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				if (triangles[t].Positions[c] != collapse.To)
+					neighbours.insert(triangles[t].Positions[c]);
+			}
+		}
+		for (uint32_t neighbour : neighbours)
+			push(collapse.To, neighbour);
+	}
+	error = float(std::sqrt(worst));
+
+	//Corners that still share a position and original vertex share a vertex
+	std::unordered_map<uint64_t, uint32_t> lookup;
+	out.Indices.reserve(live * 3);
+	for (const Triangle& triangle : triangles)
+	{
+		if (triangle.Removed)
+			continue;
+		for (int c = 0; c < 3; c++)
+		{
+			uint64_t key = (uint64_t(triangle.Positions[c]) << 32) | triangle.Vertices[c];
+			auto it = lookup.find(key);
+			if (it == lookup.end())
+			{
+				VertexPosNormTexCol vertex = mesh.Vertices[triangle.Vertices[c]];
+				vertex.Position = glm::vec3(positions[triangle.Positions[c]]);
+				it = lookup.emplace(key, uint32_t(out.Vertices.size())).first;
+				out.Vertices.push_back(vertex);
+			}
+			out.Indices.push_back(it->second);
+		}
+	}
+}
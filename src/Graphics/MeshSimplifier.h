@@ -0,0 +1,19 @@
+#pragma once
+#include <cstddef>
+
+#include "Graphics/MeshData.h"
+
+//Cuts a mesh down to fewer triangles with quadric error metrics (Garland and Heckbert)
+//*Edges are collapsed cheapest first, where the cost is how far the kept vertex is from the planes of every
+//*triangle that's been merged into it. Open edges get extra planes so holes and outlines keep their shape
+//*Only positions are merged, each triangle corner keeps its own uv, normal and colour, so seams don't bleed
+class MeshSimplifier abstract
+{
+public:
+	//Collapses edges until there are at most targetTriangles (or nothing else can go without folding a triangle over)
+	//*error gets roughly the furthest any surface moved, in the mesh's units
+	static void Simplify(const MeshData& mesh, size_t targetTriangles, MeshData& out, float& error);
+
+	//How much more open edges resist moving than the surface does
+	static float BoundaryWeight;
+};
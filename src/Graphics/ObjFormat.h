@@ -0,0 +1,217 @@
+#pragma once
+#include <GLM/glm.hpp>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+#include <VertexTypes.h>
+
+//The rules for reading .obj face corners, shared by MeshData::LoadObj and ObjParser so the two can't drift apart
+//*Only meant for those two, it's all inline and not part of either one's interface
+namespace ObjFormat
+{
+	//The position, uv and normal a face corner uses (0 if it doesn't have one)
+	struct Corner
+	{
+		int Position;
+		int UV;
+		int Normal;
+
+		bool operator==(const Corner& other) const
+		{
+			return Position == other.Position && UV == other.UV && Normal == other.Normal;
+		}
+	};
+
+	//A corner's indices as they're written, negative ones are relative to how much has been read so far
+	struct RawCorner
+	{
+		long Position;
+		long UV;
+		long Normal;
+	};
+
+	//Open addressing from corners to indices, a lot quicker than unordered_map when there are this many
+	//*Position 0 marks an empty slot, a corner with no position never gets this far
+	class CornerMap
+	{
+	public:
+		explicit CornerMap(size_t count = 0)
+		{
+			size_t capacity = 16;
+			while (capacity < count * 2)
+				capacity *= 2;
+			_slots.assign(capacity, Slot());
+		}
+
+		//The index already stored for corner, or index if it's new (inserted says which)
+		uint32_t Insert(const Corner& corner, uint32_t index, bool& inserted)
+		{
+			if ((_count + 1) * 2 > _slots.size())
+				Grow();
+			size_t mask = _slots.size() - 1;
+			for (size_t slot = Hash(corner) & mask;; slot = (slot + 1) & mask)
+			{
+				if (_slots[slot].Key.Position == 0)
+				{
+					_slots[slot] = { corner, index };
+					_count++;
+					inserted = true;
+					return index;
+				}
+				if (_slots[slot].Key == corner)
+				{
+					inserted = false;
+					return _slots[slot].Index;
+				}
+			}
+		}
+
+	private:
+		struct Slot
+		{
+			Corner Key = { 0, 0, 0 };
+			uint32_t Index = 0;
+		};
+
+		static size_t Hash(const Corner& corner)
+		{
+			uint32_t hash = uint32_t(corner.Position) * 0x9e3779b1u ^ uint32_t(corner.UV) * 0x85ebca77u ^ uint32_t(corner.Normal) * 0xc2b2ae3du;
+			hash ^= hash >> 15;
+			hash *= 0x2c1b3c6du;
+			return hash ^ (hash >> 12);
+		}
+
+		void Grow()
+		{
+			std::vector<Slot> old(_slots.size() * 2);
+			old.swap(_slots);
+			_count = 0;
+			bool inserted;
+			for (const Slot& slot : old)
+			{
+				if (slot.Key.Position != 0)
+					Insert(slot.Key, slot.Index, inserted);
+			}
+		}
+
+		std::vector<Slot> _slots;
+		size_t _count = 0;
+	};
+
+	//The whitespace strtof and strtol skip
+	inline bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+	}
+
+	inline bool IsDigit(char c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	//What c_str would have at text + offset, a 0 past the end of the line
+	inline char At(const char* text, const char* end, size_t offset = 0)
+	{
+		return size_t(end - text) > offset ? text[offset] : '\0';
+	}
+
+	//strtol, but stopping at end
+	inline long ParseLong(const char* text, const char* end, const char** next)
+	{
+		const char* p = text;
+		while (p < end && IsSpace(*p))
+			p++;
+		bool negative = false;
+		if (p < end && (*p == '+' || *p == '-'))
+		{
+			negative = *p == '-';
+			p++;
+		}
+		if (p == end || !IsDigit(*p))
+		{
+			*next = text;
+			return 0;
+		}
+
+		//Anything too big clamps, like strtol
+		const unsigned long long limit = negative ? (unsigned long long)LONG_MAX + 1ull : (unsigned long long)LONG_MAX;
+		unsigned long long value = 0;
+		for (; p < end && IsDigit(*p); p++)
+		{
+			unsigned digit = unsigned(*p - '0');
+			value = value > (limit - digit) / 10 ? limit : value * 10 + digit;
+		}
+		*next = p;
+		if (negative)
+			return value == (unsigned long long)LONG_MAX + 1ull ? LONG_MIN : -long(value);
+		return long(value);
+	}
+
+	//Reads one "v", "v/vt", "v//vn" or "v/vt/vn" corner, moving text past it
+	inline bool ReadCorner(const char*& text, const char* end, RawCorner& corner)
+	{
+		const char* next;
+		long position = ParseLong(text, end, &next);
+		if (next == text)
+			return false;
+		text = next;
+		corner = { position, 0, 0 };
+
+		if (At(text, end) == '/')
+		{
+			text++;
+			if (At(text, end) != '/')
+			{
+				corner.UV = ParseLong(text, end, &next);
+				text = next;
+			}
+			if (At(text, end) == '/')
+			{
+				text++;
+				corner.Normal = ParseLong(text, end, &next);
+				text = next;
+			}
+		}
+		return true;
+	}
+
+	//Obj indices start at 1, and negative ones count back from the end
+	inline int ResolveIndex(long index, size_t count)
+	{
+		if (index < 0)
+			return int(count) + int(index) + 1;
+		return int(index);
+	}
+
+	//Resolves against how many positions, uvs and normals had been read by the face's line
+	//*False if the position doesn't exist, those corners get skipped
+	inline bool ResolveCorner(const RawCorner& raw, size_t positions, size_t uvs, size_t normals, Corner& corner)
+	{
+		corner = { ResolveIndex(raw.Position, positions), ResolveIndex(raw.UV, uvs), ResolveIndex(raw.Normal, normals) };
+		return corner.Position >= 1 && corner.Position <= int(positions);
+	}
+
+	//The vertex for a resolved corner, a uv or normal that doesn't exist (yet) is left at 0
+	inline VertexPosNormTexCol MakeVertex(const Corner& corner, const std::vector<glm::vec3>& positions, const std::vector<glm::vec2>& uvs,
+		size_t uvCount, const std::vector<glm::vec3>& normals, size_t normalCount, const glm::vec4& colour)
+	{
+		VertexPosNormTexCol vertex;
+		vertex.Position = positions[corner.Position - 1];
+		vertex.Color = colour;
+		vertex.UV = corner.UV >= 1 && corner.UV <= int(uvCount) ? uvs[corner.UV - 1] : glm::vec2(0.0f);
+		vertex.Normal = corner.Normal >= 1 && corner.Normal <= int(normalCount) ? normals[corner.Normal - 1] : glm::vec3(0.0f);
+		return vertex;
+	}
+
+	//Fans out anything bigger than a triangle
+	inline void AddFace(const std::vector<uint32_t>& face, std::vector<uint32_t>& indices)
+	{
+		for (size_t i = 2; i < face.size(); i++)
+		{
+			indices.push_back(face[0]);
+			indices.push_back(face[i - 1]);
+			indices.push_back(face[i]);
+		}
+	}
+}
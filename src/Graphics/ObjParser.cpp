@@ -0,0 +1,337 @@
+#include "ObjParser.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <Logging.h>
+
+#include "Graphics/ObjFormat.h"
+#include "Utilities/MappedFile.h"
+
+int ObjParser::Threads = 0;
+std::unique_ptr<WorkerPool> ObjParser::_workers;
+
+using namespace ObjFormat;
+
+namespace
+{
+	//Small enough for a chunk's corner map to stay in cache, which matters more than how many threads there are
+	const size_t ChunkSize = 64 * 1024;
+
+	struct Face
+	{
+		size_t FirstCorner;
+		size_t Corners;
+		//How many positions, uvs and normals the chunk had read when it got to this face
+		size_t Positions;
+		size_t UVs;
+		size_t Normals;
+	};
+
+	struct Chunk
+	{
+		const char* Begin;
+		const char* End;
+
+		std::vector<glm::vec3> Positions;
+		std::vector<glm::vec2> UVs;
+		std::vector<glm::vec3> Normals;
+		std::vector<RawCorner> Corners;
+		std::vector<Face> Faces;
+
+		//How many positions, uvs and normals come before this chunk
+		size_t FirstPosition = 0;
+		size_t FirstUV = 0;
+		size_t FirstNormal = 0;
+
+		//The corners this chunk uses, in the order it first uses them, and their vertices
+		std::vector<Corner> Unique;
+		std::vector<VertexPosNormTexCol> Vertices;
+		//Triangles, indexing into Unique, then where they go in the whole mesh's indices
+		std::vector<uint32_t> Indices;
+		size_t FirstIndex = 0;
+		//Where each of Unique ended up in the whole mesh's vertices
+		std::vector<uint32_t> Remap;
+	};
+
+	//Same records and the same rules as MeshData::LoadObj, the indices just get kept as they're written
+	void ParseLine(Chunk& chunk, const char* text, const char* end)
+	{
+		while (text < end && (*text == ' ' || *text == '\t'))
+			text++;
+		char first = At(text, end);
+		char second = At(text, end, 1);
+		const char* next;
+
+		if (first == 'v' && second == ' ')
+		{
+			glm::vec3 position;
+			position.x = ObjParser::ParseFloat(text + 2, end, &next);
+			position.y = ObjParser::ParseFloat(next, end, &next);
+			position.z = ObjParser::ParseFloat(next, end, &next);
+			chunk.Positions.push_back(position);
+		}
+		else if (first == 'v' && second == 't')
+		{
+			glm::vec2 uv;
+			uv.x = ObjParser::ParseFloat(text + 2, end, &next);
+			uv.y = ObjParser::ParseFloat(next, end, &next);
+			chunk.UVs.push_back(uv);
+		}
+		else if (first == 'v' && second == 'n')
+		{
+			glm::vec3 normal;
+			normal.x = ObjParser::ParseFloat(text + 2, end, &next);
+			normal.y = ObjParser::ParseFloat(next, end, &next);
+			normal.z = ObjParser::ParseFloat(next, end, &next);
+			chunk.Normals.push_back(normal);
+		}
+		else if (first == 'f' && second == ' ')
+		{
+			Face face = { chunk.Corners.size(), 0, chunk.Positions.size(), chunk.UVs.size(), chunk.Normals.size() };
+			text += 2;
+			RawCorner corner;
+			while (true)
+			{
+				while (text < end && (*text == ' ' || *text == '\t'))
+					text++;
+				if (!ReadCorner(text, end, corner))
+					break;
+				chunk.Corners.push_back(corner);
+			}
+			face.Corners = chunk.Corners.size() - face.FirstCorner;
+			chunk.Faces.push_back(face);
+		}
+	}
+
+	void ParseChunk(Chunk& chunk)
+	{
+		const char* line = chunk.Begin;
+		while (line < chunk.End)
+		{
+			const char* lineEnd = static_cast<const char*>(memchr(line, '\n', chunk.End - line));
+			if (lineEnd == nullptr)
+				lineEnd = chunk.End;
+			ParseLine(chunk, line, lineEnd);
+			line = lineEnd + 1;
+		}
+	}
+
+	//Works out the chunk's corners now every index can be resolved, and merges the ones it uses more than once
+	void BuildChunk(Chunk& chunk, const std::vector<glm::vec3>& positions, const std::vector<glm::vec2>& uvs,
+		const std::vector<glm::vec3>& normals, const glm::vec4& colour)
+	{
+		CornerMap lookup(chunk.Corners.size());
+		std::vector<uint32_t> face;
+		bool inserted;
+		for (const Face& raw : chunk.Faces)
+		{
+			//What MeshData::LoadObj would have read by this line
+			size_t positionCount = chunk.FirstPosition + raw.Positions;
+			size_t uvCount = chunk.FirstUV + raw.UVs;
+			size_t normalCount = chunk.FirstNormal + raw.Normals;
+
+			face.clear();
+			for (size_t i = raw.FirstCorner; i < raw.FirstCorner + raw.Corners; i++)
+			{
+				Corner corner;
+				if (!ResolveCorner(chunk.Corners[i], positionCount, uvCount, normalCount, corner))
+					continue;
+
+				uint32_t index = lookup.Insert(corner, uint32_t(chunk.Unique.size()), inserted);
+				if (inserted)
+				{
+					chunk.Unique.push_back(corner);
+					chunk.Vertices.push_back(MakeVertex(corner, positions, uvs, uvCount, normals, normalCount, colour));
+				}
+				face.push_back(index);
+			}
+			AddFace(face, chunk.Indices);
+		}
+	}
+}
+
+float ObjParser::ParseFloat(const char* text, const char* end, const char** next)
+{
+	static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+	const char* p = text;
+	while (p < end && IsSpace(*p))
+		p++;
+	bool negative = false;
+	if (p < end && (*p == '+' || *p == '-'))
+	{
+		negative = *p == '-';
+		p++;
+	}
+
+	uint64_t mantissa = 0;
+	int digits = 0;
+	int fraction = 0;
+	for (; p < end && IsDigit(*p); p++, digits++)
+		mantissa = mantissa * 10 + uint64_t(*p - '0');
+	if (p < end && *p == '.')
+	{
+		for (p++; p < end && IsDigit(*p); p++, digits++, fraction++)
+			mantissa = mantissa * 10 + uint64_t(*p - '0');
+	}
+
+	//The digits and 10 ^ fraction are both exact as doubles, so dividing them rounds once, correctly
+	//*Going on to a float rounds a second time, which only gives a different answer to rounding straight to a float
+	//*when the double landed exactly halfway between two floats
+	bool fast = digits > 0 && digits <= 19 && fraction <= 22 && mantissa <= (1ull << 53);
+	fast = fast && !(p < end && (*p == 'e' || *p == 'E' || *p == 'x' || *p == 'X'));
+	if (fast)
+	{
+		double value = double(mantissa) / powers[fraction];
+		uint64_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		if (value == 0.0 || ((bits & 0x1fffffffull) != 0x10000000ull && value >= FLT_MIN && value <= FLT_MAX))
+		{
+			*next = p;
+			float result = float(value);
+			return negative ? -result : result;
+		}
+	}
+
+	//Exponents, inf, nan, hex and anything too long, on a copy that ends where the line does
+	std::string copy(text, end);
+	char* stop;
+	float result = strtof(copy.c_str(), &stop);
+	*next = text + (stop - copy.c_str());
+	return result;
+}
+
+bool ObjParser::Load(const std::string& fileName, MeshData& mesh, WorkerPool& workers, const glm::vec4& colour)
+{
+	MappedFile file(fileName);
+	if (!file.IsOpen())
+	{
+		LOG_ERROR("Failed to open {}", fileName);
+		return false;
+	}
+
+	mesh.Clear();
+	const char* data = file.GetData();
+	size_t size = file.GetSize();
+
+	//Each chunk ends just after a newline
+	size_t chunkCount = std::max<size_t>(1, size / ChunkSize);
+	std::vector<Chunk> chunks(chunkCount);
+	const char* begin = data;
+	for (size_t i = 0; i < chunkCount; i++)
+	{
+		const char* end = data + size;
+		if (i + 1 < chunkCount)
+		{
+			const char* target = std::max(begin, data + size * (i + 1) / chunkCount);
+			const char* newline = static_cast<const char*>(memchr(target, '\n', (data + size) - target));
+			end = newline != nullptr ? newline + 1 : data + size;
+		}
+		chunks[i].Begin = begin;
+		chunks[i].End = end;
+		begin = end;
+	}
+
+	workers.ParallelFor(chunkCount, [&](size_t i) {
+		ParseChunk(chunks[i]);
+	});
+
+	//Count what comes before each chunk, then copy every chunk's records into place
+	size_t positionCount = 0, uvCount = 0, normalCount = 0;
+	for (Chunk& chunk : chunks)
+	{
+		chunk.FirstPosition = positionCount;
+		chunk.FirstUV = uvCount;
+		chunk.FirstNormal = normalCount;
+		positionCount += chunk.Positions.size();
+		uvCount += chunk.UVs.size();
+		normalCount += chunk.Normals.size();
+	}
+	std::vector<glm::vec3> positions(positionCount);
+	std::vector<glm::vec2> uvs(uvCount);
+	std::vector<glm::vec3> normals(normalCount);
+	workers.ParallelFor(chunkCount, [&](size_t i) {
+		Chunk& chunk = chunks[i];
+		std::copy(chunk.Positions.begin(), chunk.Positions.end(), positions.begin() + chunk.FirstPosition);
+		std::copy(chunk.UVs.begin(), chunk.UVs.end(), uvs.begin() + chunk.FirstUV);
+		std::copy(chunk.Normals.begin(), chunk.Normals.end(), normals.begin() + chunk.FirstNormal);
+	});
+
+	workers.ParallelFor(chunkCount, [&](size_t i) {
+		BuildChunk(chunks[i], positions, uvs, normals, colour);
+	});
+
+	//Corners get their vertex in the order they're first used across the whole file, so this part goes in order
+	//*It only sees each chunk's unique corners, which is about one per vertex
+	size_t uniqueCount = 0;
+	for (const Chunk& chunk : chunks)
+		uniqueCount += chunk.Unique.size();
+	CornerMap lookup(uniqueCount);
+	mesh.Vertices.reserve(uniqueCount);
+	size_t indexCount = 0;
+	bool inserted;
+	for (Chunk& chunk : chunks)
+	{
+		chunk.Remap.resize(chunk.Unique.size());
+		for (size_t i = 0; i < chunk.Unique.size(); i++)
+		{
+			chunk.Remap[i] = lookup.Insert(chunk.Unique[i], uint32_t(mesh.Vertices.size()), inserted);
+			if (inserted)
+				mesh.Vertices.push_back(chunk.Vertices[i]);
+		}
+		chunk.FirstIndex = indexCount;
+		indexCount += chunk.Indices.size();
+	}
+
+	mesh.Indices.resize(indexCount);
+	workers.ParallelFor(chunkCount, [&](size_t i) {
+		const Chunk& chunk = chunks[i];
+		for (size_t j = 0; j < chunk.Indices.size(); j++)
+			mesh.Indices[chunk.FirstIndex + j] = chunk.Remap[chunk.Indices[j]];
+	});
+	return true;
+}
+
+bool ObjParser::Load(const std::string& fileName, MeshData& mesh, const glm::vec4& colour)
+{
+	if (Threads == 1)
+		return MeshData::LoadObj(fileName, mesh, colour);
+
+	if (_workers == nullptr || (Threads > 0 && _workers->GetThreadCount() != Threads))
+		_workers = std::make_unique<WorkerPool>(Threads);
+	return Load(fileName, mesh, *_workers, colour);
+}
+
+bool ObjParser::Matches(const MeshData& mesh, const MeshData& reference, std::string& difference)
+{
+	if (mesh.Vertices.size() != reference.Vertices.size() || mesh.Indices.size() != reference.Indices.size())
+	{
+		difference = "has " + std::to_string(mesh.Vertices.size()) + " vertices and " + std::to_string(mesh.Indices.size()) + " indices, expected " +
+			std::to_string(reference.Vertices.size()) + " and " + std::to_string(reference.Indices.size());
+		return false;
+	}
+	//Bit for bit, both read the floats the way strtof does
+	for (size_t i = 0; i < mesh.Vertices.size(); i++)
+	{
+		if (memcmp(&mesh.Vertices[i], &reference.Vertices[i], sizeof(VertexPosNormTexCol)) != 0)
+		{
+			difference = "vertex " + std::to_string(i) + " differs";
+			return false;
+		}
+	}
+	for (size_t i = 0; i < mesh.Indices.size(); i++)
+	{
+		if (mesh.Indices[i] != reference.Indices[i])
+		{
+			difference = "index " + std::to_string(i) + " is " + std::to_string(mesh.Indices[i]) + ", expected " + std::to_string(reference.Indices[i]);
+			return false;
+		}
+	}
+	return true;
+}
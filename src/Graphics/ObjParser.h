@@ -0,0 +1,35 @@
+#pragma once
+#include <GLM/glm.hpp>
+#include <memory>
+#include <string>
+
+#include "Graphics/MeshData.h"
+#include "Utilities/WorkerPool.h"
+
+//Reads .obj files on many threads: the file is memory mapped and split into chunks on line boundaries,
+//*each chunk's records are parsed on its own, then the chunks are stitched back together using the number
+//*of positions, uvs and normals before each one. The mesh comes out exactly the same as MeshData::LoadObj's,
+//*vertex for vertex and index for index
+class ObjParser abstract
+{
+public:
+	//Returns false if the file can't be opened
+	static bool Load(const std::string& fileName, MeshData& mesh, WorkerPool& workers, const glm::vec4& colour = glm::vec4(1.0f));
+	//Same, on the shared pool below (so only call it from one thread at a time)
+	static bool Load(const std::string& fileName, MeshData& mesh, const glm::vec4& colour = glm::vec4(1.0f));
+
+	//Parses a float the way strtof does (leading whitespace, sign, digits, exponents, inf and nan), stopping at end
+	//*Plain decimals are done without strtof and still round to exactly the same float, anything else goes to strtof
+	//*next is set past the number, or to text if there wasn't one
+	static float ParseFloat(const char* text, const char* end, const char** next);
+
+	//Checks a mesh this read against what MeshData::LoadObj read from the same file, which it should match exactly
+	//*On a mismatch, difference says where the first one is
+	static bool Matches(const MeshData& mesh, const MeshData& reference, std::string& difference);
+
+	//Threads for the shared pool, 0 uses every core and 1 reads files with MeshData::LoadObj instead
+	static int Threads;
+
+private:
+	static std::unique_ptr<WorkerPool> _workers;
+};
@@ -42,6 +42,39 @@ void PostEffect::Reshape(unsigned width, unsigned height)
 	}
 }
 
+void PostEffect::SetFilter(GLenum filter)
+{
+	for (unsigned int i = 0; i < _buffers.size(); i++)
+	{
+		_buffers[i]->SetFilter(filter);
+	}
+}
+
+void PostEffect::SetViewport(int index) const
+{
+	_buffers[index]->SetViewport();
+}
+
+unsigned PostEffect::GetWidth(int index) const
+{
+	return _buffers[index]->_width;
+}
+
+unsigned PostEffect::GetHeight(int index) const
+{
+	return _buffers[index]->_height;
+}
+
+Framebuffer* PostEffect::GetBuffer(int index) const
+{
+	return _buffers[index];
+}
+
+const std::vector<Shader::sptr>& PostEffect::GetShaders() const
+{
+	return _shaders;
+}
+
 void PostEffect::Clear()
 {
 	for (unsigned int i = 0; i < _buffers.size(); i++)
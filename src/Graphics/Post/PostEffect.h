@@ -16,6 +16,21 @@ public:
 	//Reshapes the buffer
 	virtual void Reshape(unsigned width, unsigned height);
 
+	//Sets the sampling filter on all the buffers
+	void SetFilter(GLenum filter);
+
+	//Sets the viewport to the size of a buffer
+	void SetViewport(int index) const;
+
+	//Gets the size of a buffer
+	unsigned GetWidth(int index = 0) const;
+	unsigned GetHeight(int index = 0) const;
+
+	//Gets one of the buffers (so it can be read back)
+	Framebuffer* GetBuffer(int index = 0) const;
+	//Gets the shaders the effect uses
+	const std::vector<Shader::sptr>& GetShaders() const;
+
 	//Clears the buffers
 	void Clear();
 
@@ -0,0 +1,38 @@
+#include "UpscaleEffect.h"
+
+void UpscaleEffect::Init(unsigned width, unsigned height)
+{
+	int index = int(_buffers.size());
+	_buffers.push_back(new Framebuffer());
+	_buffers[index]->AddColorTarget(GL_RGBA8);
+	_buffers[index]->AddDepthTarget();
+	_buffers[index]->Init(width, height);
+
+	index = int(_shaders.size());
+	_shaders.push_back(Shader::Create());
+	_shaders[index]->LoadShaderPartFromFile("shaders/passthrough_vert.glsl", GL_VERTEX_SHADER);
+	_shaders[index]->LoadShaderPartFromFile("shaders/Post/upscale_frag.glsl", GL_FRAGMENT_SHADER);
+	_shaders[index]->Link();
+}
+
+void UpscaleEffect::ApplyEffect(PostEffect* buffer)
+{
+	BindShader(0);
+	_shaders[0]->SetUniform("u_Sharpness", _sharpness);
+	//The sharpening taps are spaced using the source resolution, not ours
+	_shaders[0]->SetUniform("u_SourceTexelSize", glm::vec2(1.0f / float(buffer->GetWidth()), 1.0f / float(buffer->GetHeight())));
+	buffer->BindColorAsTexture(0, 0, 0);
+	_buffers[0]->RenderToFSQ();
+	buffer->UnbindTexture(0);
+	UnbindShader();
+}
+
+float UpscaleEffect::GetSharpness() const
+{
+	return _sharpness;
+}
+
+void UpscaleEffect::SetSharpness(float sharpness)
+{
+	_sharpness = sharpness;
+}
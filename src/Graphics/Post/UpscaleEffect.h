@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Graphics/Post/PostEffect.h"
+
+class UpscaleEffect : public PostEffect
+{
+public:
+	//Initializes framebuffer
+	//Overrides post effect Init
+	void Init(unsigned width, unsigned height) override;
+
+	//Upscales the previous buffer into this buffer
+	//*The previous buffer should be using linear filtering
+	void ApplyEffect(PostEffect* buffer) override;
+
+	//Getters
+	float GetSharpness() const;
+
+	//Setters
+	//0 is plain bilinear, 1 is full sharpening
+	void SetSharpness(float sharpness);
+
+private:
+	float _sharpness = 0.5f;
+};
@@ -0,0 +1,73 @@
+#include "StaticBatch.h"
+
+#include <cmath>
+
+#include <GameObjectTag.h>
+#include <RendererComponent.h>
+#include <Transform.h>
+
+bool StaticBatch::Bounds::IsVisible(const glm::mat4& viewProjection) const
+{
+	//Planes come from adding or subtracting the first three rows from the last one
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+		rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+
+	for (int i = 0; i < 6; i++)
+	{
+		glm::vec4 plane = i % 2 == 0 ? rows[3] + rows[i / 2] : rows[3] - rows[i / 2];
+		//The corner furthest along the plane's normal
+		glm::vec3 corner(plane.x >= 0.0f ? Max.x : Min.x, plane.y >= 0.0f ? Max.y : Min.y, plane.z >= 0.0f ? Max.z : Min.z);
+		if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+StaticBatch::StaticBatch(float cellSize) :
+	_cellSize(cellSize > 0.0f ? cellSize : 1.0f)
+{
+}
+
+void StaticBatch::Add(const MeshData& mesh, const ShaderMaterial::sptr& material, const glm::mat4& model)
+{
+	glm::vec3 position = glm::vec3(model[3]);
+	int x = int(std::floor(position.x / _cellSize));
+	int y = int(std::floor(position.y / _cellSize));
+
+	Cell& cell = _cells[std::make_tuple(material.get(), x, y)];
+	cell.Material = material;
+	cell.Mesh.Append(mesh, model, glm::transpose(glm::inverse(glm::mat3(model))));
+}
+
+void StaticBatch::Build(entt::registry& registry, std::vector<entt::entity>& entities)
+{
+	for (auto& pair : _cells)
+	{
+		Cell& cell = pair.second;
+		Bounds bounds;
+		if (!cell.Mesh.GetBounds(bounds.Min, bounds.Max))
+			continue;
+
+		entt::entity entity = registry.create();
+		registry.emplace<Transform>(entity);
+		registry.emplace<RendererComponent>(entity).SetMesh(cell.Mesh.Bake()).SetMaterial(cell.Material);
+		registry.emplace<GameObjectTag>(entity).Name = "Static Batch";
+		registry.emplace<Bounds>(entity, bounds);
+		entities.push_back(entity);
+	}
+	_cells.clear();
+}
+
+size_t StaticBatch::GetCellCount() const
+{
+	return _cells.size();
+}
+
+size_t StaticBatch::GetTriangleCount() const
+{
+	size_t total = 0;
+	for (const auto& pair : _cells)
+		total += pair.second.Mesh.GetTriangleCount();
+	return total;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <GLM/glm.hpp>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include <ShaderMaterial.h>
+#include <entt/entt.hpp>
+
+#include "Graphics/MeshData.h"
+
+//Merges meshes that never move into a few big ones, one per material in each square cell on the ground
+//*The vertices get moved into world space up front, so a whole cell is a single draw with no model matrix,
+//*and the cells are small enough that the ones off screen can be skipped
+class StaticBatch
+{
+public:
+	//Goes on the merged entities, the render loop skips them when the box is off screen
+	struct Bounds
+	{
+		glm::vec3 Min;
+		glm::vec3 Max;
+
+		//False only if the box is fully outside one of the camera's planes
+		bool IsVisible(const glm::mat4& viewProjection) const;
+	};
+
+	StaticBatch(float cellSize);
+
+	//Adds a copy of the mesh moved by model, it goes in the cell under model's position
+	void Add(const MeshData& mesh, const ShaderMaterial::sptr& material, const glm::mat4& model);
+
+	//Uploads every cell and makes an entity to draw each one (a Transform, RendererComponent and Bounds)
+	//*The cells are emptied afterwards
+	void Build(entt::registry& registry, std::vector<entt::entity>& entities);
+
+	size_t GetCellCount() const;
+	size_t GetTriangleCount() const;
+
+private:
+	struct Cell
+	{
+		ShaderMaterial::sptr Material;
+		MeshData Mesh;
+	};
+
+	float _cellSize;
+	//Ordered, so the entities always come out in the same order
+	std::map<std::tuple<ShaderMaterial*, int, int>, Cell> _cells;
+};
@@ -0,0 +1,359 @@
+#include "Terrain.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <Logging.h>
+
+#include "Graphics/StaticBatch.h"
+#include "Utilities/ResourceTracker.h"
+#include "imgui.h"
+
+Terrain::sptr Terrain::Create(const Settings& settings, WorkerPool& workers)
+{
+	sptr terrain(new Terrain());
+	terrain->_settings = settings;
+	Settings& s = terrain->_settings;
+	s.ChunksX = std::max(s.ChunksX, 1);
+	s.ChunksY = std::max(s.ChunksY, 1);
+	s.Levels = std::max(s.Levels, 1);
+	//Even so nodes split into quarters, and small enough for 16 bit indices
+	s.GridSize = std::min(std::max(s.GridSize & ~1, 2), 128);
+	terrain->_resolution = s.GridSize << (s.Levels - 1);
+	terrain->_spacing = s.ChunkSize / terrain->_resolution;
+
+	terrain->_chunks.resize(size_t(s.ChunksX) * s.ChunksY);
+	for (int y = 0; y < s.ChunksY; y++)
+	{
+		for (int x = 0; x < s.ChunksX; x++)
+			terrain->_chunks[size_t(y) * s.ChunksX + x].Origin = s.Origin + glm::vec2(float(x), float(y)) * s.ChunkSize;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	workers.ParallelFor(terrain->_chunks.size(), [&](size_t i) {
+		terrain->BuildChunk(terrain->_chunks[i]);
+	});
+	terrain->_buildTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	for (Chunk& chunk : terrain->_chunks)
+		terrain->Upload(chunk);
+	terrain->CreateMesh();
+	LOG_INFO("Built {} terrain chunks in {:.2f}ms", terrain->_chunks.size(), terrain->_buildTime);
+	return terrain;
+}
+
+Terrain::~Terrain()
+{
+	for (Chunk& chunk : _chunks)
+	{
+		if (chunk.Texture != 0)
+		{
+			ResourceTracker::Untrack(ResourceTracker::Category::Texture2D, chunk.Texture);
+			glDeleteTextures(1, &chunk.Texture);
+		}
+	}
+	if (_vao != 0)
+	{
+		ResourceTracker::Untrack(ResourceTracker::Category::VertexArray, _vao);
+		ResourceTracker::Untrack(ResourceTracker::Category::VertexBuffer, _vertexBuffer);
+		ResourceTracker::Untrack(ResourceTracker::Category::VertexBuffer, _indexBuffer);
+		glDeleteVertexArrays(1, &_vao);
+		glDeleteBuffers(1, &_vertexBuffer);
+		glDeleteBuffers(1, &_indexBuffer);
+	}
+}
+
+void Terrain::BuildChunk(Chunk& chunk) const
+{
+	int samples = _resolution + 1;
+	chunk.Heights.resize(size_t(samples) * samples);
+	for (int y = 0; y < samples; y++)
+	{
+		float* row = &chunk.Heights[size_t(y) * samples];
+		float rowY = chunk.Origin.y + float(y) * _spacing;
+		Noise::FbmRow(chunk.Origin.x, rowY, _spacing, samples, _settings.Fbm, row);
+		for (int x = 0; x < samples; x++)
+		{
+			float height = row[x] * _settings.HeightScale;
+			if (_settings.FlatRadius > 0.0f)
+			{
+				glm::vec2 position(chunk.Origin.x + float(x) * _spacing, rowY);
+				float blend = (glm::length(position - _settings.FlatCentre) - _settings.FlatRadius) / std::max(_settings.FlatBlend, 0.001f);
+				blend = glm::clamp(blend, 0.0f, 1.0f);
+				height *= blend * blend * (3.0f - 2.0f * blend);
+			}
+			row[x] = height;
+		}
+	}
+
+	//The finest nodes look at their heights, every level after just combines the four nodes under it
+	chunk.NodeHeights.resize(_settings.Levels);
+	int nodes = 1 << (_settings.Levels - 1);
+	chunk.NodeHeights[0].resize(size_t(nodes) * nodes);
+	for (int ny = 0; ny < nodes; ny++)
+	{
+		for (int nx = 0; nx < nodes; nx++)
+		{
+			glm::vec2 range(FLT_MAX, -FLT_MAX);
+			for (int y = ny * _settings.GridSize; y <= (ny + 1) * _settings.GridSize; y++)
+			{
+				for (int x = nx * _settings.GridSize; x <= (nx + 1) * _settings.GridSize; x++)
+				{
+					float height = chunk.Heights[size_t(y) * samples + x];
+					range.x = std::min(range.x, height);
+					range.y = std::max(range.y, height);
+				}
+			}
+			chunk.NodeHeights[0][size_t(ny) * nodes + nx] = range;
+		}
+	}
+	for (int level = 1; level < _settings.Levels; level++)
+	{
+		int below = nodes;
+		nodes /= 2;
+		const std::vector<glm::vec2>& children = chunk.NodeHeights[level - 1];
+		chunk.NodeHeights[level].resize(size_t(nodes) * nodes);
+		for (int ny = 0; ny < nodes; ny++)
+		{
+			for (int nx = 0; nx < nodes; nx++)
+			{
+				glm::vec2 range(FLT_MAX, -FLT_MAX);
+				for (int c = 0; c < 4; c++)
+				{
+					const glm::vec2& child = children[size_t(ny * 2 + (c >> 1)) * below + nx * 2 + (c & 1)];
+					range.x = std::min(range.x, child.x);
+					range.y = std::max(range.y, child.y);
+				}
+				chunk.NodeHeights[level][size_t(ny) * nodes + nx] = range;
+			}
+		}
+	}
+}
+
+void Terrain::Upload(Chunk& chunk)
+{
+	int samples = _resolution + 1;
+	glGenTextures(1, &chunk.Texture);
+	glBindTexture(GL_TEXTURE_2D, chunk.Texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, samples, samples, 0, GL_RED, GL_FLOAT, chunk.Heights.data());
+	glBindTexture(GL_TEXTURE_2D, 0);
+	ResourceTracker::Track(ResourceTracker::Category::Texture2D, chunk.Texture, chunk.Heights.size() * sizeof(float));
+}
+
+void Terrain::CreateMesh()
+{
+	int grid = _settings.GridSize;
+	std::vector<glm::vec2> vertices;
+	vertices.reserve(size_t(grid + 1) * (grid + 1));
+	for (int y = 0; y <= grid; y++)
+	{
+		for (int x = 0; x <= grid; x++)
+			vertices.push_back(glm::vec2(float(x), float(y)));
+	}
+
+	//One quarter after another, so a quarter of a node is a quarter of the indices
+	std::vector<uint16_t> indices;
+	indices.reserve(size_t(grid) * grid * 6);
+	int half = grid / 2;
+	for (int quarter = 0; quarter < 4; quarter++)
+	{
+		int startX = (quarter & 1) * half;
+		int startY = (quarter >> 1) * half;
+		for (int y = startY; y < startY + half; y++)
+		{
+			for (int x = startX; x < startX + half; x++)
+			{
+				uint16_t corner = uint16_t(y * (grid + 1) + x);
+				uint16_t right = uint16_t(corner + 1);
+				uint16_t up = uint16_t(corner + grid + 1);
+				uint16_t diagonal = uint16_t(up + 1);
+				indices.insert(indices.end(), { corner, right, diagonal, corner, diagonal, up });
+			}
+		}
+	}
+
+	glGenVertexArrays(1, &_vao);
+	glBindVertexArray(_vao);
+	glGenBuffers(1, &_vertexBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec2), vertices.data(), GL_STATIC_DRAW);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), nullptr);
+	glGenBuffers(1, &_indexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	ResourceTracker::Track(ResourceTracker::Category::VertexArray, _vao, 0);
+	ResourceTracker::Track(ResourceTracker::Category::VertexBuffer, _vertexBuffer, vertices.size() * sizeof(glm::vec2));
+	ResourceTracker::Track(ResourceTracker::Category::VertexBuffer, _indexBuffer, indices.size() * sizeof(uint16_t));
+
+	_shader = Shader::Create();
+	_shader->LoadShaderPartFromFile("shaders/terrain_vert.glsl", GL_VERTEX_SHADER);
+	_shader->LoadShaderPartFromFile("shaders/terrain_frag.glsl", GL_FRAGMENT_SHADER);
+	_shader->Link();
+}
+
+float Terrain::GetHeight(const glm::vec2& position) const
+{
+	//Which height it's past on the whole terrain's grid
+	glm::vec2 grid = (position - _settings.Origin) / _spacing;
+	grid.x = glm::clamp(grid.x, 0.0f, float(_settings.ChunksX * _resolution));
+	grid.y = glm::clamp(grid.y, 0.0f, float(_settings.ChunksY * _resolution));
+	int chunkX = std::min(int(grid.x) / _resolution, _settings.ChunksX - 1);
+	int chunkY = std::min(int(grid.y) / _resolution, _settings.ChunksY - 1);
+	const Chunk& chunk = _chunks[size_t(chunkY) * _settings.ChunksX + chunkX];
+
+	glm::vec2 local = grid - glm::vec2(float(chunkX * _resolution), float(chunkY * _resolution));
+	int x = std::min(int(local.x), _resolution - 1);
+	int y = std::min(int(local.y), _resolution - 1);
+	float fx = local.x - x;
+	float fy = local.y - y;
+
+	int samples = _resolution + 1;
+	const float* row = &chunk.Heights[size_t(y) * samples + x];
+	float h00 = row[0];
+	float h10 = row[1];
+	float h01 = row[samples];
+	float h11 = row[samples + 1];
+
+	//Same split as the grid mesh's triangles
+	if (fx >= fy)
+		return h00 + fx * (h10 - h00) + fy * (h11 - h10);
+	return h00 + fx * (h11 - h01) + fy * (h01 - h00);
+}
+
+float Terrain::GetRange(int level) const
+{
+	return _settings.LodDistance * float(1 << level);
+}
+
+void Terrain::GetNodeBox(const Chunk& chunk, int level, const glm::ivec2& node, glm::vec3& min, glm::vec3& max) const
+{
+	float size = _settings.ChunkSize / float(1 << (_settings.Levels - 1 - level));
+	int nodes = 1 << (_settings.Levels - 1 - level);
+	const glm::vec2& heights = chunk.NodeHeights[level][size_t(node.y) * nodes + node.x];
+	glm::vec2 corner = chunk.Origin + glm::vec2(float(node.x), float(node.y)) * size;
+	min = glm::vec3(corner, heights.x);
+	max = glm::vec3(corner + glm::vec2(size), heights.y);
+}
+
+bool Terrain::Select(const Chunk& chunk, int level, const glm::ivec2& node, const glm::vec3& cameraPosition, const glm::mat4& viewProjection)
+{
+	glm::vec3 min, max;
+	GetNodeBox(chunk, level, node, min, max);
+	auto reaches = [&](int rangeLevel) {
+		glm::vec3 closest = glm::clamp(cameraPosition, min, max);
+		float range = GetRange(rangeLevel);
+		return glm::dot(closest - cameraPosition, closest - cameraPosition) <= range * range;
+	};
+
+	//The coarsest level covers everything else, however far away
+	if (level < _settings.Levels - 1 && !reaches(level))
+		return false;
+	//Off screen counts as handled, so the parent doesn't draw it either
+	if (!StaticBatch::Bounds{ min, max }.IsVisible(viewProjection))
+		return true;
+
+	if (level == 0 || !reaches(level - 1))
+	{
+		_selected.push_back({ &chunk, level, node, -1 });
+		return true;
+	}
+
+	//Children that are too far for the finer level get drawn as quarters of this one
+	for (int quarter = 0; quarter < 4; quarter++)
+	{
+		glm::ivec2 child(node.x * 2 + (quarter & 1), node.y * 2 + (quarter >> 1));
+		if (!Select(chunk, level - 1, child, cameraPosition, viewProjection))
+			_selected.push_back({ &chunk, level, node, quarter });
+	}
+	return true;
+}
+
+int Terrain::Render(const glm::mat4& viewProjection, const glm::vec3& cameraPosition)
+{
+	_selected.clear();
+	for (const Chunk& chunk : _chunks)
+		Select(chunk, _settings.Levels - 1, glm::ivec2(0), cameraPosition, viewProjection);
+
+	_levelCounts.assign(_settings.Levels, 0);
+	_triangles = 0;
+	if (_selected.empty() || _shader == nullptr)
+		return 0;
+
+	_shader->Bind();
+	_shader->SetUniformMatrix("u_ViewProjection", viewProjection);
+	_shader->SetUniform("u_CamPos", cameraPosition);
+	_shader->SetUniform("u_GridSize", float(_settings.GridSize));
+	_shader->SetUniform("u_Resolution", float(_resolution));
+	_shader->SetUniform("u_ChunkSize", _settings.ChunkSize);
+	_shader->SetUniform("u_HeightScale", _settings.HeightScale);
+	_shader->SetUniform("s_Height", 0);
+
+	glBindVertexArray(_vao);
+	glActiveTexture(GL_TEXTURE0);
+	const Chunk* bound = nullptr;
+	GLsizei quarterIndices = GLsizei(_settings.GridSize * _settings.GridSize / 4 * 6);
+	for (const Selected& selected : _selected)
+	{
+		if (selected.Owner != bound)
+		{
+			bound = selected.Owner;
+			glBindTexture(GL_TEXTURE_2D, bound->Texture);
+			_shader->SetUniform("u_ChunkOrigin", bound->Origin);
+		}
+
+		float size = _settings.ChunkSize / float(1 << (_settings.Levels - 1 - selected.Level));
+		_shader->SetUniform("u_NodeOrigin", bound->Origin + glm::vec2(float(selected.Node.x), float(selected.Node.y)) * size);
+		_shader->SetUniform("u_NodeSize", size);
+		//The coarsest level has nothing to slide over to
+		float end = selected.Level < _settings.Levels - 1 ? GetRange(selected.Level) : FLT_MAX;
+		float start = selected.Level < _settings.Levels - 1 ? end * (1.0f - _settings.MorphFraction) : FLT_MAX * 0.5f;
+		_shader->SetUniform("u_MorphRange", glm::vec2(start, end));
+
+		GLsizei count = selected.Quarter < 0 ? quarterIndices * 4 : quarterIndices;
+		size_t offset = selected.Quarter < 0 ? 0 : size_t(selected.Quarter) * quarterIndices;
+		glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_SHORT, (void*)(offset * sizeof(uint16_t)));
+
+		_levelCounts[selected.Level]++;
+		_triangles += size_t(count / 3);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindVertexArray(0);
+	return int(_selected.size());
+}
+
+void Terrain::RenderImGui()
+{
+	if (!ImGui::CollapsingHeader("Terrain"))
+		return;
+
+	ImGui::SliderFloat("LOD Distance", &_settings.LodDistance, 4.0f, 128.0f);
+	ImGui::SliderFloat("Morph Fraction", &_settings.MorphFraction, 0.05f, 0.5f);
+	ImGui::Text("Chunks: %zu (built in %.2fms)", _chunks.size(), _buildTime);
+	ImGui::Text("Draws: %zu, triangles: %zu", _selected.size(), _triangles);
+	for (size_t i = 0; i < _levelCounts.size(); i++)
+		ImGui::Text("Level %zu: %zu nodes", i, _levelCounts[i]);
+}
+
+const Terrain::Settings& Terrain::GetSettings() const
+{
+	return _settings;
+}
+
+size_t Terrain::GetTriangleCount() const
+{
+	return _triangles;
+}
+
+double Terrain::GetBuildTime() const
+{
+	return _buildTime;
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <GLM/glm.hpp>
+#include <glad/glad.h>
+#include <memory>
+#include <vector>
+
+#include <Shader.h>
+
+#include "Utilities/Noise.h"
+#include "Utilities/WorkerPool.h"
+
+//Heightmap ground made from fBm noise, split into square chunks that are each built on a worker thread
+//*Every chunk's heights live in a float texture, and everything is drawn with one small grid mesh (and index buffer)
+//*shared by all of them, moved and scaled to each quadtree node that gets picked (CDLOD)
+//*Nodes twice as far away are twice as big, and vertices near the end of a level's range slide onto the next
+//*level's grid in the vertex shader, so there are no cracks or pops between levels
+class Terrain
+{
+public:
+	typedef std::shared_ptr<Terrain> sptr;
+
+	struct Settings
+	{
+		//Corner the chunks start from, and how many there are each way
+		glm::vec2 Origin = glm::vec2(-64.0f);
+		int ChunksX = 2;
+		int ChunksY = 2;
+		float ChunkSize = 64.0f;
+		//Quads across the shared grid mesh (even, at most 128), and how many levels of detail a chunk splits into
+		//*A chunk's heightmap has GridSize * 2 ^ (Levels - 1) quads across
+		int GridSize = 16;
+		int Levels = 4;
+		//How far the finest level reaches, each level after reaches twice as far
+		//*Needs to be about 3 times the finest node's size (ChunkSize / 2 ^ (Levels - 1)), or a level can end up next to one 2 coarser
+		float LodDistance = 24.0f;
+		//Part of each level's range that's spent sliding over to the next one
+		float MorphFraction = 0.25f;
+
+		//Noise is about -1 to 1, this scales it into world units
+		float HeightScale = 6.0f;
+		Noise::FbmSettings Fbm;
+		//Flat within FlatRadius of FlatCentre, getting to full height FlatBlend further out (0 radius turns it off)
+		glm::vec2 FlatCentre = glm::vec2(0.0f);
+		float FlatRadius = 0.0f;
+		float FlatBlend = 8.0f;
+	};
+
+	//Builds every chunk's heights on the workers, then uploads them (call on the thread with the GL context)
+	static sptr Create(const Settings& settings, WorkerPool& workers);
+	~Terrain();
+
+	Terrain(const Terrain&) = delete;
+	Terrain& operator=(const Terrain&) = delete;
+
+	//Height of the surface the finest level draws, clamped to the edge outside the terrain
+	//*Only reads the heights, so it's safe from any thread
+	float GetHeight(const glm::vec2& position) const;
+
+	//Picks the nodes to draw this frame and draws them, returns how many draws that took
+	int Render(const glm::mat4& viewProjection, const glm::vec3& cameraPosition);
+	//Draws the terrain's settings and what got drawn last frame (call inside an ImGui window)
+	void RenderImGui();
+
+	const Settings& GetSettings() const;
+	//Triangles drawn last frame
+	size_t GetTriangleCount() const;
+	//How long the heights took to build, in milliseconds
+	double GetBuildTime() const;
+
+private:
+	Terrain() = default;
+
+	struct Chunk
+	{
+		glm::vec2 Origin;
+		//(quads + 1) squared heights, row by row from the origin
+		std::vector<float> Heights;
+		//Lowest and highest height under each node, for every level (0 is the finest)
+		std::vector<std::vector<glm::vec2>> NodeHeights;
+		GLuint Texture = 0;
+	};
+
+	//A node (or one quarter of it) that gets drawn
+	struct Selected
+	{
+		const Chunk* Owner;
+		int Level;
+		glm::ivec2 Node;
+		//0 to 3, or -1 for all of it
+		int Quarter;
+	};
+
+	void BuildChunk(Chunk& chunk) const;
+	void Upload(Chunk& chunk);
+	void CreateMesh();
+
+	//Adds the node or the parts of it that are needed, false if it's too far away for this level
+	bool Select(const Chunk& chunk, int level, const glm::ivec2& node, const glm::vec3& cameraPosition, const glm::mat4& viewProjection);
+	void GetNodeBox(const Chunk& chunk, int level, const glm::ivec2& node, glm::vec3& min, glm::vec3& max) const;
+	float GetRange(int level) const;
+
+	Settings _settings;
+	//Quads across a chunk's heightmap, and the distance between heights
+	int _resolution = 0;
+	float _spacing = 0.0f;
+	std::vector<Chunk> _chunks;
+	double _buildTime = 0.0;
+
+	Shader::sptr _shader;
+	GLuint _vao = 0;
+	GLuint _vertexBuffer = 0;
+	GLuint _indexBuffer = 0;
+
+	std::vector<Selected> _selected;
+	std::vector<size_t> _levelCounts;
+	size_t _triangles = 0;
+};
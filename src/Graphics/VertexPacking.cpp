@@ -0,0 +1,232 @@
+#include "VertexPacking.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+bool VertexPacking::Enabled = true;
+float VertexPacking::PositionTolerance = 1.0f / 2048.0f;
+float VertexPacking::UVTolerance = 1.0f / 4096.0f;
+
+namespace
+{
+	//Slots match the ones in VertexPosNormTexCol::V_DECL, so every shader reads packed meshes the same way
+	const uint32_t PositionSlot = 0;
+	const uint32_t ColourSlot = 1;
+	const uint32_t NormalSlot = 2;
+	const uint32_t UVSlot = 3;
+
+	//Signed 10 bits a component, x in the low bits (GL_INT_2_10_10_10_REV)
+	uint32_t PackNormal(const glm::vec3& normal)
+	{
+		float length = glm::length(normal);
+		glm::vec3 unit = length > 0.0f ? normal / length : normal;
+		uint32_t packed = 0;
+		for (int i = 0; i < 3; i++)
+		{
+			int32_t component = int32_t(std::round(std::clamp(unit[i], -1.0f, 1.0f) * 511.0f));
+			packed |= (uint32_t(component) & 0x3ffu) << (i * 10);
+		}
+		return packed;
+	}
+
+	uint32_t PackColour(const glm::vec4& colour)
+	{
+		uint32_t packed = 0;
+		for (int i = 0; i < 4; i++)
+			packed |= uint32_t(std::round(std::clamp(colour[i], 0.0f, 1.0f) * 255.0f)) << (i * 8);
+		return packed;
+	}
+
+	//Largest difference a value gets from going to half and back
+	float HalfError(float value)
+	{
+		return std::abs(VertexPacking::FromHalf(VertexPacking::ToHalf(value)) - value);
+	}
+
+	size_t GetSize(VertexPacking::Format format, int components)
+	{
+		switch (format)
+		{
+		case VertexPacking::Format::Float: return components * sizeof(float);
+		//Padded out to a whole number of 4 bytes
+		case VertexPacking::Format::Half: return ((components + 1) / 2) * 2 * sizeof(uint16_t);
+		default: return 4;
+		}
+	}
+}
+
+uint16_t VertexPacking::ToHalf(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	uint16_t sign = uint16_t((bits >> 16) & 0x8000u);
+	int32_t exponent = int32_t((bits >> 23) & 0xffu) - 127 + 15;
+	uint32_t mantissa = bits & 0x7fffffu;
+
+	//Too big (or inf/nan) becomes inf
+	if (exponent >= 31)
+		return sign | 0x7c00u;
+	//Too small for a normal half, becomes a denormal or zero
+	if (exponent <= 0)
+	{
+		if (exponent < -10)
+			return sign;
+		mantissa |= 0x800000u;
+		uint32_t shift = uint32_t(14 - exponent);
+		uint32_t half = mantissa >> shift;
+		uint32_t rest = mantissa & ((1u << shift) - 1u);
+		uint32_t middle = 1u << (shift - 1u);
+		if (rest > middle || (rest == middle && (half & 1u)))
+			half++;
+		return sign | uint16_t(half);
+	}
+
+	//Rounds to nearest even, a carry out of the mantissa bumps the exponent like it should
+	uint32_t half = (uint32_t(exponent) << 10) | (mantissa >> 13);
+	uint32_t rest = mantissa & 0x1fffu;
+	if (rest > 0x1000u || (rest == 0x1000u && (half & 1u)))
+		half++;
+	return sign | uint16_t(half);
+}
+
+float VertexPacking::FromHalf(uint16_t value)
+{
+	uint32_t sign = uint32_t(value & 0x8000u) << 16;
+	uint32_t exponent = (value >> 10) & 0x1fu;
+	uint32_t mantissa = value & 0x3ffu;
+	float result;
+	if (exponent == 0)
+		result = std::ldexp(float(mantissa), -24);
+	else if (exponent == 31)
+		result = mantissa == 0 ? INFINITY : NAN;
+	else
+		result = std::ldexp(float(mantissa | 0x400u), int(exponent) - 25);
+	uint32_t bits;
+	memcpy(&bits, &result, sizeof(bits));
+	bits |= sign;
+	memcpy(&result, &bits, sizeof(bits));
+	return result;
+}
+
+size_t VertexPacking::GetFullStride()
+{
+	return sizeof(VertexPosNormTexCol);
+}
+
+VertexPacking::Layout VertexPacking::Choose(const MeshData& mesh)
+{
+	Layout layout;
+	glm::vec3 min, max;
+	if (Enabled && mesh.GetBounds(min, max))
+	{
+		bool bytes = true;
+		for (const VertexPosNormTexCol& vertex : mesh.Vertices)
+		{
+			for (int i = 0; i < 3; i++)
+				layout.PositionError = std::max(layout.PositionError, HalfError(vertex.Position[i]));
+			layout.UVError = std::max(layout.UVError, std::max(HalfError(vertex.UV.x), HalfError(vertex.UV.y)));
+			for (int i = 0; i < 4; i++)
+				bytes = bytes && vertex.Color[i] >= 0.0f && vertex.Color[i] <= 1.0f;
+		}
+
+		if (layout.PositionError <= PositionTolerance * glm::length(max - min))
+			layout.Position = Format::Half;
+		if (layout.UVError <= UVTolerance)
+			layout.UV = Format::Half;
+		layout.Colour = bytes ? Format::Bytes : Format::Float;
+		layout.Packed = true;
+		layout.Stride = GetSize(layout.Position, 3) + 4 + GetSize(layout.UV, 2) + GetSize(layout.Colour, 4);
+	}
+	else
+	{
+		layout.Stride = GetFullStride();
+	}
+	return layout;
+}
+
+VertexArrayObject::sptr VertexPacking::Bake(const MeshData& mesh, const Layout& layout)
+{
+	VertexBuffer::sptr vertices = VertexBuffer::Create();
+	IndexBuffer::sptr indices = IndexBuffer::Create();
+	indices->LoadData(mesh.Indices.data(), mesh.Indices.size());
+	VertexArrayObject::sptr vao = VertexArrayObject::Create();
+
+	//The old layout goes up as it is
+	if (!layout.Packed)
+	{
+		vertices->LoadData(mesh.Vertices.data(), mesh.Vertices.size());
+		vao->AddVertexBuffer(vertices, VertexPosNormTexCol::V_DECL);
+		vao->SetIndexBuffer(indices);
+		return vao;
+	}
+
+	//Position, normal, uv then colour
+	GLsizei stride = GLsizei(layout.Stride);
+	size_t normalOffset = GetSize(layout.Position, 3);
+	size_t uvOffset = normalOffset + 4;
+	size_t colourOffset = uvOffset + GetSize(layout.UV, 2);
+
+	//Words rather than bytes so the buffer's always aligned, the buffer's element count is in words
+	std::vector<uint32_t> packed(mesh.Vertices.size() * layout.Stride / sizeof(uint32_t), 0);
+	uint8_t* out = reinterpret_cast<uint8_t*>(packed.data());
+	for (const VertexPosNormTexCol& vertex : mesh.Vertices)
+	{
+		if (layout.Position == Format::Half)
+		{
+			uint16_t position[4] = { ToHalf(vertex.Position.x), ToHalf(vertex.Position.y), ToHalf(vertex.Position.z), ToHalf(1.0f) };
+			memcpy(out, position, sizeof(position));
+		}
+		else
+		{
+			memcpy(out, &vertex.Position, sizeof(glm::vec3));
+		}
+
+		uint32_t normal = PackNormal(vertex.Normal);
+		memcpy(out + normalOffset, &normal, sizeof(normal));
+
+		if (layout.UV == Format::Half)
+		{
+			uint16_t uv[2] = { ToHalf(vertex.UV.x), ToHalf(vertex.UV.y) };
+			memcpy(out + uvOffset, uv, sizeof(uv));
+		}
+		else
+		{
+			memcpy(out + uvOffset, &vertex.UV, sizeof(glm::vec2));
+		}
+
+		if (layout.Colour == Format::Bytes)
+		{
+			uint32_t colour = PackColour(vertex.Color);
+			memcpy(out + colourOffset, &colour, sizeof(colour));
+		}
+		else if (layout.Colour == Format::Float)
+		{
+			memcpy(out + colourOffset, &vertex.Color, sizeof(glm::vec4));
+		}
+		out += layout.Stride;
+	}
+	vertices->LoadData(packed.data(), packed.size());
+
+	std::vector<BufferAttribute> attributes;
+	attributes.push_back(BufferAttribute(PositionSlot, 3, layout.Position == Format::Half ? GL_HALF_FLOAT : GL_FLOAT, false, stride, 0, AttribUsage::Position));
+	//Packed formats have to be read as 4 components, the shaders only use the first 3
+	attributes.push_back(BufferAttribute(NormalSlot, 4, GL_INT_2_10_10_10_REV, true, stride, normalOffset, AttribUsage::Normal));
+	attributes.push_back(BufferAttribute(UVSlot, 2, layout.UV == Format::Half ? GL_HALF_FLOAT : GL_FLOAT, false, stride, uvOffset, AttribUsage::Texture));
+	attributes.push_back(BufferAttribute(ColourSlot, 4, layout.Colour == Format::Bytes ? GL_UNSIGNED_BYTE : GL_FLOAT, layout.Colour == Format::Bytes, stride, colourOffset, AttribUsage::Color));
+
+	vao->AddVertexBuffer(vertices, attributes);
+	vao->SetIndexBuffer(indices);
+	return vao;
+}
+
+std::string VertexPacking::GetName(const Layout& layout)
+{
+	if (!layout.Packed)
+		return "full";
+	std::string name = layout.Position == Format::Half ? "pos16" : "pos32";
+	name += " nrm10";
+	name += layout.UV == Format::Half ? " uv16" : " uv32";
+	name += layout.Colour == Format::Bytes ? " col8" : " col32";
+	return name;
+}
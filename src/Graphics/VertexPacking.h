@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <VertexArrayObject.h>
+
+#include "Graphics/MeshData.h"
+
+//Picks a smaller vertex layout for each mesh when it's baked, using only formats the GPU's vertex fetch
+//*unpacks by itself (half floats, normalized bytes and 10_10_10_2), so the shaders still get the same vec3s and vec2s
+//*Positions and uvs are only halved if every vertex stays within tolerance, normals always go to 10 bits a component,
+//*and colours go to 4 normalized bytes
+//*The colour is always stored, even when it's white everywhere: leaving the slot without an array would read GL's
+//*current value for it, which belongs to the context rather than the vertex array, so anything could change it
+class VertexPacking abstract
+{
+public:
+	enum class Format
+	{
+		Float,
+		Half,
+		//Colour only, 4 normalized bytes
+		Bytes
+	};
+
+	struct Layout
+	{
+		//False keeps the full float layout, the formats below are ignored
+		bool Packed = false;
+		Format Position = Format::Float;
+		Format UV = Format::Float;
+		Format Colour = Format::Float;
+		//Bytes per vertex, always a multiple of 4
+		size_t Stride = 0;
+		//Largest error halving the positions or uvs gave, whether or not it was used
+		float PositionError = 0.0f;
+		float UVError = 0.0f;
+	};
+
+	//Works out the smallest layout that keeps the mesh within tolerance
+	static Layout Choose(const MeshData& mesh);
+	//Packs the mesh into layout and uploads it into a new vertex array
+	static VertexArrayObject::sptr Bake(const MeshData& mesh, const Layout& layout);
+
+	//Short name like "pos16 nrm10 uv16", for reports
+	static std::string GetName(const Layout& layout);
+	//Bytes per vertex of the full float layout every mesh used before
+	static size_t GetFullStride();
+
+	static uint16_t ToHalf(float value);
+	static float FromHalf(uint16_t value);
+
+	//Off bakes every mesh with the full float layout (for comparing against)
+	static bool Enabled;
+	//Largest position error allowed, as a fraction of the mesh's bounding box diagonal
+	static float PositionTolerance;
+	//Largest uv error allowed, a quarter of a texel on a 1024 texture by default
+	static float UVTolerance;
+};
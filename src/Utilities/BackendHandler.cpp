@@ -1,31 +1,38 @@
 #include "BackendHandler.h"
 
+#include <algorithm>
+#include <chrono>
+#include <deque>
+
+#if defined(__linux__)
+//Surfaceless EGL so we can render on machines with no display (links against libEGL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+static EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+static EGLContext eglContext = EGL_NO_CONTEXT;
+#endif
+
 GLFWwindow* BackendHandler::window = nullptr;
+bool BackendHandler::headless = false;
+int BackendHandler::headlessWidth = 0;
+int BackendHandler::headlessHeight = 0;
 std::vector<std::function<void()>> BackendHandler::imGuiCallbacks;
+int BackendHandler::headlessFramesInFlight = 2;
+
+//Fences at the end of each headless frame that the GPU might still be working on, oldest first
+static std::deque<GLsync> headlessFences;
 
 
 void BackendHandler::GlDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam)
 {
-	{
-		std::string sourceTxt;
-		switch (source) {
-		case GL_DEBUG_SOURCE_API: sourceTxt = "DEBUG"; break;
-		case GL_DEBUG_SOURCE_WINDOW_SYSTEM: sourceTxt = "WINDOW"; break;
-		case GL_DEBUG_SOURCE_SHADER_COMPILER: sourceTxt = "SHADER"; break;
-		case GL_DEBUG_SOURCE_THIRD_PARTY: sourceTxt = "THIRD PARTY"; break;
-		case GL_DEBUG_SOURCE_APPLICATION: sourceTxt = "APP"; break;
-		case GL_DEBUG_SOURCE_OTHER: default: sourceTxt = "OTHER"; break;
-		}
-		switch (severity) {
-		case GL_DEBUG_SEVERITY_LOW:          LOG_INFO("[{}] {}", sourceTxt, message); break;
-		case GL_DEBUG_SEVERITY_MEDIUM:       LOG_WARN("[{}] {}", sourceTxt, message); break;
-		case GL_DEBUG_SEVERITY_HIGH:         LOG_ERROR("[{}] {}", sourceTxt, message); break;
-#ifdef LOG_GL_NOTIFICATIONS
-		case GL_DEBUG_SEVERITY_NOTIFICATION: LOG_INFO("[{}] {}", sourceTxt, message); break;
+#ifndef LOG_GL_NOTIFICATIONS
+	if (severity == GL_DEBUG_SEVERITY_NOTIFICATION)
+		return;
 #endif
-		default: break;
-		}
-	}
+	//This can run on a driver thread in the middle of a draw, so it only copies the message out
+	//*GlDebugLog formats and writes it from its own thread
+	GlDebugLog::Push(source, type, id, severity, length, message);
 }
 
 bool BackendHandler::InitAll()
@@ -39,8 +46,32 @@ bool BackendHandler::InitAll()
 		return 1;
 
 	Framebuffer::InitFullscreenQuad();
+	GpuProfiler::Init();
 
 	InitImGui();
+
+	return true;
+}
+
+bool BackendHandler::InitAllHeadless(int width, int height)
+{
+	Logger::Init();
+	Util::Init();
+
+	headless = true;
+	headlessWidth = width;
+	headlessHeight = height;
+
+	if (!InitHeadlessContext())
+		return false;
+
+	LOG_INFO("Headless renderer: {} ({})", (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION));
+
+	Framebuffer::InitFullscreenQuad();
+	GpuProfiler::Init();
+
+	//No ImGui here, there is nothing to draw it to (and no viewports to drag it into)
+	return true;
 }
 
 void BackendHandler::GlfwWindowResizedCallback(GLFWwindow* window, int width, int height)
@@ -70,6 +101,10 @@ void BackendHandler::GlfwWindowResizedCallback(GLFWwindow* window, int width, in
 	{
 		buf.Reshape(width, height);
 	});
+	Application::Instance().ActiveScene->Registry().view<UpscaleEffect>().each([=](UpscaleEffect& buf)
+	{
+		buf.Reshape(width, height);
+	});
 }
 
 bool BackendHandler::InitGLFW()
@@ -96,6 +131,153 @@ bool BackendHandler::InitGLFW()
 	return true;
 }
 
+bool BackendHandler::InitHeadlessContext()
+{
+#if defined(__linux__)
+	//Prefer the surfaceless platform, it doesn't need an X server or a GPU (Mesa llvmpipe works)
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay != nullptr)
+		eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	if (eglDisplay == EGL_NO_DISPLAY)
+		eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+	EGLint major, minor;
+	if (eglDisplay == EGL_NO_DISPLAY || eglInitialize(eglDisplay, &major, &minor) == EGL_FALSE) {
+		LOG_ERROR("Failed to initialize EGL");
+		return false;
+	}
+
+	if (eglBindAPI(EGL_OPENGL_API) == EGL_FALSE) {
+		LOG_ERROR("EGL does not support desktop OpenGL");
+		return false;
+	}
+
+	//We never create a surface, so we don't need a config (EGL_KHR_no_config_context)
+	const EGLint contextAttribs[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 4,
+		EGL_CONTEXT_MINOR_VERSION, 5,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+#ifdef _DEBUG
+		EGL_CONTEXT_OPENGL_DEBUG, EGL_TRUE,
+#endif
+		EGL_NONE
+	};
+	eglContext = eglCreateContext(eglDisplay, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttribs);
+	if (eglContext == EGL_NO_CONTEXT) {
+		LOG_ERROR("Failed to create EGL context");
+		return false;
+	}
+
+	//Surfaceless, everything has to go into framebuffers (EGL_KHR_surfaceless_context)
+	if (eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext) == EGL_FALSE) {
+		LOG_ERROR("Failed to make EGL context current");
+		return false;
+	}
+
+	if (gladLoadGLLoader((GLADloadproc)eglGetProcAddress) == 0) {
+		LOG_ERROR("Failed to initialize Glad");
+		return false;
+	}
+	return true;
+#else
+	if (glfwInit() == GLFW_FALSE) {
+		LOG_ERROR("Failed to initialize GLFW");
+		return false;
+	}
+
+	//A window that is never shown, we still only render into framebuffers
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	window = glfwCreateWindow(headlessWidth, headlessHeight, "CG Assignment Project (Headless)", nullptr, nullptr);
+	if (window == nullptr) {
+		LOG_ERROR("Failed to create hidden GLFW window");
+		return false;
+	}
+	glfwMakeContextCurrent(window);
+
+	return InitGLAD();
+#endif
+}
+
+void BackendHandler::ShutdownHeadless()
+{
+	//The fences belong to the context, so they go first
+	for (GLsync fence : headlessFences)
+		glDeleteSync(fence);
+	headlessFences.clear();
+#if defined(__linux__)
+	if (eglDisplay != EGL_NO_DISPLAY) {
+		eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		if (eglContext != EGL_NO_CONTEXT)
+			eglDestroyContext(eglDisplay, eglContext);
+		eglTerminate(eglDisplay);
+	}
+	eglContext = EGL_NO_CONTEXT;
+	eglDisplay = EGL_NO_DISPLAY;
+#else
+	if (window != nullptr)
+		glfwDestroyWindow(window);
+	window = nullptr;
+	glfwTerminate();
+#endif
+}
+
+void BackendHandler::GetWindowSize(int& width, int& height)
+{
+	if (headless) {
+		width = headlessWidth;
+		height = headlessHeight;
+		return;
+	}
+	glfwGetWindowSize(window, &width, &height);
+}
+
+double BackendHandler::GetTime()
+{
+	if (headless) {
+		//GLFW might not be initialized, so use our own clock
+		static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+	return glfwGetTime();
+}
+
+bool BackendHandler::ShouldClose()
+{
+	//Headless runs are ended by whoever is driving them
+	if (headless)
+		return false;
+	return glfwWindowShouldClose(window);
+}
+
+void BackendHandler::PollEvents()
+{
+	if (!headless)
+		glfwPollEvents();
+}
+
+void BackendHandler::SwapBuffers()
+{
+	if (headless) {
+		//Nothing to present, but a swap chain only lets the GPU get a couple of frames behind, so we do the same
+		//*Waiting on this frame (glFinish) would finish any async readbacks with it, making them as slow as sync ones
+		headlessFences.push_back(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+		glFlush();
+		while (int(headlessFences.size()) > std::max(headlessFramesInFlight, 0)) {
+			GLsync fence = headlessFences.front();
+			headlessFences.pop_front();
+			//The timeout is in ns, keep going until it's done
+			GLenum status;
+			do {
+				status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+			} while (status == GL_TIMEOUT_EXPIRED);
+			glDeleteSync(fence);
+		}
+		return;
+	}
+	glfwSwapBuffers(window);
+}
+
 bool BackendHandler::InitGLAD()
 {
 	if (gladLoadGLLoader((GLADloadproc)glfwGetProcAddress) == 0) {
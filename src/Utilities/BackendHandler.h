@@ -2,10 +2,31 @@
 
 #include "Utilities/Util.h"
 #include "Utilities/EnvironmentGenerator.h"
+#include "Utilities/GpuProfiler.h"
+#include "Utilities/FrameStats.h"
+#include "Utilities/LaunchOptions.h"
+#include "Utilities/BenchmarkRunner.h"
+#include "Utilities/MicroBenchmark.h"
+#include "Utilities/CpuBenchmarks.h"
+#include "Utilities/GoldenImageTest.h"
+#include "Utilities/ImageCompare.h"
+#include "Utilities/VideoCapture.h"
+#include "Utilities/Input.h"
+#include "Utilities/FixedTimestep.h"
+#include "Utilities/ResourceTracker.h"
+#include "Utilities/GlDebugLog.h"
+#include "Utilities/ImageIO.h"
 #include "Graphics/Post/GreyscaleEffect.h"
 #include "Graphics/Post/SepiaEffect.h"
 #include "Graphics/Post/BloomEffect.h"
+#include "Graphics/Post/UpscaleEffect.h"
+#include "Graphics/DynamicResolution.h"
 #include "Graphics/LUT.h"
+#include "Graphics/StaticBatch.h"
+#include "Graphics/MeshLod.h"
+#include "Graphics/MeshOptimizer.h"
+#include "Graphics/ObjParser.h"
+#include "Graphics/VertexPacking.h"
 
 #include <iostream>
 #include <Logging.h>
@@ -45,6 +66,8 @@ public:
 
 	//Initialize everything
 	static bool InitAll();
+	//Initialize everything without a window (or ImGui), so we can only render into framebuffers
+	static bool InitAllHeadless(int width, int height);
 
 	//Window resize callback
 	static void GlfwWindowResizedCallback(GLFWwindow* window, int width, int height);
@@ -53,6 +76,17 @@ public:
 	static bool InitGLFW();
 	static bool InitGLAD();
 
+	//Creates a context with no window (surfaceless EGL on linux, a hidden GLFW window elsewhere)
+	static bool InitHeadlessContext();
+	static void ShutdownHeadless();
+
+	//Window helpers that also work when we're headless
+	static void GetWindowSize(int& width, int& height);
+	static double GetTime();
+	static bool ShouldClose();
+	static void PollEvents();
+	static void SwapBuffers();
+
 	//ImGui Init Functions
 	static void InitImGui();
 	static void ShutdownImGui();
@@ -63,5 +97,12 @@ public:
 	static void SetupShaderForFrame(const Shader::sptr& shader, const glm::mat4& view, const glm::mat4& projection);
 
 	static GLFWwindow* window;
+	//Are we running without a window
+	static bool headless;
+	//Size we pretend the window is when headless
+	static int headlessWidth;
+	static int headlessHeight;
+	//How many frames the GPU can be behind when headless before SwapBuffers waits (0 waits for every frame)
+	static int headlessFramesInFlight;
 	static std::vector<std::function<void()>> imGuiCallbacks;
 };
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include "BenchmarkRunner.h"
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <json.hpp>
+#include <Logging.h>
+#include <Application.h>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#include <Psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+BenchmarkRunner::BenchmarkRunner(const std::vector<Scene>& scenes, int measuredFrames, int warmupFrames, float timestep)
+{
+	_scenes = scenes;
+	_records.resize(scenes.size());
+	_measuredFrames = measuredFrames;
+	//We need a few frames between scenes for the GPU timings of the last one to come back
+	_warmupFrames = warmupFrames < 8 ? 8 : warmupFrames;
+	_timestep = timestep;
+}
+
+bool BenchmarkRunner::BeginFrame(uint64_t frameNumber)
+{
+	//Move on once this scene has had all its frames
+	if (_currentScene < 0 || _sceneFrame >= _warmupFrames + _measuredFrames)
+	{
+		_currentScene++;
+		if (_currentScene >= int(_scenes.size()))
+			return false;
+
+		StartScene();
+	}
+
+	if (_sceneFrame == _warmupFrames)
+		_records[_currentScene].FirstFrame = frameNumber;
+
+	_measuring = _sceneFrame >= _warmupFrames;
+	return true;
+}
+
+void BenchmarkRunner::EndFrame(const FrameStats& stats, int drawCalls, size_t triangles)
+{
+	if (_measuring)
+	{
+		_records[_currentScene].TotalDrawCalls += drawCalls;
+		_records[_currentScene].TotalTriangles += double(triangles);
+		_records[_currentScene].MeasuredFrames++;
+	}
+
+	_sceneFrame++;
+
+	//The warmup is long enough for the last scene's GPU times to have come back
+	if (_sceneFrame == _warmupFrames && _currentScene > 0)
+		CollectSamples(stats, _records[_currentScene - 1]);
+
+	//Memory is taken once the scene has settled
+	if (_sceneFrame == _warmupFrames + _measuredFrames)
+		_records[_currentScene].Memory = GetProcessMemory();
+}
+
+void BenchmarkRunner::StartScene()
+{
+	const Scene& scene = _scenes[_currentScene];
+	LOG_INFO("Benchmark scene {} ({} props)", scene.Name, scene.Props);
+
+	auto start = std::chrono::steady_clock::now();
+	if (SetupScene)
+		SetupScene(scene);
+	auto end = std::chrono::steady_clock::now();
+
+	_records[_currentScene].SetupTime = std::chrono::duration<double, std::milli>(end - start).count();
+	_records[_currentScene].Generation = EnvironmentGenerator::GetLastTimings();
+	_records[_currentScene].Entities = Application::Instance().ActiveScene->Registry().size();
+	_sceneFrame = 0;
+}
+
+size_t BenchmarkRunner::GetFramesNeeded() const
+{
+	return size_t(_measuredFrames) + size_t(_warmupFrames);
+}
+
+void BenchmarkRunner::CollectSamples(const FrameStats& stats, SceneRecord& record) const
+{
+	if (record.Collected || record.MeasuredFrames == 0)
+		return;
+	stats.CopyFrames(record.FirstFrame, record.FirstFrame + record.MeasuredFrames, record.Samples);
+	record.Collected = true;
+	if (record.Samples.size() < size_t(record.MeasuredFrames))
+		LOG_ERROR("Only {} of {} benchmark frames were still in the frame stats", record.Samples.size(), record.MeasuredFrames);
+}
+
+float BenchmarkRunner::GetTimestep() const
+{
+	return _timestep;
+}
+
+const std::string& BenchmarkRunner::GetSceneName() const
+{
+	static const std::string none;
+	return _currentScene >= 0 && _currentScene < int(_scenes.size()) ? _scenes[_currentScene].Name : none;
+}
+
+bool BenchmarkRunner::WriteResults(const std::string& path, const FrameStats& stats, int width, int height, unsigned seed)
+{
+	//The last scene (or one cut short) hasn't been copied out yet
+	for (SceneRecord& record : _records)
+		CollectSamples(stats, record);
+
+	auto describe = [](std::vector<float>& values) {
+		FrameStats::Distribution dist = FrameStats::Describe(values);
+		nlohmann::json result;
+		result["mean"] = dist.Mean;
+		result["p50"] = dist.P50;
+		result["p95"] = dist.P95;
+		result["p99"] = dist.P99;
+		result["min"] = dist.Min;
+		result["max"] = dist.Max;
+		return result;
+	};
+
+	nlohmann::json root;
+	root["build"]["date"] = __DATE__;
+	root["build"]["time"] = __TIME__;
+#ifdef _DEBUG
+	root["build"]["config"] = "debug";
+#else
+	root["build"]["config"] = "release";
+#endif
+	root["seed"] = seed;
+	root["timestep"] = _timestep;
+	root["warmup_frames"] = _warmupFrames;
+	root["measured_frames"] = _measuredFrames;
+	root["resolution"] = { width, height };
+	root["scenes"] = nlohmann::json::array();
+
+	for (size_t i = 0; i < _scenes.size(); i++)
+	{
+		const SceneRecord& record = _records[i];
+		if (record.MeasuredFrames == 0)
+			continue;
+
+		std::vector<float> cpu, gpu, frame;
+		for (const FrameStats::Sample& sample : record.Samples)
+		{
+			cpu.push_back(sample.CpuTime);
+			frame.push_back(sample.PresentInterval);
+			if (sample.GpuTime >= 0.0f)
+				gpu.push_back(sample.GpuTime);
+		}
+
+		nlohmann::json scene;
+		scene["name"] = _scenes[i].Name;
+		scene["props"] = _scenes[i].Props;
+		scene["baked"] = _scenes[i].Baked;
+		scene["instanced"] = _scenes[i].Instanced;
+		scene["lod"] = _scenes[i].Lod;
+		scene["impostors"] = _scenes[i].Impostors;
+		scene["trees_only"] = _scenes[i].TreesOnly;
+		scene["entities"] = record.Entities;
+		scene["frames"] = record.MeasuredFrames;
+		scene["gpu_frames"] = gpu.size();
+		scene["setup_ms"] = record.SetupTime;
+		scene["regenerate_ms"]["clean"] = record.Generation.Clean;
+		scene["regenerate_ms"]["place"] = record.Generation.Place;
+		scene["regenerate_ms"]["spawn"] = record.Generation.Spawn;
+		scene["regenerate_ms"]["bake"] = record.Generation.Bake;
+		scene["cpu_ms"] = describe(cpu);
+		scene["gpu_ms"] = describe(gpu);
+		scene["frame_ms"] = describe(frame);
+		scene["draw_calls"] = record.TotalDrawCalls / double(record.MeasuredFrames);
+		scene["lod_triangles"] = record.TotalTriangles / double(record.MeasuredFrames);
+		scene["memory_bytes"] = record.Memory;
+		root["scenes"].push_back(scene);
+	}
+
+	std::ofstream file(path);
+	if (!file.is_open())
+	{
+		LOG_ERROR("Failed to write benchmark results to {}", path);
+		return false;
+	}
+	file << root.dump(4);
+	return true;
+}
+
+std::vector<BenchmarkRunner::Scene> BenchmarkRunner::DefaultScenes()
+{
+	return {
+		{ "lego", 0 },
+		{ "props_1k", 1000 },
+		{ "props_10k", 10000 },
+		{ "props_100k", 100000 },
+		{ "props_10k_baked", 10000, true },
+		{ "props_100k_baked", 100000, true },
+		{ "props_10k_instanced", 10000, false, false, false, false, true },
+		{ "props_100k_instanced", 100000, false, false, false, false, true },
+		{ "lego_lod", 0, false, true },
+		{ "props_10k_lod", 10000, false, true },
+		{ "props_100k_lod", 100000, false, true },
+		{ "trees_100k_lod", 100000, false, true, false, true },
+		{ "trees_100k_impostors", 100000, false, true, true, true }
+	};
+}
+
+std::vector<BenchmarkRunner::Scene> BenchmarkRunner::FilterScenes(const std::vector<Scene>& scenes, const std::string& names)
+{
+	if (names.empty())
+		return scenes;
+
+	std::vector<Scene> result;
+	std::stringstream stream(names);
+	std::string name;
+	while (std::getline(stream, name, ','))
+	{
+		for (const Scene& scene : scenes)
+		{
+			if (scene.Name == name)
+				result.push_back(scene);
+		}
+	}
+	return result;
+}
+
+size_t BenchmarkRunner::GetProcessMemory()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.WorkingSetSize;
+	return 0;
+#elif defined(__linux__)
+	//Second number in statm is the resident set, in pages
+	std::ifstream statm("/proc/self/statm");
+	size_t pages = 0, resident = 0;
+	if (statm >> pages >> resident)
+		return resident * size_t(sysconf(_SC_PAGESIZE));
+	return 0;
+#else
+	return 0;
+#endif
+}
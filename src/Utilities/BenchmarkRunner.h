@@ -0,0 +1,101 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Utilities/FrameStats.h"
+#include "Utilities/EnvironmentGenerator.h"
+
+//Steps through a list of benchmark scenes inside the normal render loop
+//*Each scene gets some warmup frames, then a fixed number of measured frames
+//*at a fixed timestep, so runs can be compared against each other
+class BenchmarkRunner
+{
+public:
+	//A scene to measure
+	struct Scene
+	{
+		std::string Name;
+		//How many generated props to add on top of the lego scene
+		int Props;
+		//Merge the props into static batches instead of drawing them one at a time
+		bool Baked = false;
+		//Let LodSystem pick levels of detail (otherwise everything is drawn in full)
+		bool Lod = false;
+		//Turn far away props into impostor cards (needs Lod)
+		bool Impostors = false;
+		//Only pines and trees, no rocks
+		bool TreesOnly = false;
+		//Draw each cell's copies of a prop with one instanced draw instead of merging them (the other way to Baked)
+		bool Instanced = false;
+	};
+
+	BenchmarkRunner(const std::vector<Scene>& scenes, int measuredFrames, int warmupFrames = 30, float timestep = 1.0f / 60.0f);
+
+	//Called whenever a new scene starts, this should build it and reset the camera path
+	std::function<void(const Scene&)> SetupScene;
+
+	//Call at the top of the frame with the frame number FrameStats is about to record
+	//*Returns false once every scene has been measured
+	bool BeginFrame(uint64_t frameNumber);
+	//Call at the end of the frame (after FrameStats has recorded it) with how many draw calls it made, and how many
+	//*triangles the meshes with levels of detail drew
+	//*Each scene's frames are copied out of stats once the next one has warmed up, when their GPU times are back
+	void EndFrame(const FrameStats& stats, int drawCalls, size_t triangles);
+
+	//How many frames FrameStats has to hold at once (a scene's measured frames and the next one's warmup)
+	//*Anything past FrameStats::CAPACITY would be written over before it's copied
+	size_t GetFramesNeeded() const;
+
+	//Timestep to run the simulation at
+	float GetTimestep() const;
+	//Name of the scene being run
+	const std::string& GetSceneName() const;
+
+	//Writes the results of every scene to a json file
+	//*The last scene's frames are still in stats, and their GPU times need to have come back, so flush the profiler first
+	bool WriteResults(const std::string& path, const FrameStats& stats, int width, int height, unsigned seed);
+
+	//The standard scenes (the lego scene, then 1k, 10k and 100k props, then 10k and 100k baked into static batches,
+	//*then 10k and 100k instanced, then the lego scene, 10k and 100k again with levels of detail, then 100k trees
+	//*with and without impostors)
+	static std::vector<Scene> DefaultScenes();
+	//Only keeps the scenes in a comma separated list of names
+	static std::vector<Scene> FilterScenes(const std::vector<Scene>& scenes, const std::string& names);
+
+	//Resident memory of the process in bytes (0 if we can't tell)
+	static size_t GetProcessMemory();
+
+private:
+	//What we measured for a scene
+	struct SceneRecord
+	{
+		uint64_t FirstFrame = 0;
+		double SetupTime = 0.0;
+		//The environment generator's part of the setup
+		EnvironmentGenerator::Timings Generation;
+		double TotalDrawCalls = 0.0;
+		double TotalTriangles = 0.0;
+		int MeasuredFrames = 0;
+		size_t Memory = 0;
+		size_t Entities = 0;
+		//The measured frames, copied out of FrameStats before the ring wraps around
+		std::vector<FrameStats::Sample> Samples;
+		bool Collected = false;
+	};
+
+	//Starts the next scene
+	void StartScene();
+	//Copies a scene's measured frames out of stats
+	void CollectSamples(const FrameStats& stats, SceneRecord& record) const;
+
+	std::vector<Scene> _scenes;
+	std::vector<SceneRecord> _records;
+	int _measuredFrames;
+	int _warmupFrames;
+	float _timestep;
+
+	int _currentScene = -1;
+	int _sceneFrame = 0;
+	bool _measuring = false;
+};
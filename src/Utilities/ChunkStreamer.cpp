@@ -0,0 +1,253 @@
+#include "ChunkStreamer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+ChunkStreamer::ChunkStreamer() :
+	_generated(0),
+	_lastGenerateTime(0.0f)
+{
+}
+
+ChunkStreamer::~ChunkStreamer()
+{
+	Stop();
+}
+
+void ChunkStreamer::Start(const std::vector<PropPlacement::Object>& objects, uint64_t seed, float chunkSize)
+{
+	Stop();
+
+	_objects = objects;
+	_seed = seed;
+	_chunkSize = chunkSize > 0.0f ? chunkSize : 1.0f;
+
+	//The grid covers every object's spawn area
+	bool first = true;
+	for (const PropPlacement::Object& object : _objects)
+	{
+		if (object.Count <= 0)
+			continue;
+		glm::vec2 from = glm::min(object.SpawnFrom, object.SpawnTo);
+		glm::vec2 to = glm::max(object.SpawnFrom, object.SpawnTo);
+		_min = first ? from : glm::min(_min, from);
+		_max = first ? to : glm::max(_max, to);
+		first = false;
+	}
+	_columns = std::max(1, int(std::ceil((_max.x - _min.x) / _chunkSize)));
+	_rows = std::max(1, int(std::ceil((_max.y - _min.y) / _chunkSize)));
+
+	_areas.resize(_objects.size());
+	for (size_t i = 0; i < _objects.size(); i++)
+		_areas[i] = _objects[i].Count > 0 ? PropPlacement::GetArea(_objects[i], _objects[i].SpawnFrom, _objects[i].SpawnTo) : 0.0;
+
+	_generated = 0;
+	_lastGenerateTime = 0.0f;
+	_running = true;
+	_worker = std::thread(&ChunkStreamer::WorkerLoop, this);
+}
+
+void ChunkStreamer::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (!_running)
+			return;
+		_running = false;
+	}
+	_wake.notify_all();
+	if (_worker.joinable())
+		_worker.join();
+
+	_requests.clear();
+	_finished.clear();
+	_working = false;
+	_waiting.clear();
+	_loaded.clear();
+}
+
+bool ChunkStreamer::IsRunning() const
+{
+	return _running;
+}
+
+void ChunkStreamer::Update(glm::vec2 camera, std::vector<Coord>& unload, std::vector<Chunk>& ready)
+{
+	if (!_running)
+		return;
+
+	Coord centre = { int(std::floor((camera.x - _min.x) / _chunkSize)), int(std::floor((camera.y - _min.y) / _chunkSize)) };
+	int keep = LoadRadius + UnloadMargin;
+
+	//Let go of anything the camera has left behind
+	for (auto it = _loaded.begin(); it != _loaded.end();)
+	{
+		Coord coord = { int(uint32_t(*it >> 32)), int(uint32_t(*it)) };
+		if (GetDistance(coord, centre) > keep)
+		{
+			unload.push_back(coord);
+			it = _loaded.erase(it);
+		}
+		else
+			++it;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (Chunk& chunk : _finished)
+			_waiting.push_back(std::move(chunk));
+		_finished.clear();
+	}
+
+	//Hand over a few finished chunks, skipping any the camera has already moved away from
+	_waiting.erase(std::remove_if(_waiting.begin(), _waiting.end(), [&](const Chunk& chunk) {
+		return GetDistance(chunk.Position, centre) > keep;
+	}), _waiting.end());
+	while (!_waiting.empty() && int(ready.size()) < MaxReadyPerUpdate)
+	{
+		//insert only fails if it was made twice, which can happen when it finishes just as the requests are swapped
+		if (_loaded.insert(GetKey(_waiting.front().Position)).second)
+			ready.push_back(std::move(_waiting.front()));
+		_waiting.pop_front();
+	}
+
+	//Everything in range that we don't have yet, nearest first
+	std::unordered_set<uint64_t> waiting;
+	for (const Chunk& chunk : _waiting)
+		waiting.insert(GetKey(chunk.Position));
+	std::vector<std::pair<int, Coord>> wanted;
+	for (int y = centre.Y - LoadRadius; y <= centre.Y + LoadRadius; y++)
+	{
+		for (int x = centre.X - LoadRadius; x <= centre.X + LoadRadius; x++)
+		{
+			Coord coord = { x, y };
+			uint64_t key = GetKey(coord);
+			if (!IsInGrid(coord) || _loaded.count(key) != 0 || waiting.count(key) != 0)
+				continue;
+			int dx = x - centre.X;
+			int dy = y - centre.Y;
+			wanted.emplace_back(dx * dx + dy * dy, coord);
+		}
+	}
+	std::stable_sort(wanted.begin(), wanted.end(), [](const std::pair<int, Coord>& a, const std::pair<int, Coord>& b) {
+		return a.first < b.first;
+	});
+
+	//Old requests that are out of range just get dropped
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (const Chunk& chunk : _finished)
+			waiting.insert(GetKey(chunk.Position));
+		_requests.clear();
+		for (const auto& request : wanted)
+		{
+			uint64_t key = GetKey(request.second);
+			if ((_working && GetKey(_workingOn) == key) || waiting.count(key) != 0)
+				continue;
+			_requests.push_back(request.second);
+		}
+	}
+	_wake.notify_one();
+}
+
+float ChunkStreamer::GetChunkSize() const
+{
+	return _chunkSize;
+}
+
+size_t ChunkStreamer::GetLoadedCount() const
+{
+	return _loaded.size();
+}
+
+size_t ChunkStreamer::GetPendingCount()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _requests.size() + (_working ? 1 : 0) + _finished.size() + _waiting.size();
+}
+
+uint64_t ChunkStreamer::GetGeneratedCount() const
+{
+	return _generated;
+}
+
+float ChunkStreamer::GetLastGenerateTime() const
+{
+	return _lastGenerateTime;
+}
+
+size_t ChunkStreamer::GetMaxLoaded() const
+{
+	size_t side = size_t(2 * (LoadRadius + UnloadMargin) + 1);
+	return side * side;
+}
+
+uint64_t ChunkStreamer::GetKey(Coord coord)
+{
+	return (uint64_t(uint32_t(coord.X)) << 32) | uint32_t(coord.Y);
+}
+
+void ChunkStreamer::WorkerLoop()
+{
+	while (true)
+	{
+		Coord coord;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_wake.wait(lock, [this]() { return !_running || !_requests.empty(); });
+			if (!_running)
+				return;
+			coord = _requests.front();
+			_requests.pop_front();
+			_working = true;
+			_workingOn = coord;
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		Chunk chunk;
+		Generate(coord, chunk);
+		_lastGenerateTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		_generated++;
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_finished.push_back(std::move(chunk));
+		_working = false;
+	}
+}
+
+void ChunkStreamer::Generate(Coord coord, Chunk& chunk)
+{
+	glm::vec2 chunkMin = _min + glm::vec2(float(coord.X), float(coord.Y)) * _chunkSize;
+	glm::vec2 chunkMax = glm::min(chunkMin + glm::vec2(_chunkSize), _max);
+
+	//Each object's count is shared out by area, the fraction left over is rounded up or down from the chunk's own stream
+	std::vector<int> counts(_objects.size(), 0);
+	size_t total = 0;
+	float maxRadius = 0.0f;
+	for (size_t i = 0; i < _objects.size(); i++)
+	{
+		if (_objects[i].Count <= 0 || _areas[i] <= 0.0)
+			continue;
+		double expected = _objects[i].Count * (PropPlacement::GetArea(_objects[i], chunkMin, chunkMax) / _areas[i]);
+		Util::Random random(_seed + 1, PropPlacement::GetStream(i, coord.X, coord.Y));
+		counts[i] = int(expected) + (random.NextFloat() < float(expected - int(expected)) ? 1 : 0);
+		total += counts[i];
+		maxRadius = std::max(maxRadius, _objects[i].Radius);
+	}
+
+	chunk.Position = coord;
+	chunk.Placements.assign(_objects.size(), std::vector<PropPlacement::Placement>());
+	_disk.Reset(2.0f * maxRadius, total);
+	PropPlacement::PlaceChunk(_objects, counts, chunkMin, chunkMax, true, _seed, coord.X, coord.Y, _disk, chunk.Placements);
+}
+
+bool ChunkStreamer::IsInGrid(Coord coord) const
+{
+	return coord.X >= 0 && coord.Y >= 0 && coord.X < _columns && coord.Y < _rows;
+}
+
+int ChunkStreamer::GetDistance(Coord coord, Coord camera) const
+{
+	return std::max(std::abs(coord.X - camera.X), std::abs(coord.Y - camera.Y));
+}
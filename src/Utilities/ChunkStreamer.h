@@ -0,0 +1,107 @@
+#pragma once
+#include <GLM/glm.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "Utilities/PropPlacement.h"
+
+//Splits the spawn areas into square chunks and works out their props on a background thread as the camera gets near
+//*A chunk's props only depend on the seed and its coordinate (each one keeps its spaced props inside its own edges),
+//*so a chunk that gets dropped and made again comes back exactly the same
+//*Only chunks near the camera are ever loaded, so memory stays the same however big the world is
+class ChunkStreamer
+{
+public:
+	struct Coord
+	{
+		int X;
+		int Y;
+	};
+
+	//A chunk that's finished, Placements has a list for each object
+	struct Chunk
+	{
+		Coord Position;
+		std::vector<std::vector<PropPlacement::Placement>> Placements;
+	};
+
+	ChunkStreamer();
+	~ChunkStreamer();
+
+	ChunkStreamer(const ChunkStreamer&) = delete;
+	ChunkStreamer& operator=(const ChunkStreamer&) = delete;
+
+	//Starts the thread, each object's count is spread over its whole spawn area
+	void Start(const std::vector<PropPlacement::Object>& objects, uint64_t seed, float chunkSize);
+	//Stops the thread and forgets every chunk (the caller has to get rid of whatever it spawned)
+	void Stop();
+	bool IsRunning() const;
+
+	//Works out which chunks should be around the camera and asks for the ones that aren't there yet
+	//*unload gets the loaded chunks that are now out of range, ready gets chunks that are done (at most MaxReadyPerUpdate)
+	void Update(glm::vec2 camera, std::vector<Coord>& unload, std::vector<Chunk>& ready);
+
+	//Chunks from the camera's chunk out to each side that get loaded
+	int LoadRadius = 2;
+	//Loaded chunks stay until they're this many chunks further out, so going back and forth doesn't keep remaking them
+	int UnloadMargin = 1;
+	//Chunks handed over per update, so a burst of them doesn't all land on one frame
+	int MaxReadyPerUpdate = 2;
+
+	float GetChunkSize() const;
+	size_t GetLoadedCount() const;
+	//Asked for but not loaded yet
+	size_t GetPendingCount();
+	//Chunks made since Start
+	uint64_t GetGeneratedCount() const;
+	//How long the thread took on the last chunk, in milliseconds
+	float GetLastGenerateTime() const;
+	//Most chunks that can be loaded at once
+	size_t GetMaxLoaded() const;
+
+	static uint64_t GetKey(Coord coord);
+
+private:
+	void WorkerLoop();
+	//Works out one chunk's props, only called from the thread
+	void Generate(Coord coord, Chunk& chunk);
+	bool IsInGrid(Coord coord) const;
+	//How many chunks away from the camera's chunk, counting the further axis
+	int GetDistance(Coord coord, Coord camera) const;
+
+	std::vector<PropPlacement::Object> _objects;
+	//Each object's space once its avoid boxes are taken out, for sharing its count between chunks
+	std::vector<double> _areas;
+	uint64_t _seed = 0;
+	float _chunkSize = 1.0f;
+	glm::vec2 _min = glm::vec2(0.0f);
+	glm::vec2 _max = glm::vec2(0.0f);
+	int _columns = 0;
+	int _rows = 0;
+
+	//Main thread only
+	std::unordered_set<uint64_t> _loaded;
+	//Done, but waiting their turn to be handed over
+	std::deque<Chunk> _waiting;
+
+	std::thread _worker;
+	std::mutex _mutex;
+	std::condition_variable _wake;
+	bool _running = false;
+	//Nearest first, the main thread replaces it every update
+	std::deque<Coord> _requests;
+	bool _working = false;
+	Coord _workingOn = { 0, 0 };
+	std::vector<Chunk> _finished;
+	std::atomic<uint64_t> _generated;
+	std::atomic<float> _lastGenerateTime;
+
+	//Only touched by the thread
+	PoissonDisk _disk;
+};
@@ -0,0 +1,592 @@
+#include "CpuBenchmarks.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <thread>
+#include <string>
+#include <vector>
+
+#include <MeshBuilder.h>
+#include <MeshFactory.h>
+#include <ObjLoader.h>
+#include <Transform.h>
+#include <VertexTypes.h>
+
+#include "Utilities/MicroBenchmark.h"
+#include "Utilities/Util.h"
+#include "Utilities/PoissonDisk.h"
+#include "Utilities/PropPlacement.h"
+#include "Utilities/EnvironmentGenerator.h"
+#include "Utilities/Noise.h"
+#include "Graphics/LUT.h"
+#include "Graphics/MeshData.h"
+#include "Graphics/StaticBatch.h"
+#include "Graphics/MeshSimplifier.h"
+#include "Graphics/MeshOptimizer.h"
+#include "Graphics/ObjParser.h"
+
+namespace
+{
+	//Avoid ranges that each cut a small slice out of [0, 100]
+	template <typename T>
+	void MakeAvoidRanges(int count, std::vector<T>& avoidFrom, std::vector<T>& avoidTo)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			float start = 100.0f * i / count;
+			avoidFrom.push_back(T(start));
+			avoidTo.push_back(T(start + 5.0f / count));
+		}
+	}
+
+	void RandomInt(MicroBenchmark::State& state)
+	{
+		std::vector<int> avoidFrom, avoidTo;
+		for (int i = 0; i < state.Range(); i++)
+		{
+			avoidFrom.push_back(i * 1000 / int(state.Range()));
+			avoidTo.push_back(avoidFrom.back());
+		}
+		while (state.KeepRunning())
+			MicroBenchmark::DoNotOptimize(Util::GetRandomNumberBetween(0, 1000, avoidFrom, avoidTo));
+		state.SetItemsProcessed(state.Iterations());
+	}
+
+	void RandomFloat(MicroBenchmark::State& state)
+	{
+		std::vector<float> avoidFrom, avoidTo;
+		MakeAvoidRanges(int(state.Range()), avoidFrom, avoidTo);
+		while (state.KeepRunning())
+			MicroBenchmark::DoNotOptimize(Util::GetRandomNumberBetween(0.0f, 100.0f, avoidFrom, avoidTo));
+		state.SetItemsProcessed(state.Iterations());
+	}
+
+	void RandomVec2(MicroBenchmark::State& state)
+	{
+		std::vector<glm::vec2> avoidFrom, avoidTo;
+		MakeAvoidRanges(int(state.Range()), avoidFrom, avoidTo);
+		while (state.KeepRunning())
+			MicroBenchmark::DoNotOptimize(Util::GetRandomNumberBetween(glm::vec2(0.0f), glm::vec2(100.0f), avoidFrom, avoidTo));
+		state.SetItemsProcessed(state.Iterations());
+	}
+
+	void RandomVec3(MicroBenchmark::State& state)
+	{
+		std::vector<glm::vec3> avoidFrom, avoidTo;
+		MakeAvoidRanges(int(state.Range()), avoidFrom, avoidTo);
+		while (state.KeepRunning())
+			MicroBenchmark::DoNotOptimize(Util::GetRandomNumberBetween(glm::vec3(0.0f), glm::vec3(100.0f), avoidFrom, avoidTo));
+		state.SetItemsProcessed(state.Iterations());
+	}
+
+	void RandomVec4(MicroBenchmark::State& state)
+	{
+		std::vector<glm::vec4> avoidFrom, avoidTo;
+		MakeAvoidRanges(int(state.Range()), avoidFrom, avoidTo);
+		while (state.KeepRunning())
+			MicroBenchmark::DoNotOptimize(Util::GetRandomNumberBetween(glm::vec4(0.0f), glm::vec4(100.0f), avoidFrom, avoidTo));
+		state.SetItemsProcessed(state.Iterations());
+	}
+
+	//The generator on its own, what every other sample is built on
+	void RandomNext(MicroBenchmark::State& state)
+	{
+		Util::Random random(1);
+		while (state.KeepRunning())
+			MicroBenchmark::DoNotOptimize(random.Next());
+		state.SetItemsProcessed(state.Iterations());
+	}
+
+	//Avoid boxes over 95% of the area, which used to mean about 20 retries a sample
+	void RandomVec2Covered(MicroBenchmark::State& state)
+	{
+		std::vector<glm::vec2> avoidFrom, avoidTo;
+		for (int i = 0; i < state.Range(); i++)
+		{
+			float width = 100.0f / state.Range();
+			avoidFrom.push_back(glm::vec2(width * i, 0.0f));
+			avoidTo.push_back(glm::vec2(width * (i + 0.95f), 100.0f));
+		}
+		while (state.KeepRunning())
+			MicroBenchmark::DoNotOptimize(Util::GetRandomNumberBetween(glm::vec2(0.0f), glm::vec2(100.0f), avoidFrom, avoidTo));
+		state.SetItemsProcessed(state.Iterations());
+	}
+
+	//Range() samples at a time, with the 16 avoid boxes the environment generator might have
+	void FillFloat(MicroBenchmark::State& state)
+	{
+		std::vector<float> avoidFrom, avoidTo;
+		MakeAvoidRanges(16, avoidFrom, avoidTo);
+		std::vector<float> out(size_t(state.Range()));
+		while (state.KeepRunning())
+		{
+			Util::FillRandomNumbersBetween(out, 0.0f, 100.0f, avoidFrom, avoidTo);
+			MicroBenchmark::DoNotOptimize(out.data());
+		}
+		state.SetItemsProcessed(state.Iterations() * state.Range());
+	}
+
+	void FillVec2(MicroBenchmark::State& state)
+	{
+		std::vector<glm::vec2> avoidFrom, avoidTo;
+		MakeAvoidRanges(16, avoidFrom, avoidTo);
+		std::vector<glm::vec2> out(size_t(state.Range()));
+		while (state.KeepRunning())
+		{
+			Util::FillRandomNumbersBetween(out, glm::vec2(0.0f), glm::vec2(100.0f), avoidFrom, avoidTo);
+			MicroBenchmark::DoNotOptimize(out.data());
+		}
+		state.SetItemsProcessed(state.Iterations() * state.Range());
+	}
+
+	//Range() props spaced out over the benchmark scenes' 100x100 area, like EnvironmentGenerator does it
+	void PoissonDiskPlace(MicroBenchmark::State& state)
+	{
+		std::vector<glm::vec2> avoidFrom = { glm::vec2(-6.0f) };
+		std::vector<glm::vec2> avoidTo = { glm::vec2(6.0f) };
+		float radius = 0.3f * sqrtf((100.0f * 100.0f - 12.0f * 12.0f) / state.Range());
+
+		PoissonDisk disk;
+		Util::Random random(1);
+		std::vector<glm::vec2> points;
+		while (state.KeepRunning())
+		{
+			disk.Reset(2.0f * radius, size_t(state.Range()));
+			points.clear();
+			if (disk.Generate(random, glm::vec2(-50.0f), glm::vec2(50.0f), radius, size_t(state.Range()), avoidFrom, avoidTo, points) < size_t(state.Range()))
+				state.SkipWithError("Not everything fit");
+			MicroBenchmark::DoNotOptimize(points.data());
+		}
+		state.SetItemsProcessed(state.Iterations() * state.Range());
+	}
+
+	//The benchmark scenes' 100k props over Range() threads, the layout is the same for each
+	void PlaceProps(MicroBenchmark::State& state)
+	{
+		const int props = 100000;
+		float spacing = 0.3f * sqrtf((100.0f * 100.0f - 12.0f * 12.0f) / props);
+		const float radii[] = { spacing * 1.2f, spacing, spacing * 0.6f };
+		std::vector<PropPlacement::Object> objects(3);
+		for (int i = 0; i < 3; i++)
+		{
+			objects[i].SpawnFrom = glm::vec2(-50.0f);
+			objects[i].SpawnTo = glm::vec2(50.0f);
+			objects[i].AvoidFrom = { glm::vec2(-6.0f) };
+			objects[i].AvoidTo = { glm::vec2(6.0f) };
+			objects[i].Radius = radii[i];
+			objects[i].Count = i < 2 ? props / 3 : props - (props / 3) * 2;
+		}
+
+		WorkerPool pool(int(state.Range()));
+		std::vector<std::vector<PropPlacement::Placement>> placements;
+		while (state.KeepRunning())
+		{
+			PropPlacement::PlaceAll(objects, 1, pool, placements);
+			MicroBenchmark::DoNotOptimize(placements.data());
+		}
+		state.SetItemsProcessed(state.Iterations() * props);
+	}
+
+	//Cleans up and respawns Range() rocks in a scene of their own, the same work as switching benchmark scenes
+	//*Needs a context for the rock's mesh
+	void RegenerateEnvironment(MicroBenchmark::State& state)
+	{
+		GameScene::sptr scene = GameScene::Create("microbenchmark");
+		Application::Instance().ActiveScene = scene;
+		EnvironmentGenerator::AddObjectToGeneration("models/simpleRock.obj", ShaderMaterial::Create(), int(state.Range()),
+			glm::vec2(-50.0f), glm::vec2(50.0f), {}, {});
+
+		while (state.KeepRunning())
+			EnvironmentGenerator::RegenerateEnvironment();
+		state.SetItemsProcessed(state.Iterations() * state.Range());
+
+		EnvironmentGenerator::CleanEnvironment();
+		EnvironmentGenerator::RemoveObjectFromGeneration("models/simpleRock.obj");
+		Application::Instance().ActiveScene = nullptr;
+	}
+
+	//Looks for the last element, so it walks the whole list
+	void FindInVectorInt(MicroBenchmark::State& state)
+	{
+		std::vector<int> values;
+		for (int i = 0; i < state.Range(); i++)
+			values.push_back(i);
+		int last = values.back();
+		while (state.KeepRunning())
+			MicroBenchmark::DoNotOptimize(Util::FindInVector(last, values));
+		state.SetItemsProcessed(state.Iterations() * state.Range());
+	}
+
+	//Same as EnvironmentGenerator uses it, looking up object file names
+	void FindInVectorString(MicroBenchmark::State& state)
+	{
+		std::vector<std::string> values;
+		for (int i = 0; i < state.Range(); i++)
+			values.push_back("models/generated_object_" + std::to_string(i) + ".obj");
+		std::string last = values.back();
+		while (state.KeepRunning())
+			MicroBenchmark::DoNotOptimize(Util::FindInVector(last, values));
+		state.SetItemsProcessed(state.Iterations() * state.Range());
+	}
+
+	//Parses a generated .cube file of Range() cells per side from memory
+	void ParseLUT(MicroBenchmark::State& state)
+	{
+		int size = int(state.Range());
+		std::string text = "TITLE \"Benchmark\"\nLUT_3D_SIZE " + std::to_string(size) + "\n";
+		char line[64];
+		for (int b = 0; b < size; b++)
+			for (int g = 0; g < size; g++)
+				for (int r = 0; r < size; r++)
+				{
+					snprintf(line, sizeof(line), "%.6f %.6f %.6f\n", r / float(size - 1), g / float(size - 1), b / float(size - 1));
+					text += line;
+				}
+
+		std::vector<glm::vec3> table;
+		int parsedSize = 0;
+		while (state.KeepRunning())
+		{
+			std::istringstream stream(text);
+			if (!LUT3D::parse(stream, table, parsedSize))
+				state.SkipWithError("LUT did not parse");
+			MicroBenchmark::DoNotOptimize(table.data());
+		}
+		state.SetBytesProcessed(state.Iterations() * int64_t(text.size()));
+	}
+
+	//Reads components floats of one attribute of every vertex in a VAO back from the GPU
+	//*False if the attribute isn't there or isn't floats
+	bool ReadAttribute(const VertexArrayObject::sptr& vao, GLuint slot, int components, std::vector<float>& values)
+	{
+		GLint enabled = 0, buffer = 0, size = 0, type = 0, stride = 0;
+		void* offset = nullptr;
+		glBindVertexArray(vao->GetHandle());
+		glGetVertexAttribiv(slot, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
+		glGetVertexAttribiv(slot, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &buffer);
+		glGetVertexAttribiv(slot, GL_VERTEX_ATTRIB_ARRAY_SIZE, &size);
+		glGetVertexAttribiv(slot, GL_VERTEX_ATTRIB_ARRAY_TYPE, &type);
+		glGetVertexAttribiv(slot, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &stride);
+		glGetVertexAttribPointerv(slot, GL_VERTEX_ATTRIB_ARRAY_POINTER, &offset);
+		glBindVertexArray(GL_NONE);
+		if (!enabled || buffer == 0 || type != GL_FLOAT || size < components)
+			return false;
+		if (stride == 0)
+			stride = size * sizeof(float);
+
+		//The copy read target so nothing else's bindings get touched
+		GLint bytes = 0;
+		glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+		glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &bytes);
+		std::vector<uint8_t> data(size_t(std::max(bytes, 0)));
+		glGetBufferSubData(GL_COPY_READ_BUFFER, 0, bytes, data.data());
+		glBindBuffer(GL_COPY_READ_BUFFER, GL_NONE);
+
+		size_t start = size_t(offset);
+		size_t count = size_t(std::max(vao->GetVertexCount(), 0));
+		values.resize(count * components);
+		for (size_t i = 0; i < count; i++)
+		{
+			size_t at = start + i * stride;
+			if (at + components * sizeof(float) > data.size())
+				return false;
+			memcpy(&values[i * components], &data[at], components * sizeof(float));
+		}
+		return true;
+	}
+
+	//ObjLoader gives every face corner its own vertex, so MeshData::LoadObj's mesh is expanded the same way and compared
+	//*to what ObjLoader uploaded (the slots are the ones in VertexPosNormTexCol::V_DECL)
+	bool MatchesObjLoader(const char* file, const VertexArrayObject::sptr& vao, std::string& difference)
+	{
+		MeshData mesh;
+		if (!MeshData::LoadObj(file, mesh))
+		{
+			difference = "MeshData::LoadObj could not read it";
+			return false;
+		}
+		if (vao->GetVertexCount() != int(mesh.Indices.size()))
+		{
+			difference = "ObjLoader has " + std::to_string(vao->GetVertexCount()) + " vertices, expected " + std::to_string(mesh.Indices.size()) + " corners";
+			return false;
+		}
+
+		struct Attribute
+		{
+			const char* Name;
+			GLuint Slot;
+			int Components;
+			size_t Offset;
+		};
+		const Attribute attributes[] = {
+			{ "position", 0, 3, offsetof(VertexPosNormTexCol, Position) },
+			{ "normal", 2, 3, offsetof(VertexPosNormTexCol, Normal) },
+			{ "uv", 3, 2, offsetof(VertexPosNormTexCol, UV) }
+		};
+		std::vector<float> values;
+		for (const Attribute& attribute : attributes)
+		{
+			if (!ReadAttribute(vao, attribute.Slot, attribute.Components, values))
+			{
+				difference = std::string("could not read back the ") + attribute.Name + "s";
+				return false;
+			}
+			for (size_t i = 0; i < mesh.Indices.size(); i++)
+			{
+				const uint8_t* expected = reinterpret_cast<const uint8_t*>(&mesh.Vertices[mesh.Indices[i]]) + attribute.Offset;
+				if (memcmp(&values[i * attribute.Components], expected, attribute.Components * sizeof(float)) != 0)
+				{
+					difference = std::string(attribute.Name) + " of corner " + std::to_string(i) + " differs";
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	//ObjLoader uploads the mesh as it loads, so this needs a context
+	void LoadObj(MicroBenchmark::State& state)
+	{
+		const char* files[] = { "models/simpleRock.obj", "models/LegoCharacter.obj", "models/LegoTable.obj" };
+		const char* file = files[state.Range()];
+		std::string difference;
+		if (!MatchesObjLoader(file, ObjLoader::LoadFromFile(file), difference))
+		{
+			state.SkipWithError("ObjLoader and MeshData::LoadObj differ: " + difference);
+			return;
+		}
+		while (state.KeepRunning())
+			MicroBenchmark::DoNotOptimize(ObjLoader::LoadFromFile(file));
+		state.SetItemsProcessed(state.Iterations());
+	}
+
+	//Same files, but only reading them into a MeshData (no context needed)
+	void LoadMeshData(MicroBenchmark::State& state)
+	{
+		const char* files[] = { "models/simpleRock.obj", "models/LegoCharacter.obj", "models/LegoTable.obj" };
+		const char* file = files[state.Range()];
+		MeshData mesh;
+		while (state.KeepRunning())
+		{
+			MeshData::LoadObj(file, mesh);
+			MicroBenchmark::DoNotOptimize(mesh.Vertices.size());
+		}
+		state.SetItemsProcessed(state.Iterations());
+	}
+
+	//Reads the biggest model we have on Range() threads, in MB/s so it can be compared to the single threaded reader
+	void ParseObj(MicroBenchmark::State& state)
+	{
+		const char* file = "models/LegoFloor.obj";
+		WorkerPool pool(int(state.Range()));
+		MeshData mesh, reference;
+		std::string difference;
+		if (!ObjParser::Load(file, mesh, pool) || !MeshData::LoadObj(file, reference) || !ObjParser::Matches(mesh, reference, difference))
+		{
+			state.SkipWithError("ObjParser and MeshData::LoadObj differ: " + difference);
+			return;
+		}
+		while (state.KeepRunning())
+		{
+			ObjParser::Load(file, mesh, pool);
+			MicroBenchmark::DoNotOptimize(mesh.Vertices.size());
+		}
+		state.SetBytesProcessed(state.Iterations() * int64_t(std::filesystem::file_size(file)));
+	}
+
+	void ParseObjSingleThreaded(MicroBenchmark::State& state)
+	{
+		const char* file = "models/LegoFloor.obj";
+		MeshData mesh;
+		while (state.KeepRunning())
+		{
+			MeshData::LoadObj(file, mesh);
+			MicroBenchmark::DoNotOptimize(mesh.Vertices.size());
+		}
+		state.SetBytesProcessed(state.Iterations() * int64_t(std::filesystem::file_size(file)));
+	}
+
+	//Halves the triangles of the same files, what building each level of detail costs
+	void SimplifyMesh(MicroBenchmark::State& state)
+	{
+		const char* files[] = { "models/simpleRock.obj", "models/LegoCharacter.obj", "models/LegoTable.obj" };
+		MeshData mesh, simplified;
+		MeshData::LoadObj(files[state.Range()], mesh);
+		float error;
+		while (state.KeepRunning())
+		{
+			MeshSimplifier::Simplify(mesh, mesh.GetTriangleCount() / 2, simplified, error);
+			MicroBenchmark::DoNotOptimize(simplified.Indices.size());
+		}
+		state.SetItemsProcessed(state.Iterations() * mesh.GetTriangleCount());
+	}
+
+	//Welds and reorders the same files, what optimizing costs on top of loading
+	void OptimizeMesh(MicroBenchmark::State& state)
+	{
+		const char* files[] = { "models/simpleRock.obj", "models/LegoCharacter.obj", "models/LegoTable.obj" };
+		MeshData mesh, optimized;
+		MeshData::LoadObj(files[state.Range()], mesh);
+		while (state.KeepRunning())
+		{
+			optimized = mesh;
+			MeshOptimizer::Optimize(optimized);
+			MicroBenchmark::DoNotOptimize(optimized.Vertices.size());
+		}
+		state.SetItemsProcessed(state.Iterations() * mesh.GetTriangleCount());
+	}
+
+	//Merges Range() rocks spread over 100x100 into 32 unit cells, the CPU side of baking the benchmark props
+	void AddToStaticBatch(MicroBenchmark::State& state)
+	{
+		MeshData rock;
+		MeshData::LoadObj("models/simpleRock.obj", rock);
+		ShaderMaterial::sptr material = ShaderMaterial::Create();
+
+		std::vector<glm::mat4> models(size_t(state.Range()));
+		Util::Random random(1);
+		for (glm::mat4& model : models)
+		{
+			Transform transform;
+			transform.SetLocalPosition(random.Range(-50.0f, 50.0f), random.Range(-50.0f, 50.0f), 0.0f);
+			transform.SetLocalRotation(0.0f, 0.0f, random.Range(0.0f, 360.0f));
+			model = transform.LocalTransform();
+		}
+
+		while (state.KeepRunning())
+		{
+			StaticBatch batch(32.0f);
+			for (const glm::mat4& model : models)
+				batch.Add(rock, material, model);
+			MicroBenchmark::DoNotOptimize(batch.GetTriangleCount());
+		}
+		state.SetItemsProcessed(state.Iterations() * state.Range());
+	}
+
+	//A row of Range() terrain heights, 4 at a time or one at a time
+	void FbmRow(MicroBenchmark::State& state)
+	{
+		std::vector<float> out(size_t(state.Range()));
+		Noise::FbmSettings settings;
+		float y = 0.0f;
+		while (state.KeepRunning())
+		{
+			Noise::FbmRow(-64.0f, y, 0.5f, int(out.size()), settings, out.data());
+			MicroBenchmark::DoNotOptimize(out.data());
+			y += 0.5f;
+		}
+		state.SetItemsProcessed(state.Iterations() * state.Range());
+	}
+
+	void FbmRowScalar(MicroBenchmark::State& state)
+	{
+		std::vector<float> out(size_t(state.Range()));
+		Noise::FbmSettings settings;
+		float y = 0.0f;
+		while (state.KeepRunning())
+		{
+			Noise::FbmRowScalar(-64.0f, y, 0.5f, int(out.size()), settings, out.data());
+			MicroBenchmark::DoNotOptimize(out.data());
+			y += 0.5f;
+		}
+		state.SetItemsProcessed(state.Iterations() * state.Range());
+	}
+
+	//Just the CPU side of building an ico sphere with Range() subdivisions
+	void BuildIcoSphere(MicroBenchmark::State& state)
+	{
+		while (state.KeepRunning())
+		{
+			MeshBuilder<VertexPosNormTexCol> mesh;
+			MeshFactory::AddIcoSphere(mesh, glm::vec3(0.0f), 1.0f, int(state.Range()));
+			MicroBenchmark::DoNotOptimize(mesh.GetVertexCount());
+		}
+		state.SetItemsProcessed(state.Iterations());
+	}
+
+	//Building plus uploading it (what the skybox does)
+	void BakeIcoSphere(MicroBenchmark::State& state)
+	{
+		while (state.KeepRunning())
+		{
+			MeshBuilder<VertexPosNormTexCol> mesh;
+			MeshFactory::AddIcoSphere(mesh, glm::vec3(0.0f), 1.0f, int(state.Range()));
+			MicroBenchmark::DoNotOptimize(mesh.Bake());
+		}
+		state.SetItemsProcessed(state.Iterations());
+	}
+
+	//Moves Range() transforms and rebuilds their world matrices, like a frame of the render loop does
+	void UpdateTransforms(MicroBenchmark::State& state)
+	{
+		std::vector<Transform> transforms(size_t(state.Range()));
+		for (size_t i = 0; i < transforms.size(); i++)
+		{
+			transforms[i].SetLocalPosition(float(i % 100), float(i / 100), 0.0f);
+			transforms[i].SetLocalRotation(0.0f, 0.0f, float(i % 360));
+		}
+
+		float offset = 0.0f;
+		while (state.KeepRunning())
+		{
+			offset += 0.01f;
+			for (Transform& transform : transforms)
+			{
+				transform.SetLocalPosition(transform.GetLocalPosition() + glm::vec3(offset, 0.0f, 0.0f));
+				transform.UpdateWorldMatrix();
+			}
+			MicroBenchmark::DoNotOptimize(transforms.back().WorldTransform());
+		}
+		state.SetItemsProcessed(state.Iterations() * state.Range());
+	}
+}
+
+void CpuBenchmarks::RegisterAll()
+{
+	std::vector<int64_t> avoidCounts = { 0, 1, 4, 16 };
+	MicroBenchmark::Register("Util_RandomInt", RandomInt, avoidCounts);
+	MicroBenchmark::Register("Util_RandomFloat", RandomFloat, avoidCounts);
+	MicroBenchmark::Register("Util_RandomVec2", RandomVec2, avoidCounts);
+	MicroBenchmark::Register("Util_RandomVec3", RandomVec3, avoidCounts);
+	MicroBenchmark::Register("Util_RandomVec4", RandomVec4, avoidCounts);
+	MicroBenchmark::Register("Util_RandomNext", RandomNext, { 0 });
+	MicroBenchmark::Register("Util_RandomVec2Covered", RandomVec2Covered, { 1, 4, 16 });
+	MicroBenchmark::Register("Util_FillFloat", FillFloat, MicroBenchmark::Range(64, 65536));
+	MicroBenchmark::Register("Util_FillVec2", FillVec2, MicroBenchmark::Range(64, 65536));
+
+	MicroBenchmark::Register("PoissonDisk_Generate", PoissonDiskPlace, MicroBenchmark::Range(1000, 131072));
+
+	//1 thread up to one per core
+	std::vector<int64_t> threadCounts;
+	int cores = std::max(1, int(std::thread::hardware_concurrency()));
+	for (int threads = 1; threads < cores; threads *= 2)
+		threadCounts.push_back(threads);
+	threadCounts.push_back(cores);
+	MicroBenchmark::Register("PropPlacement_PlaceAll", PlaceProps, threadCounts);
+	MicroBenchmark::Register("EnvironmentGenerator_Regenerate", RegenerateEnvironment, { 10000, 100000 }, true);
+
+	MicroBenchmark::Register("Util_FindInVectorInt", FindInVectorInt, MicroBenchmark::Range(8, 4096));
+	MicroBenchmark::Register("Util_FindInVectorString", FindInVectorString, MicroBenchmark::Range(8, 4096));
+
+	MicroBenchmark::Register("LUT3D_Parse", ParseLUT, { 17, 33, 64 });
+
+	//0 is a small prop, 2 is the biggest model we load
+	MicroBenchmark::Register("ObjLoader_LoadFromFile", LoadObj, { 0, 1, 2 }, true);
+	MicroBenchmark::Register("MeshData_LoadObj", LoadMeshData, { 0, 1, 2 });
+	MicroBenchmark::Register("ObjParser_Load", ParseObj, threadCounts);
+	MicroBenchmark::Register("ObjParser_LoadSingleThreaded", ParseObjSingleThreaded, { 0 });
+	MicroBenchmark::Register("StaticBatch_Add", AddToStaticBatch, { 1000, 10000, 100000 });
+	MicroBenchmark::Register("MeshSimplifier_Simplify", SimplifyMesh, { 0, 1, 2 });
+	MicroBenchmark::Register("MeshOptimizer_Optimize", OptimizeMesh, { 0, 1, 2 });
+
+	MicroBenchmark::Register("Noise_FbmRow", FbmRow, { 129, 1025 });
+	MicroBenchmark::Register("Noise_FbmRowScalar", FbmRowScalar, { 129, 1025 });
+
+	MicroBenchmark::Register("MeshFactory_AddIcoSphere", BuildIcoSphere, { 0, 1, 2, 3, 4 });
+	MicroBenchmark::Register("MeshFactory_AddIcoSphereBake", BakeIcoSphere, { 0, 1, 2, 3, 4 }, true);
+
+	MicroBenchmark::Register("Transform_UpdateWorldMatrix", UpdateTransforms, MicroBenchmark::Range(64, 65536));
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+//Microbenchmarks for the CPU side hot paths (random placement, lookups, LUT and OBJ parsing, mesh building, transforms)
+class CpuBenchmarks abstract
+{
+public:
+	//Adds all of them to MicroBenchmark
+	static void RegisterAll();
+};
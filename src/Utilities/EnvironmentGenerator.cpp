@@ -1,7 +1,15 @@
 #include "EnvironmentGenerator.h"
 
-//The gameobject references to the spawned objects
-std::vector<std::vector<GameObject>> EnvironmentGenerator::_objectsSpawned;
+#include <chrono>
+#include <GameObjectTag.h>
+#include "imgui.h"
+#include "Graphics/MeshOptimizer.h"
+#include "Graphics/ObjParser.h"
+
+//The entities spawned for each object
+std::vector<std::vector<entt::entity>> EnvironmentGenerator::_objectsSpawned;
+EnvironmentGenerator::Timings EnvironmentGenerator::_timings;
+bool EnvironmentGenerator::UniqueNames = false;
 
 //Object information for being spawned
 std::vector<VertexArrayObject::sptr> EnvironmentGenerator::_vaosToSpawn;
@@ -12,6 +20,24 @@ std::vector<glm::vec2> EnvironmentGenerator::_spawnFromAll;
 std::vector<glm::vec2> EnvironmentGenerator::_spawnToAll;
 std::vector<std::vector<glm::vec2>> EnvironmentGenerator::_avoidFromAll;
 std::vector<std::vector<glm::vec2>> EnvironmentGenerator::_avoidToAll;
+std::vector<float> EnvironmentGenerator::_radiusAll;
+
+std::unique_ptr<WorkerPool> EnvironmentGenerator::_workers;
+std::unique_ptr<ChunkStreamer> EnvironmentGenerator::_streamer;
+std::unordered_map<uint64_t, std::vector<std::vector<entt::entity>>> EnvironmentGenerator::_streamedChunks;
+size_t EnvironmentGenerator::_numStreamed = 0;
+int EnvironmentGenerator::WorkerThreads = 0;
+
+bool EnvironmentGenerator::UseLods = true;
+bool EnvironmentGenerator::UseImpostors = true;
+bool EnvironmentGenerator::BakeStaticProps = false;
+bool EnvironmentGenerator::InstanceStaticProps = false;
+float EnvironmentGenerator::StaticCellSize = 32.0f;
+std::vector<entt::entity> EnvironmentGenerator::_staticBatches;
+size_t EnvironmentGenerator::_numBaked = 0;
+std::unordered_map<ShaderMaterial*, ShaderMaterial::sptr> EnvironmentGenerator::_instancedMaterials;
+std::unordered_map<std::string, MeshData> EnvironmentGenerator::_meshData;
+Terrain::sptr EnvironmentGenerator::_terrain = nullptr;
 
 //The filenames of the objects to spawn
 std::vector<std::string> EnvironmentGenerator::_objectsToSpawn;
@@ -28,49 +54,302 @@ void EnvironmentGenerator::RegenerateEnvironment()
 	GenerateEnvironment();
 }
 
+namespace
+{
+	double MillisecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
 void EnvironmentGenerator::GenerateEnvironment()
 {
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<PropPlacement::Object> objects;
+	GetObjects(objects);
+
+	//The layout only depends on this seed (taken from the main thread's generator, so --seed repeats it), not the thread count
+	std::vector<std::vector<PropPlacement::Placement>> placements;
+	PropPlacement::PlaceAll(objects, Util::GetRandom().Next(), GetWorkers(), placements);
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		if (placements[i].size() < size_t(std::max(_numToSpawn[i], 0)))
+			printf("Only had room for %zu of %d %s\n", placements[i].size(), _numToSpawn[i], _objectsToSpawn[i].c_str());
+	}
+
+	_timings.Place = MillisecondsSince(start);
+	start = std::chrono::steady_clock::now();
+
+	std::vector<std::vector<entt::entity>> entities;
+	Spawn(placements, entities);
+	//Add object to the spawned list
+	for (std::vector<entt::entity>& objectEntities : entities)
+		_objectsSpawned.push_back(std::move(objectEntities));
+
+	_timings.Spawn = MillisecondsSince(start);
+
+	_timings.Bake = 0.0;
+	if (BakeStaticProps || InstanceStaticProps)
+		BakeStatic(StaticCellSize, !BakeStaticProps);
+}
+
+void EnvironmentGenerator::BakeStatic(float cellSize, bool instanced)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	entt::registry& registry = Application::Instance().ActiveScene->Registry();
+	StaticBatch batch(cellSize);
+	InstanceBatch instances(cellSize);
+	for (std::vector<entt::entity>& entities : _objectsSpawned)
+	{
+		if (entities.empty())
+			continue;
+
+		//Every entity in a list is the same object, so its mesh says which one
+		//*(its full mesh, it may have turned into an impostor and not have one right now)
+		const RendererComponent& renderer = registry.get<RendererComponent>(entities[0]);
+		const LodGroup* lod = registry.try_get<LodGroup>(entities[0]);
+		int index = FindObject(lod != nullptr && lod->Chain != nullptr ? lod->Chain->Levels[0].Mesh : renderer.Mesh);
+		if (index == -1)
+			continue;
+		const MeshData& mesh = GetMeshData(_objectsToSpawn[index]);
+
+		if (instanced)
+		{
+			auto material = _instancedMaterials.find(renderer.Material.get());
+			if (material == _instancedMaterials.end())
+				continue;
+			for (entt::entity entity : entities)
+				instances.Add(mesh, material->second, registry.get<Transform>(entity).LocalTransform());
+		}
+		else
+		{
+			for (entt::entity entity : entities)
+				batch.Add(mesh, renderer.Material, registry.get<Transform>(entity).LocalTransform());
+		}
+		_numBaked += entities.size();
+		registry.destroy(entities.begin(), entities.end());
+		entities.clear();
+	}
+	batch.Build(registry, _staticBatches);
+	instances.Build(registry, _staticBatches);
+
+	_timings.Bake = MillisecondsSince(start);
+}
+
+void EnvironmentGenerator::SetInstancedMaterial(const ShaderMaterial::sptr& material, const ShaderMaterial::sptr& instanced)
+{
+	_instancedMaterials[material.get()] = instanced;
+}
+
+int EnvironmentGenerator::FindObject(const VertexArrayObject::sptr& mesh)
+{
+	int index = Util::FindInVector(mesh, _vaosToSpawn);
+	if (index != -1 || !UseLods)
+		return index;
+
+	//It might be drawing one of its levels of detail instead
 	for (int i = 0; i < _objectsToSpawn.size(); i++)
 	{
-		std::vector<GameObject> temp;
+		for (const LodChain::Level& level : LodChain::LoadFromFile(_objectsToSpawn[i])->Levels)
 		{
-			//Load in this object vao
-			if (!_loadedIn[i])
-			{
-				VertexArrayObject::sptr vao = ObjLoader::LoadFromFile(_objectsToSpawn[i]);
-				_vaosToSpawn.push_back(vao);
-				_loadedIn[i] = true;
-			}
-
-			for (int j = 0; j < _numToSpawn[i]; j++)
-			{
-				temp.push_back(Application::Instance().ActiveScene->CreateEntity(_objectsToSpawn[i] + (std::to_string(j + 1))));
-				temp[j].emplace<RendererComponent>().SetMesh(_vaosToSpawn[i]).SetMaterial(_materialsForSpawning[i]);
-				//Randomly places
-				temp[j].get<Transform>().SetLocalPosition(glm::vec3(Util::GetRandomNumberBetween(_spawnFromAll[i],
-					_spawnToAll[i], _avoidFromAll[i], _avoidToAll[i]), 0.0f));
-				temp[j].get<Transform>().SetLocalRotation(Util::GetRandomNumberBetween(glm::vec3(0.f, 0.f, 0.f), glm::vec3(0.f, 0.f, 360.0f)));
-			}
+			if (level.Mesh == mesh)
+				return i;
 		}
+	}
+	return -1;
+}
 
-		//Add object to the spawned list
-		_objectsSpawned.push_back(temp);
+const MeshData& EnvironmentGenerator::GetMeshData(const std::string& fileName)
+{
+	auto it = _meshData.find(fileName);
+	if (it == _meshData.end())
+	{
+		it = _meshData.emplace(fileName, MeshData()).first;
+		ObjParser::Load(fileName, it->second);
+		if (MeshOptimizer::Enabled)
+			MeshOptimizer::Optimize(it->second);
 	}
+	return it->second;
 }
 
-void EnvironmentGenerator::CleanEnvironment()
+void EnvironmentGenerator::GetObjects(std::vector<PropPlacement::Object>& objects)
 {
-	//Remove all the entities
-	for (int i = 0; i < _objectsSpawned.size(); i++)
+	objects.resize(_objectsToSpawn.size());
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		objects[i].SpawnFrom = _spawnFromAll[i];
+		objects[i].SpawnTo = _spawnToAll[i];
+		objects[i].AvoidFrom = _avoidFromAll[i];
+		objects[i].AvoidTo = _avoidToAll[i];
+		objects[i].Radius = _radiusAll[i];
+		objects[i].Count = _numToSpawn[i];
+	}
+}
+
+void EnvironmentGenerator::Spawn(const std::vector<std::vector<PropPlacement::Placement>>& placements, std::vector<std::vector<entt::entity>>& entities)
+{
+	//Make room for everything up front, so the pools only grow once
+	entt::registry& registry = Application::Instance().ActiveScene->Registry();
+	size_t total = 0;
+	for (const std::vector<PropPlacement::Placement>& objectPlacements : placements)
+		total += objectPlacements.size();
+	registry.reserve(registry.size() + total);
+	registry.reserve<Transform, RendererComponent, GameObjectTag>(registry.size() + total);
+
+	entities.resize(placements.size());
+	std::vector<Transform> transforms;
+	std::vector<GameObjectTag> tags;
+	for (int i = 0; i < placements.size(); i++)
 	{
-		for (int j = 0; j < _objectsSpawned[i].size(); j++)
+		//Load in this object vao
+		if (!_loadedIn[i])
 		{
-			Application::Instance().ActiveScene->RemoveEntity(_objectsSpawned[i][j]);
+			VertexArrayObject::sptr vao = GetMeshData(_objectsToSpawn[i]).Bake();
+			_vaosToSpawn.push_back(vao);
+			_loadedIn[i] = true;
+		}
+
+		//Create them all at once, then hand each pool its components in one go
+		entities[i].resize(placements[i].size());
+		registry.create(entities[i].begin(), entities[i].end());
+
+		transforms.assign(entities[i].size(), Transform());
+		for (size_t j = 0; j < transforms.size(); j++)
+		{
+			const PropPlacement::Placement& placement = placements[i][j];
+			float ground = _terrain != nullptr ? _terrain->GetHeight(placement.Position) : 0.0f;
+			transforms[j].SetLocalPosition(glm::vec3(placement.Position, ground));
+			transforms[j].SetLocalRotation(glm::vec3(0.0f, 0.0f, placement.Rotation));
+			transforms[j].SetLocalScale(glm::vec3(placement.Scale));
+		}
+		registry.insert<Transform>(entities[i].begin(), entities[i].end(), transforms.begin(), transforms.end());
+
+		RendererComponent renderer;
+		renderer.SetMesh(_vaosToSpawn[i]).SetMaterial(_materialsForSpawning[i]);
+		registry.insert<RendererComponent>(entities[i].begin(), entities[i].end(), renderer);
+
+		//A name is a heap allocation per prop (file names are too long to fit in the string), so by default they don't get one
+		if (UniqueNames)
+		{
+			tags.resize(entities[i].size());
+			for (size_t j = 0; j < tags.size(); j++)
+				tags[j].Name = _objectsToSpawn[i] + std::to_string(j + 1);
+			registry.insert<GameObjectTag>(entities[i].begin(), entities[i].end(), tags.begin(), tags.end());
+		}
+
+		if (UseLods)
+		{
+			LodGroup group;
+			group.Chain = LodChain::LoadFromFile(_objectsToSpawn[i]);
+			//Made once per chain, the first time something spawns with it
+			if (UseImpostors && group.Chain->Impostor == nullptr && !group.Chain->Levels.empty())
+				group.Chain->Impostor = ImpostorAtlas::Create(group.Chain->Levels[0].Mesh, GetMeshData(_objectsToSpawn[i]), _materialsForSpawning[i]);
+			registry.insert<LodGroup>(entities[i].begin(), entities[i].end(), group);
 		}
 	}
+}
+
+void EnvironmentGenerator::StartStreaming(float chunkSize, int loadRadius)
+{
+	StopStreaming();
+
+	std::vector<PropPlacement::Object> objects;
+	GetObjects(objects);
+	_streamer = std::make_unique<ChunkStreamer>();
+	_streamer->LoadRadius = loadRadius;
+	_streamer->Start(objects, Util::GetRandom().Next(), chunkSize);
+}
+
+void EnvironmentGenerator::StopStreaming()
+{
+	if (_streamer == nullptr)
+		return;
+	_streamer->Stop();
+	_streamer.reset();
+
+	entt::registry& registry = Application::Instance().ActiveScene->Registry();
+	for (auto& chunk : _streamedChunks)
+	{
+		for (std::vector<entt::entity>& entities : chunk.second)
+			registry.destroy(entities.begin(), entities.end());
+	}
+	_streamedChunks.clear();
+	_numStreamed = 0;
+}
+
+void EnvironmentGenerator::UpdateStreaming(const glm::vec3& camera)
+{
+	if (_streamer == nullptr)
+		return;
+
+	//The props are on the ground (z = 0), so only x and y decide what's in range
+	std::vector<ChunkStreamer::Coord> unload;
+	std::vector<ChunkStreamer::Chunk> ready;
+	_streamer->Update(glm::vec2(camera.x, camera.y), unload, ready);
+
+	entt::registry& registry = Application::Instance().ActiveScene->Registry();
+	for (const ChunkStreamer::Coord& coord : unload)
+	{
+		auto it = _streamedChunks.find(ChunkStreamer::GetKey(coord));
+		if (it == _streamedChunks.end())
+			continue;
+		for (std::vector<entt::entity>& entities : it->second)
+		{
+			_numStreamed -= entities.size();
+			registry.destroy(entities.begin(), entities.end());
+		}
+		_streamedChunks.erase(it);
+	}
+
+	//Only adding them to the registry happens here, the placements were worked out on the streamer's thread
+	for (const ChunkStreamer::Chunk& chunk : ready)
+	{
+		std::vector<std::vector<entt::entity>>& entities = _streamedChunks[ChunkStreamer::GetKey(chunk.Position)];
+		Spawn(chunk.Placements, entities);
+		for (const std::vector<entt::entity>& objectEntities : entities)
+			_numStreamed += objectEntities.size();
+	}
+}
+
+bool EnvironmentGenerator::IsStreaming()
+{
+	return _streamer != nullptr;
+}
+
+void EnvironmentGenerator::RenderStreamingImGui()
+{
+	if (_streamer == nullptr || !ImGui::CollapsingHeader("World Streaming"))
+		return;
+
+	ImGui::SliderInt("Load Radius (chunks)", &_streamer->LoadRadius, 1, 8);
+	ImGui::SliderInt("Chunks Per Frame", &_streamer->MaxReadyPerUpdate, 1, 8);
+	ImGui::Text("Chunks: %zu loaded (at most %zu), %zu pending", _streamer->GetLoadedCount(), _streamer->GetMaxLoaded(), _streamer->GetPendingCount());
+	ImGui::Text("Props loaded: %zu", _numStreamed);
+	ImGui::Text("Chunks made: %llu, last took %.2f ms", (unsigned long long)_streamer->GetGeneratedCount(), _streamer->GetLastGenerateTime());
+}
+
+void EnvironmentGenerator::CleanEnvironment()
+{
+	auto start = std::chrono::steady_clock::now();
+
+	//Remove all the entities, a whole object at a time
+	entt::registry& registry = Application::Instance().ActiveScene->Registry();
+	for (int i = 0; i < _objectsSpawned.size(); i++)
+	{
+		registry.destroy(_objectsSpawned[i].begin(), _objectsSpawned[i].end());
+	}
 
 	//Clear out objects spawned
 	_objectsSpawned.clear();
+
+	//And anything they were baked into
+	registry.destroy(_staticBatches.begin(), _staticBatches.end());
+	_staticBatches.clear();
+	_numBaked = 0;
+
+	_timings.Clean = MillisecondsSince(start);
 }
 
 void EnvironmentGenerator::CleanUpPointers()
@@ -79,10 +358,33 @@ void EnvironmentGenerator::CleanUpPointers()
 	_vaosToSpawn.clear();
 	//Clear up material references so the smart pointers can clear
 	_materialsForSpawning.clear();
+	_instancedMaterials.clear();
+	_meshData.clear();
+	_terrain = nullptr;
+	//Stop the worker threads
+	StopStreaming();
+	_workers.reset();
+}
+
+void EnvironmentGenerator::CreateTerrain(const Terrain::Settings& settings)
+{
+	_terrain = Terrain::Create(settings, GetWorkers());
+}
+
+const Terrain::sptr& EnvironmentGenerator::GetTerrain()
+{
+	return _terrain;
+}
+
+WorkerPool& EnvironmentGenerator::GetWorkers()
+{
+	if (_workers == nullptr || (WorkerThreads > 0 && _workers->GetThreadCount() != WorkerThreads))
+		_workers = std::make_unique<WorkerPool>(WorkerThreads);
+	return *_workers;
 }
 
 void EnvironmentGenerator::AddObjectToGeneration(std::string fileName, ShaderMaterial::sptr objMat, int numToSpawn, glm::vec2 spawnFrom, 
-													glm::vec2 spawnTo, std::vector<glm::vec2> avoidFrom, std::vector<glm::vec2> avoidTo)
+													glm::vec2 spawnTo, std::vector<glm::vec2> avoidFrom, std::vector<glm::vec2> avoidTo, float radius)
 {
 	//Find the filename in the list
 	int index = Util::FindInVector(fileName, _objectsToSpawn);
@@ -94,8 +396,10 @@ void EnvironmentGenerator::AddObjectToGeneration(std::string fileName, ShaderMat
 	}
 
 	//Loads in the mesh and adds to list
-	VertexArrayObject::sptr vao = ObjLoader::LoadFromFile(fileName);
+	VertexArrayObject::sptr vao = GetMeshData(fileName).Bake();
 	_vaosToSpawn.push_back(vao);
+	//Sets it as loaded, so generation doesn't load it a second time
+	_loadedIn.push_back(true);
 	//Adds material to list
 	_materialsForSpawning.push_back(objMat);
 	//Adds number to spawn for this object
@@ -106,11 +410,10 @@ void EnvironmentGenerator::AddObjectToGeneration(std::string fileName, ShaderMat
 	_spawnToAll.push_back(spawnTo);
 	_avoidFromAll.push_back(avoidFrom);
 	_avoidToAll.push_back(avoidTo);
+	_radiusAll.push_back(radius);
 
 	//Adds the filename to the list
 	_objectsToSpawn.push_back(fileName);
-	//Sets it as not loaded
-	_loadedIn.push_back(false);
 }
 
 void EnvironmentGenerator::RemoveObjectFromGeneration(std::string fileName)
@@ -127,13 +430,55 @@ void EnvironmentGenerator::RemoveObjectFromGeneration(std::string fileName)
 	_loadedIn.erase(_loadedIn.begin() + index);
 	_materialsForSpawning.erase(_materialsForSpawning.begin() + index);
 	_numToSpawn.erase(_numToSpawn.begin() + index);
+	_spawnFromAll.erase(_spawnFromAll.begin() + index);
+	_spawnToAll.erase(_spawnToAll.begin() + index);
 	_avoidFromAll.erase(_avoidFromAll.begin() + index);
 	_avoidToAll.erase(_avoidToAll.begin() + index);
+	_radiusAll.erase(_radiusAll.begin() + index);
 	
 	//erase the filename from the list
 	_objectsToSpawn.erase(_objectsToSpawn.begin() + index);
 }
 
+void EnvironmentGenerator::SetNumToSpawn(std::string fileName, int numToSpawn)
+{
+	int index = Util::FindInVector(fileName, _objectsToSpawn);
+	if (index == -1)
+	{
+		printf("Object not found in list\n");
+		return;
+	}
+
+	_numToSpawn[index] = numToSpawn;
+}
+
+void EnvironmentGenerator::SetSpawnRadius(std::string fileName, float radius)
+{
+	int index = Util::FindInVector(fileName, _objectsToSpawn);
+	if (index == -1)
+	{
+		printf("Object not found in list\n");
+		return;
+	}
+
+	_radiusAll[index] = radius;
+}
+
+size_t EnvironmentGenerator::GetNumSpawned()
+{
+	size_t total = _numStreamed + _numBaked;
+	for (int i = 0; i < _objectsSpawned.size(); i++)
+	{
+		total += _objectsSpawned[i].size();
+	}
+	return total;
+}
+
+const EnvironmentGenerator::Timings& EnvironmentGenerator::GetLastTimings()
+{
+	return _timings;
+}
+
 std::vector<std::string> EnvironmentGenerator::GetObjectsOnList()
 {
 	return _objectsToSpawn;
@@ -4,13 +4,34 @@
 #include <ObjLoader.h>
 #include <RendererComponent.h>
 #include <Transform.h>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "Utilities/Util.h"
+#include "Utilities/PropPlacement.h"
+#include "Utilities/ChunkStreamer.h"
+#include "Utilities/WorkerPool.h"
+#include "Graphics/MeshData.h"
+#include "Graphics/StaticBatch.h"
+#include "Graphics/InstanceBatch.h"
+#include "Graphics/MeshLod.h"
+#include "Graphics/Terrain.h"
 
 class EnvironmentGenerator abstract
 {
 public:
+	//How long the last clean and generate took, in milliseconds
+	struct Timings
+	{
+		double Clean = 0.0;
+		//Working out where everything goes
+		double Place = 0.0;
+		//Creating the entities and their components
+		double Spawn = 0.0;
+		//Merging them into static or instanced batches (0 if they weren't)
+		double Bake = 0.0;
+	};
 	
 	//Regenerates environment with your settings
 	static void RegenerateEnvironment();
@@ -21,17 +42,66 @@ public:
 	
 	static void CleanUpPointers();
 
+	//Merges every spawned prop into a few big meshes per material (see StaticBatch) and removes the props' own entities
+	//*Props never move, so this trades them being separate objects for tens of draws instead of one each
+	//*With instanced, each object's copies in a cell are drawn with one instanced draw (see InstanceBatch) instead,
+	//*only props whose material has an instanced version (SetInstancedMaterial) are taken
+	//*CleanEnvironment gets rid of the batches along with everything else
+	static void BakeStatic(float cellSize, bool instanced = false);
+	//The material to draw instanced copies of props using material with, its shader has to read the per instance matrices
+	static void SetInstancedMaterial(const ShaderMaterial::sptr& material, const ShaderMaterial::sptr& instanced);
+
+	//Tiled world, the spawn areas are split into chunkSize squares that get made around the camera (off the main thread)
+	//*and removed once it moves away, so the world can be far bigger than what's loaded at once
+	//*Each object's number to spawn is spread over its whole spawn area
+	static void StartStreaming(float chunkSize, int loadRadius);
+	static void StopStreaming();
+	//Call once a frame, spawns the chunks that are ready and removes the ones the camera has left
+	static void UpdateStreaming(const glm::vec3& camera);
+	static bool IsStreaming();
+	//Draws the streaming stats (call inside an ImGui window)
+	static void RenderStreamingImGui();
+
+	//Builds a heightmap terrain (its chunks on the worker threads), props are stood on it from then on
+	//*CleanUpPointers gets rid of it
+	static void CreateTerrain(const Terrain::Settings& settings);
+	//nullptr if there isn't one, in which case props stand at 0
+	static const Terrain::sptr& GetTerrain();
+
 	//Adds object to generation
+	//*Objects with a radius are kept at least that far from everything else that has one (0 places them anywhere)
 	static void AddObjectToGeneration(std::string fileName, ShaderMaterial::sptr objMat, int numToSpawn, 
 										glm::vec2 spawnFrom, glm::vec2 spawnTo, std::vector<glm::vec2> avoidFrom, 
-											std::vector<glm::vec2> avoidTo);
+											std::vector<glm::vec2> avoidTo, float radius = 0.0f);
 	//Removes object from generation
 	static void RemoveObjectFromGeneration(std::string fileName);
+	//Changes how many of an object get spawned
+	static void SetNumToSpawn(std::string fileName, int numToSpawn);
+	//Changes how much room an object takes up
+	static void SetSpawnRadius(std::string fileName, float radius);
+	//Total number of objects that are currently spawned
+	static size_t GetNumSpawned();
+	static const Timings& GetLastTimings();
+
+	//Names every spawned object after its file plus a number, otherwise they don't get a GameObjectTag at all
+	static bool UniqueNames;
+	//Threads that work out placements (0 uses every core), the layout is the same for any number
+	static int WorkerThreads;
+	//Gives every spawned prop levels of detail (see LodSystem)
+	static bool UseLods;
+	//Gives them impostors as well, so they turn into cards far away (needs UseLods)
+	static bool UseImpostors;
+	//Bakes the props straight after generating them, into cells StaticCellSize wide
+	static bool BakeStaticProps;
+	//Same, but instanced (BakeStaticProps wins if both are set)
+	static bool InstanceStaticProps;
+	static float StaticCellSize;
 
 	static std::vector<std::string> GetObjectsOnList();
 private:
-	//The gameobjects spawned here
-	static std::vector<std::vector<GameObject>> _objectsSpawned;
+	//The entities spawned for each object, kept together so they can be destroyed in one go
+	static std::vector<std::vector<entt::entity>> _objectsSpawned;
+	static Timings _timings;
 
 	//The vaos to spawn in
 	static std::vector<VertexArrayObject::sptr> _vaosToSpawn;
@@ -42,6 +112,33 @@ private:
 	static std::vector<glm::vec2> _spawnToAll;
 	static std::vector<std::vector<glm::vec2>> _avoidFromAll;
 	static std::vector<std::vector<glm::vec2>> _avoidToAll;
+	static std::vector<float> _radiusAll;
+
+	//Copies the generation settings of every object
+	static void GetObjects(std::vector<PropPlacement::Object>& objects);
+	//Creates the entities for each object's placements
+	static void Spawn(const std::vector<std::vector<PropPlacement::Placement>>& placements, std::vector<std::vector<entt::entity>>& entities);
+
+	//Made the first time it's needed, and stopped by CleanUpPointers
+	static WorkerPool& GetWorkers();
+	static std::unique_ptr<WorkerPool> _workers;
+
+	static std::unique_ptr<ChunkStreamer> _streamer;
+	//Each loaded chunk's entities for each object
+	static std::unordered_map<uint64_t, std::vector<std::vector<entt::entity>>> _streamedChunks;
+	static size_t _numStreamed;
+
+	//Batches made by BakeStatic, and how many props went into them
+	static std::vector<entt::entity> _staticBatches;
+	static size_t _numBaked;
+	static std::unordered_map<ShaderMaterial*, ShaderMaterial::sptr> _instancedMaterials;
+	//Which object a mesh (or one of its levels of detail) belongs to, -1 if none
+	static int FindObject(const VertexArrayObject::sptr& mesh);
+	//The objects' meshes on the CPU, welded and reordered by MeshOptimizer when it's on
+	static const MeshData& GetMeshData(const std::string& fileName);
+	static std::unordered_map<std::string, MeshData> _meshData;
+
+	static Terrain::sptr _terrain;
 
 	//Allows us to go through and remove from list
 	static std::vector<std::string> _objectsToSpawn;
@@ -49,5 +146,4 @@ private:
 	////////Not Implemented/////
 	//static std::vector<char> _letterRepresentation;
 	//static std::vector<std::vector<char>> _generatedMapPlacements;
-	//static std::vector<std::vector<float>> _generatedMapHeight;
 };
\ No newline at end of file
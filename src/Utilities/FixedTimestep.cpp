@@ -0,0 +1,103 @@
+#include "FixedTimestep.h"
+
+#include <IBehaviour.h>
+#include <algorithm>
+
+int FixedTimestep::Advance(float frameTime)
+{
+	if (!Enabled || TickRate <= 0.0f)
+	{
+		_accumulator = 0.0;
+		_ticks = 1;
+		return _ticks;
+	}
+
+	//Kept in double so a fixed frame time (like the benchmark's) always lands on the same number of ticks
+	double step = 1.0 / TickRate;
+	_accumulator += std::max(frameTime, 0.0f);
+	_ticks = static_cast<int>(_accumulator / step);
+	_accumulator -= _ticks * step;
+
+	//Past this point we'd fall further behind every frame, so let the simulation slow down instead
+	if (_ticks > MaxTicks)
+	{
+		_droppedTime += (_ticks - MaxTicks) * step;
+		_ticks = MaxTicks;
+	}
+	_totalTicks += _ticks;
+	return _ticks;
+}
+
+void FixedTimestep::Reset()
+{
+	_accumulator = 0.0;
+	_ticks = 0;
+}
+
+float FixedTimestep::GetStep() const
+{
+	return TickRate > 0.0f ? 1.0f / TickRate : 0.0f;
+}
+
+float FixedTimestep::GetAlpha() const
+{
+	if (!Enabled || TickRate <= 0.0f)
+		return 1.0f;
+	return static_cast<float>(std::clamp(_accumulator * TickRate, 0.0, 1.0));
+}
+
+int FixedTimestep::GetTicks() const
+{
+	return _ticks;
+}
+
+uint64_t FixedTimestep::GetTotalTicks() const
+{
+	return _totalTicks;
+}
+
+double FixedTimestep::GetDroppedTime() const
+{
+	return _droppedTime;
+}
+
+void FixedTimestep::StoreState(entt::registry& registry)
+{
+	//Only things with behaviours can move, so they're the only ones worth interpolating
+	registry.view<BehaviourBinding, Transform>().each([&](entt::entity entity, BehaviourBinding&, Transform& transform) {
+		InterpolatedTransform& state = registry.get_or_emplace<InterpolatedTransform>(entity);
+		state.PreviousPosition = transform.GetLocalPosition();
+		state.PreviousRotation = transform.GetLocalRotationQuat();
+		state.PreviousScale = transform.GetLocalScale();
+	});
+}
+
+void FixedTimestep::ApplyInterpolation(entt::registry& registry, float alpha)
+{
+	registry.view<InterpolatedTransform, Transform>().each([&](InterpolatedTransform& state, Transform& transform) {
+		state.CurrentPosition = transform.GetLocalPosition();
+		state.CurrentRotation = transform.GetLocalRotationQuat();
+		state.CurrentScale = transform.GetLocalScale();
+		transform.SetLocalPosition(glm::mix(state.PreviousPosition, state.CurrentPosition, alpha));
+		transform.SetLocalRotation(glm::slerp(state.PreviousRotation, state.CurrentRotation, alpha));
+		transform.SetLocalScale(glm::mix(state.PreviousScale, state.CurrentScale, alpha));
+	});
+}
+
+void FixedTimestep::RestoreState(entt::registry& registry)
+{
+	registry.view<InterpolatedTransform, Transform>().each([](InterpolatedTransform& state, Transform& transform) {
+		transform.SetLocalPosition(state.CurrentPosition);
+		transform.SetLocalRotation(state.CurrentRotation);
+		transform.SetLocalScale(state.CurrentScale);
+	});
+}
+
+void FixedTimestep::Snap(entt::registry& registry)
+{
+	registry.view<InterpolatedTransform, Transform>().each([](InterpolatedTransform& state, Transform& transform) {
+		state.PreviousPosition = transform.GetLocalPosition();
+		state.PreviousRotation = transform.GetLocalRotationQuat();
+		state.PreviousScale = transform.GetLocalScale();
+	});
+}
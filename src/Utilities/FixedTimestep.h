@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <Transform.h>
+
+//The last two simulation states of something that moves, so rendering can blend between them
+struct InterpolatedTransform
+{
+	glm::vec3 PreviousPosition = glm::vec3(0.0f);
+	glm::quat PreviousRotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	glm::vec3 PreviousScale = glm::vec3(1.0f);
+	//Where the simulation actually left it, the transform gets set back to this after rendering
+	glm::vec3 CurrentPosition = glm::vec3(0.0f);
+	glm::quat CurrentRotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	glm::vec3 CurrentScale = glm::vec3(1.0f);
+};
+
+//Runs the simulation in fixed size ticks, however many fit into the frame time
+//*Rendering happens between the last two ticks, so the simulation and frame rate don't have to match
+class FixedTimestep
+{
+public:
+	//Adds the frame time to the accumulator, and returns how many ticks to run this frame
+	//*Always returns 1 when disabled, the tick then just uses the frame time
+	int Advance(float frameTime);
+	//Empties the accumulator
+	void Reset();
+
+	//Length of a tick (in seconds)
+	float GetStep() const;
+	//How far we are between the last tick and the next one (0 to 1)
+	float GetAlpha() const;
+	//How many ticks ran last frame
+	int GetTicks() const;
+	//How many ticks have run in total
+	uint64_t GetTotalTicks() const;
+	//Time thrown away because a frame needed more than MaxTicks (in seconds)
+	double GetDroppedTime() const;
+
+	//Saves the current transform of everything with a behaviour as its previous state, call before each tick
+	static void StoreState(entt::registry& registry);
+	//Moves everything to its interpolated transform for rendering
+	static void ApplyInterpolation(entt::registry& registry, float alpha);
+	//Puts everything back where the simulation left it, call once rendering is done
+	static void RestoreState(entt::registry& registry);
+	//Drops the previous state, so something that got teleported doesn't get blended across the jump
+	static void Snap(entt::registry& registry);
+
+	//Run the behaviours in fixed ticks, otherwise once a frame with the frame time
+	bool Enabled = true;
+	//Simulation ticks per second
+	float TickRate = 60.0f;
+	//Blend the rendered transforms between ticks
+	bool Interpolate = true;
+	//Most ticks that can run in one frame, so a slow frame doesn't make the next one slower
+	int MaxTicks = 8;
+
+private:
+	double _accumulator = 0.0;
+	double _droppedTime = 0.0;
+	int _ticks = 0;
+	uint64_t _totalTicks = 0;
+};
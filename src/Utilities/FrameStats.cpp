@@ -0,0 +1,424 @@
+#include "FrameStats.h"
+
+#include <algorithm>
+#include <fstream>
+#include <json.hpp>
+#include <Logging.h>
+#include "imgui.h"
+
+P2Quantile::P2Quantile(double quantile)
+{
+	_quantile = quantile;
+}
+
+void P2Quantile::Add(double value)
+{
+	//The first five samples just fill the markers
+	if (_count < 5)
+	{
+		_heights[_count++] = value;
+		if (_count == 5)
+		{
+			std::sort(_heights, _heights + 5);
+			double p = _quantile;
+			for (int i = 0; i < 5; i++)
+				_positions[i] = double(i);
+			_desired[0] = 0.0;
+			_desired[1] = 2.0 * p;
+			_desired[2] = 4.0 * p;
+			_desired[3] = 2.0 + 2.0 * p;
+			_desired[4] = 4.0;
+			_increments[0] = 0.0;
+			_increments[1] = p / 2.0;
+			_increments[2] = p;
+			_increments[3] = (1.0 + p) / 2.0;
+			_increments[4] = 1.0;
+		}
+		return;
+	}
+
+	//Find the cell the sample lands in, extending the ends if needed
+	int cell;
+	if (value < _heights[0])
+	{
+		_heights[0] = value;
+		cell = 0;
+	}
+	else if (value >= _heights[4])
+	{
+		_heights[4] = value;
+		cell = 3;
+	}
+	else
+	{
+		cell = 0;
+		while (cell < 3 && value >= _heights[cell + 1])
+			cell++;
+	}
+
+	for (int i = cell + 1; i < 5; i++)
+		_positions[i] += 1.0;
+	for (int i = 0; i < 5; i++)
+		_desired[i] += _increments[i];
+
+	//Nudge the middle markers towards where they should be
+	for (int i = 1; i < 4; i++)
+	{
+		double offset = _desired[i] - _positions[i];
+		if ((offset >= 1.0 && _positions[i + 1] - _positions[i] > 1.0) ||
+			(offset <= -1.0 && _positions[i - 1] - _positions[i] < -1.0))
+		{
+			double d = offset >= 0.0 ? 1.0 : -1.0;
+			int step = int(d);
+
+			//Piecewise parabolic prediction
+			double parabolic = _heights[i] + d / (_positions[i + 1] - _positions[i - 1]) *
+				((_positions[i] - _positions[i - 1] + d) * (_heights[i + 1] - _heights[i]) / (_positions[i + 1] - _positions[i]) +
+				(_positions[i + 1] - _positions[i] - d) * (_heights[i] - _heights[i - 1]) / (_positions[i] - _positions[i - 1]));
+
+			if (_heights[i - 1] < parabolic && parabolic < _heights[i + 1])
+				_heights[i] = parabolic;
+			else
+				//Fall back to linear if the parabola overshoots a neighbour
+				_heights[i] += d * (_heights[i + step] - _heights[i]) / (_positions[i + step] - _positions[i]);
+
+			_positions[i] += d;
+		}
+	}
+
+	_count++;
+}
+
+double P2Quantile::Get() const
+{
+	if (_count == 0)
+		return 0.0;
+
+	//Not enough samples for the markers yet, so just take it from the sorted samples
+	if (_count < 5)
+	{
+		double sorted[5];
+		std::copy(_heights, _heights + _count, sorted);
+		std::sort(sorted, sorted + _count);
+		size_t index = size_t(_quantile * double(_count - 1) + 0.5);
+		return sorted[index];
+	}
+
+	return _heights[2];
+}
+
+uint64_t P2Quantile::GetCount() const
+{
+	return _count;
+}
+
+FrameStats::FrameStats(size_t windowSize)
+	: _ring(new Slot[CAPACITY])
+	, _windowSize(std::clamp(windowSize, size_t(1), CAPACITY))
+{
+	const double quantiles[3] = { 0.5, 0.95, 0.99 };
+	for (int i = 0; i < 3; i++)
+	{
+		_sessionCpu[i] = P2Quantile(quantiles[i]);
+		_sessionGpu[i] = P2Quantile(quantiles[i]);
+		_sessionPresent[i] = P2Quantile(quantiles[i]);
+	}
+}
+
+void FrameStats::BeginFrame()
+{
+	_frameStart = Clock::now();
+}
+
+void FrameStats::EndCpu()
+{
+	_cpuEnd = Clock::now();
+}
+
+void FrameStats::EndFrame()
+{
+	Clock::time_point now = Clock::now();
+
+	float cpuTime = std::chrono::duration<float, std::milli>(_cpuEnd - _frameStart).count();
+	//The first frame has nothing to measure the interval against
+	float presentInterval = _hasPresent ? std::chrono::duration<float, std::milli>(now - _lastPresent).count() : cpuTime;
+
+	_lastPresent = now;
+	_hasPresent = true;
+
+	Record(cpuTime, presentInterval);
+}
+
+uint64_t FrameStats::Record(float cpuTime, float presentInterval)
+{
+	uint64_t frame = _writeIndex.load(std::memory_order_relaxed);
+
+	//Anything over the threshold is a hitch, and so is anything well over what the session normally looks like
+	//*(once there's a median to judge against)
+	float typical = float(_sessionPresent[0].Get());
+	bool hitch = presentInterval > HitchThreshold || (_sessionPresent[0].GetCount() > 0 && presentInterval > HitchFactor * typical);
+
+	Slot& slot = _ring[frame % CAPACITY];
+	//Zero tells readers the slot is mid write
+	slot.Sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.CpuTime.store(cpuTime, std::memory_order_relaxed);
+	slot.GpuTime.store(-1.0f, std::memory_order_relaxed);
+	slot.PresentInterval.store(presentInterval, std::memory_order_relaxed);
+	slot.Hitch.store(hitch, std::memory_order_relaxed);
+	slot.Sequence.store(frame + 1, std::memory_order_release);
+	_writeIndex.store(frame + 1, std::memory_order_release);
+
+	for (int i = 0; i < 3; i++)
+	{
+		_sessionCpu[i].Add(cpuTime);
+		_sessionPresent[i].Add(presentInterval);
+	}
+	_sessionCpuTotal += cpuTime;
+	_sessionPresentTotal += presentInterval;
+	_sessionCpuMax = std::max(_sessionCpuMax, cpuTime);
+	_sessionPresentMax = std::max(_sessionPresentMax, presentInterval);
+	if (hitch)
+		_hitches.fetch_add(1, std::memory_order_relaxed);
+
+	return frame;
+}
+
+void FrameStats::RecordGpuTime(uint64_t frame, float gpuTime)
+{
+	//Results can repeat or come in late, only take each frame once
+	if (_hasGpuFrame && frame <= _lastGpuFrame)
+		return;
+
+	Slot& slot = _ring[frame % CAPACITY];
+	if (slot.Sequence.load(std::memory_order_acquire) != frame + 1)
+		return;
+
+	slot.GpuTime.store(gpuTime, std::memory_order_release);
+	_lastGpuFrame = frame;
+	_hasGpuFrame = true;
+
+	for (int i = 0; i < 3; i++)
+		_sessionGpu[i].Add(gpuTime);
+	_sessionGpuTotal += gpuTime;
+	_sessionGpuMax = std::max(_sessionGpuMax, gpuTime);
+}
+
+bool FrameStats::ReadSlot(uint64_t frame, Sample& out) const
+{
+	const Slot& slot = _ring[frame % CAPACITY];
+
+	uint64_t before = slot.Sequence.load(std::memory_order_acquire);
+	out.Frame = frame;
+	out.CpuTime = slot.CpuTime.load(std::memory_order_relaxed);
+	out.GpuTime = slot.GpuTime.load(std::memory_order_relaxed);
+	out.PresentInterval = slot.PresentInterval.load(std::memory_order_relaxed);
+	out.Hitch = slot.Hitch.load(std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_acquire);
+	uint64_t after = slot.Sequence.load(std::memory_order_relaxed);
+
+	//If the writer lapped us the sequence won't match
+	return before == frame + 1 && after == before;
+}
+
+size_t FrameStats::CopyWindow(std::vector<Sample>& out) const
+{
+	out.clear();
+
+	uint64_t end = _writeIndex.load(std::memory_order_acquire);
+	uint64_t count = std::min<uint64_t>(end, _windowSize.load(std::memory_order_relaxed));
+
+	Sample sample;
+	for (uint64_t frame = end - count; frame < end; frame++)
+	{
+		if (ReadSlot(frame, sample))
+			out.push_back(sample);
+	}
+
+	return out.size();
+}
+
+size_t FrameStats::CopyFrames(uint64_t first, uint64_t end, std::vector<Sample>& out) const
+{
+	out.clear();
+
+	//Anything older than CAPACITY frames has been written over
+	uint64_t written = _writeIndex.load(std::memory_order_acquire);
+	end = std::min(end, written);
+	if (written > CAPACITY)
+		first = std::max(first, written - CAPACITY);
+
+	Sample sample;
+	for (uint64_t frame = first; frame < end; frame++)
+	{
+		if (ReadSlot(frame, sample))
+			out.push_back(sample);
+	}
+
+	return out.size();
+}
+
+FrameStats::Distribution FrameStats::Describe(std::vector<float>& values)
+{
+	Distribution result;
+	result.Count = values.size();
+	if (values.empty())
+		return result;
+
+	std::sort(values.begin(), values.end());
+
+	//Nearest rank percentiles
+	auto rank = [&](float p) {
+		size_t index = size_t(p * float(values.size() - 1) + 0.5f);
+		return values[std::min(index, values.size() - 1)];
+	};
+
+	double total = 0.0;
+	for (float value : values)
+		total += value;
+
+	result.P50 = rank(0.50f);
+	result.P95 = rank(0.95f);
+	result.P99 = rank(0.99f);
+	result.Min = values.front();
+	result.Max = values.back();
+	result.Mean = float(total / double(values.size()));
+
+	return result;
+}
+
+FrameStats::Summary FrameStats::GetSummary() const
+{
+	std::vector<Sample> samples;
+	CopyWindow(samples);
+
+	std::vector<float> cpu, gpu, present;
+	cpu.reserve(samples.size());
+	gpu.reserve(samples.size());
+	present.reserve(samples.size());
+
+	Summary summary;
+	for (const Sample& sample : samples)
+	{
+		cpu.push_back(sample.CpuTime);
+		present.push_back(sample.PresentInterval);
+		if (sample.GpuTime >= 0.0f)
+			gpu.push_back(sample.GpuTime);
+		if (sample.Hitch)
+			summary.Hitches++;
+	}
+
+	summary.Cpu = Describe(cpu);
+	summary.Gpu = Describe(gpu);
+	summary.Present = Describe(present);
+
+	return summary;
+}
+
+void FrameStats::SetWindowSize(size_t windowSize)
+{
+	_windowSize.store(std::clamp(windowSize, size_t(1), CAPACITY), std::memory_order_relaxed);
+}
+
+size_t FrameStats::GetWindowSize() const
+{
+	return _windowSize.load(std::memory_order_relaxed);
+}
+
+uint64_t FrameStats::GetFrameCount() const
+{
+	return _writeIndex.load(std::memory_order_acquire);
+}
+
+uint64_t FrameStats::GetHitchCount() const
+{
+	return _hitches.load(std::memory_order_relaxed);
+}
+
+void FrameStats::RenderImGui()
+{
+	if (!ImGui::CollapsingHeader("Frame Stats"))
+		return;
+
+	int windowSize = int(GetWindowSize());
+	if (ImGui::SliderInt("Window (frames)", &windowSize, 16, 4096))
+		SetWindowSize(size_t(windowSize));
+	ImGui::SliderFloat("Hitch Threshold (ms)", &HitchThreshold, 5.0f, 200.0f);
+	ImGui::SliderFloat("Hitch Factor", &HitchFactor, 1.0f, 10.0f);
+
+	CopyWindow(_uiSamples);
+	_uiPlot.resize(_uiSamples.size());
+	for (size_t i = 0; i < _uiSamples.size(); i++)
+		_uiPlot[i] = _uiSamples[i].PresentInterval;
+
+	Summary summary = GetSummary();
+	ImGui::PlotLines("Frame Time (ms)", _uiPlot.data(), int(_uiPlot.size()), 0, nullptr, 0.0f, summary.Present.Max, ImVec2(0.0f, 60.0f));
+
+	ImGui::Text("            p50      p95      p99      max");
+	ImGui::Text("CPU     %7.2f  %7.2f  %7.2f  %7.2f", summary.Cpu.P50, summary.Cpu.P95, summary.Cpu.P99, summary.Cpu.Max);
+	ImGui::Text("GPU     %7.2f  %7.2f  %7.2f  %7.2f", summary.Gpu.P50, summary.Gpu.P95, summary.Gpu.P99, summary.Gpu.Max);
+	ImGui::Text("Present %7.2f  %7.2f  %7.2f  %7.2f", summary.Present.P50, summary.Present.P95, summary.Present.P99, summary.Present.Max);
+	ImGui::Text("FPS (p50): %.1f", summary.Present.P50 > 0.0f ? 1000.0f / summary.Present.P50 : 0.0f);
+	ImGui::Text("Hitches: %llu in window, %llu total", (unsigned long long)summary.Hitches, (unsigned long long)GetHitchCount());
+}
+
+bool FrameStats::WriteJson(const std::string& path) const
+{
+	Summary window = GetSummary();
+
+	auto describe = [](const Distribution& dist) {
+		nlohmann::json result;
+		result["p50"] = dist.P50;
+		result["p95"] = dist.P95;
+		result["p99"] = dist.P99;
+		result["min"] = dist.Min;
+		result["max"] = dist.Max;
+		result["mean"] = dist.Mean;
+		result["count"] = dist.Count;
+		return result;
+	};
+	auto session = [](const P2Quantile* quantiles, double total, float max) {
+		nlohmann::json result;
+		uint64_t count = quantiles[0].GetCount();
+		result["p50"] = quantiles[0].Get();
+		result["p95"] = quantiles[1].Get();
+		result["p99"] = quantiles[2].Get();
+		result["max"] = max;
+		result["mean"] = count > 0 ? total / double(count) : 0.0;
+		result["count"] = count;
+		return result;
+	};
+
+	nlohmann::json root;
+	root["build"]["date"] = __DATE__;
+	root["build"]["time"] = __TIME__;
+#ifdef _DEBUG
+	root["build"]["config"] = "debug";
+#else
+	root["build"]["config"] = "release";
+#endif
+	root["units"] = "ms";
+	root["frames"] = GetFrameCount();
+	root["hitches"] = GetHitchCount();
+	root["hitch_threshold"] = HitchThreshold;
+	root["hitch_factor"] = HitchFactor;
+
+	root["window"]["size"] = GetWindowSize();
+	root["window"]["hitches"] = window.Hitches;
+	root["window"]["cpu"] = describe(window.Cpu);
+	root["window"]["gpu"] = describe(window.Gpu);
+	root["window"]["present"] = describe(window.Present);
+
+	root["session"]["cpu"] = session(_sessionCpu, _sessionCpuTotal, _sessionCpuMax);
+	root["session"]["gpu"] = session(_sessionGpu, _sessionGpuTotal, _sessionGpuMax);
+	root["session"]["present"] = session(_sessionPresent, _sessionPresentTotal, _sessionPresentMax);
+
+	std::ofstream file(path);
+	if (!file.is_open())
+	{
+		LOG_ERROR("Failed to write frame stats to {}", path);
+		return false;
+	}
+	file << root.dump(4);
+	return true;
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+//Streaming quantile estimate using the P-squared algorithm (Jain and Chlamtac)
+//*Uses constant memory, so it can run over a whole session
+class P2Quantile
+{
+public:
+	P2Quantile(double quantile = 0.5);
+
+	//Adds a sample to the estimate
+	void Add(double value);
+	//Gets the current estimate
+	double Get() const;
+	//How many samples have been added
+	uint64_t GetCount() const;
+
+private:
+	double _quantile;
+	uint64_t _count = 0;
+	//Marker heights, positions, desired positions and desired position increments
+	double _heights[5];
+	double _positions[5];
+	double _desired[5];
+	double _increments[5];
+};
+
+//Records raw frame times into a lock free ring and keeps percentiles over them
+//*One thread writes (the render loop), any thread can read
+class FrameStats
+{
+public:
+	//A single frame (all times in ms)
+	struct Sample
+	{
+		uint64_t Frame;
+		float CpuTime;
+		//Negative until the GPU results come back
+		float GpuTime;
+		float PresentInterval;
+		bool Hitch;
+	};
+
+	//Stats for one of the times
+	struct Distribution
+	{
+		float P50 = 0.0f;
+		float P95 = 0.0f;
+		float P99 = 0.0f;
+		float Min = 0.0f;
+		float Max = 0.0f;
+		float Mean = 0.0f;
+		size_t Count = 0;
+	};
+
+	//Stats for the whole window
+	struct Summary
+	{
+		Distribution Cpu;
+		Distribution Gpu;
+		Distribution Present;
+		//Hitches inside the window
+		uint64_t Hitches = 0;
+	};
+
+	//The most frames the ring can hold (and so the largest window)
+	static const size_t CAPACITY = 16384;
+
+	FrameStats(size_t windowSize = 256);
+
+	//Timing helpers for the render loop
+	//*BeginFrame at the top of the loop, EndCpu right before the swap, EndFrame right after it
+	void BeginFrame();
+	void EndCpu();
+	void EndFrame();
+
+	//Pushes a frame in directly, returns its frame number
+	uint64_t Record(float cpuTime, float presentInterval);
+	//Fills in the GPU time of a frame, once it's known
+	//*Ignored if the frame has already left the ring or was already filled in
+	void RecordGpuTime(uint64_t frame, float gpuTime);
+
+	//Copies the frames in the window (oldest first), returns how many were copied
+	size_t CopyWindow(std::vector<Sample>& out) const;
+	//Copies the frames from first up to (not including) end that are still in the ring, returns how many were copied
+	size_t CopyFrames(uint64_t first, uint64_t end, std::vector<Sample>& out) const;
+	//Works out the percentiles over the window
+	Summary GetSummary() const;
+
+	//Window size, clamped to the capacity
+	void SetWindowSize(size_t windowSize);
+	size_t GetWindowSize() const;
+
+	//Totals over the whole session
+	uint64_t GetFrameCount() const;
+	uint64_t GetHitchCount() const;
+
+	//Works out the stats of a set of values (sorts them in place)
+	static Distribution Describe(std::vector<float>& values);
+
+	//Draws the stats (call inside an ImGui window)
+	void RenderImGui();
+
+	//Dumps the window and session stats to a json file
+	bool WriteJson(const std::string& path) const;
+
+	//A frame is a hitch if it takes longer than the threshold (in ms)
+	//or longer than the factor times the session median
+	float HitchThreshold = 50.0f;
+	float HitchFactor = 2.5f;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	//A slot in the ring, the sequence tells readers if the slot changed under them
+	struct Slot
+	{
+		std::atomic<uint64_t> Sequence{ 0 };
+		std::atomic<float> CpuTime{ 0.0f };
+		std::atomic<float> GpuTime{ -1.0f };
+		std::atomic<float> PresentInterval{ 0.0f };
+		std::atomic<bool> Hitch{ false };
+	};
+
+	//Reads a slot, returns false if it was being written
+	bool ReadSlot(uint64_t frame, Sample& out) const;
+
+	std::unique_ptr<Slot[]> _ring;
+	std::atomic<uint64_t> _writeIndex{ 0 };
+	std::atomic<size_t> _windowSize;
+
+	//Session stats, only touched by the writing thread
+	P2Quantile _sessionCpu[3];
+	P2Quantile _sessionGpu[3];
+	P2Quantile _sessionPresent[3];
+	double _sessionCpuTotal = 0.0;
+	double _sessionGpuTotal = 0.0;
+	double _sessionPresentTotal = 0.0;
+	float _sessionCpuMax = 0.0f;
+	float _sessionGpuMax = 0.0f;
+	float _sessionPresentMax = 0.0f;
+	std::atomic<uint64_t> _hitches{ 0 };
+	uint64_t _lastGpuFrame = 0;
+	bool _hasGpuFrame = false;
+
+	//Timing helpers
+	Clock::time_point _frameStart;
+	Clock::time_point _cpuEnd;
+	Clock::time_point _lastPresent;
+	bool _hasPresent = false;
+
+	//Kept around so the ImGui plot doesn't reallocate each frame
+	std::vector<Sample> _uiSamples;
+	std::vector<float> _uiPlot;
+};
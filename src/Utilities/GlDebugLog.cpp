@@ -0,0 +1,289 @@
+#include "GlDebugLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <Logging.h>
+#include "imgui.h"
+
+std::atomic<bool> GlDebugLog::LogNotifications(true);
+std::atomic<int> GlDebugLog::MaxPerInterval(3);
+std::atomic<float> GlDebugLog::Interval(1.0f);
+
+GlDebugLog::Slot GlDebugLog::_ring[GlDebugLog::RING_SIZE];
+std::atomic<size_t> GlDebugLog::_writePos(0);
+size_t GlDebugLog::_readPos = 0;
+
+std::thread GlDebugLog::_worker;
+std::atomic<bool> GlDebugLog::_running(false);
+
+std::mutex GlDebugLog::_statsMutex;
+std::unordered_map<uint64_t, GlDebugLog::IdState> GlDebugLog::_ids;
+std::vector<GlDebugLog::Line> GlDebugLog::_lines;
+
+std::atomic<uint64_t> GlDebugLog::_received(0);
+std::atomic<uint64_t> GlDebugLog::_dropped(0);
+std::atomic<uint64_t> GlDebugLog::_filtered(0);
+std::atomic<uint64_t> GlDebugLog::_logged(0);
+std::atomic<uint64_t> GlDebugLog::_suppressed(0);
+
+namespace
+{
+	//How long the logging thread sleeps when the ring is empty
+	const auto POLL_INTERVAL = std::chrono::milliseconds(5);
+
+	double Now()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	const char* SourceName(GLenum source)
+	{
+		switch (source) {
+		case GL_DEBUG_SOURCE_API: return "DEBUG";
+		case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "WINDOW";
+		case GL_DEBUG_SOURCE_SHADER_COMPILER: return "SHADER";
+		case GL_DEBUG_SOURCE_THIRD_PARTY: return "THIRD PARTY";
+		case GL_DEBUG_SOURCE_APPLICATION: return "APP";
+		case GL_DEBUG_SOURCE_OTHER: default: return "OTHER";
+		}
+	}
+}
+
+void GlDebugLog::Start()
+{
+	if (_running)
+		return;
+
+	for (size_t i = 0; i < RING_SIZE; i++)
+		_ring[i].Sequence.store(i, std::memory_order_relaxed);
+	_writePos.store(0, std::memory_order_relaxed);
+	_readPos = 0;
+
+	_running = true;
+	_worker = std::thread(&GlDebugLog::WorkerLoop);
+}
+
+void GlDebugLog::Stop()
+{
+	if (!_running)
+		return;
+	_running = false;
+	if (_worker.joinable())
+		_worker.join();
+
+	if (_dropped > 0 || _suppressed > 0)
+		LOG_INFO("GL debug: {} messages, {} logged, {} held back by the rate limit, {} dropped", _received.load(), _logged.load(), _suppressed.load(), _dropped.load());
+}
+
+bool GlDebugLog::Push(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message)
+{
+	_received.fetch_add(1, std::memory_order_relaxed);
+	if (severity == GL_DEBUG_SEVERITY_NOTIFICATION && !LogNotifications.load(std::memory_order_relaxed))
+	{
+		_filtered.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+	if (!_running.load(std::memory_order_relaxed))
+	{
+		_dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	//Claim a slot, if the one at the write position hasn't been read yet the ring is full
+	size_t pos = _writePos.load(std::memory_order_relaxed);
+	Slot* slot;
+	while (true)
+	{
+		slot = &_ring[pos & (RING_SIZE - 1)];
+		size_t sequence = slot->Sequence.load(std::memory_order_acquire);
+		intptr_t diff = intptr_t(sequence) - intptr_t(pos);
+		if (diff == 0)
+		{
+			if (_writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+		{
+			_dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		else
+			pos = _writePos.load(std::memory_order_relaxed);
+	}
+
+	slot->Data.Source = source;
+	slot->Data.Type = type;
+	slot->Data.Severity = severity;
+	slot->Data.Id = id;
+	//Length can be negative, in which case the message is null terminated
+	size_t size = length >= 0 ? size_t(length) : strlen(message);
+	size = std::min(size, size_t(MAX_MESSAGE_LENGTH - 1));
+	memcpy(slot->Data.Text, message, size);
+	slot->Data.Text[size] = '\0';
+
+	slot->Sequence.store(pos + 1, std::memory_order_release);
+	return true;
+}
+
+bool GlDebugLog::Pop(Message& message)
+{
+	Slot& slot = _ring[_readPos & (RING_SIZE - 1)];
+	if (slot.Sequence.load(std::memory_order_acquire) != _readPos + 1)
+		return false;
+
+	message = slot.Data;
+	//Hand the slot back to the writers for the next lap around the ring
+	slot.Sequence.store(_readPos + RING_SIZE, std::memory_order_release);
+	_readPos++;
+	return true;
+}
+
+void GlDebugLog::WorkerLoop()
+{
+	Message message;
+	while (true)
+	{
+		//Read the flag before draining, so anything pushed before Stop still gets logged
+		bool running = _running;
+		double now = Now();
+		{
+			std::lock_guard<std::mutex> lock(_statsMutex);
+			while (Pop(message))
+				Handle(message, now);
+			for (auto& id : _ids)
+				FlushSuppressed(id.second, now, !running);
+		}
+
+		//Formatting happens outside the lock, so the UI never waits on the logger
+		for (const Line& line : _lines)
+			Write(line);
+		_lines.clear();
+
+		if (!running)
+			break;
+		std::this_thread::sleep_for(POLL_INTERVAL);
+	}
+}
+
+void GlDebugLog::Handle(const Message& message, double now)
+{
+	uint64_t key = (uint64_t(message.Source) << 32) | message.Id;
+	auto it = _ids.find(key);
+	if (it == _ids.end())
+	{
+		IdState state;
+		state.Stats.Source = message.Source;
+		state.Stats.Type = message.Type;
+		state.Stats.Severity = message.Severity;
+		state.Stats.Id = message.Id;
+		state.Stats.Text = message.Text;
+		state.WindowStart = now;
+		it = _ids.emplace(key, state).first;
+	}
+
+	IdState& state = it->second;
+	state.Stats.Count++;
+	FlushSuppressed(state, now, false);
+
+	if (state.WindowLogged < MaxPerInterval)
+	{
+		state.WindowLogged++;
+		state.Stats.Logged++;
+		_logged++;
+		_lines.push_back({ message.Source, message.Severity, message.Text });
+	}
+	else
+	{
+		state.WindowSuppressed++;
+		state.Stats.Suppressed++;
+		_suppressed++;
+	}
+}
+
+void GlDebugLog::FlushSuppressed(IdState& state, double now, bool force)
+{
+	if (!force && now - state.WindowStart < Interval)
+		return;
+
+	if (state.WindowSuppressed > 0)
+	{
+		_lines.push_back({ state.Stats.Source, state.Stats.Severity,
+			"(repeated " + std::to_string(state.WindowSuppressed) + " more times) " + state.Stats.Text });
+	}
+	state.WindowStart = now;
+	state.WindowLogged = 0;
+	state.WindowSuppressed = 0;
+}
+
+void GlDebugLog::Write(const Line& line)
+{
+	const char* source = SourceName(line.Source);
+	const std::string& text = line.Text;
+	switch (line.Severity) {
+	case GL_DEBUG_SEVERITY_LOW:          LOG_INFO("[{}] {}", source, text); break;
+	case GL_DEBUG_SEVERITY_MEDIUM:       LOG_WARN("[{}] {}", source, text); break;
+	case GL_DEBUG_SEVERITY_HIGH:         LOG_ERROR("[{}] {}", source, text); break;
+	case GL_DEBUG_SEVERITY_NOTIFICATION: LOG_INFO("[{}] {}", source, text); break;
+	default: break;
+	}
+}
+
+uint64_t GlDebugLog::GetReceived()
+{
+	return _received;
+}
+
+uint64_t GlDebugLog::GetDropped()
+{
+	return _dropped;
+}
+
+uint64_t GlDebugLog::GetFiltered()
+{
+	return _filtered;
+}
+
+uint64_t GlDebugLog::GetLogged()
+{
+	return _logged;
+}
+
+uint64_t GlDebugLog::GetSuppressed()
+{
+	return _suppressed;
+}
+
+std::vector<GlDebugLog::IdStats> GlDebugLog::GetStats()
+{
+	std::vector<IdStats> stats;
+	{
+		std::lock_guard<std::mutex> lock(_statsMutex);
+		stats.reserve(_ids.size());
+		for (const auto& id : _ids)
+			stats.push_back(id.second.Stats);
+	}
+	std::sort(stats.begin(), stats.end(), [](const IdStats& a, const IdStats& b) { return a.Count > b.Count; });
+	return stats;
+}
+
+void GlDebugLog::RenderImGui()
+{
+	if (!ImGui::CollapsingHeader("GL Debug Output"))
+		return;
+
+	bool notifications = LogNotifications;
+	if (ImGui::Checkbox("Log Notifications", &notifications))
+		LogNotifications = notifications;
+	int maxPerInterval = MaxPerInterval;
+	if (ImGui::SliderInt("Max Per ID Per Second", &maxPerInterval, 1, 20))
+		MaxPerInterval = maxPerInterval;
+
+	ImGui::Text("Received %llu, logged %llu, rate limited %llu", (unsigned long long)GetReceived(), (unsigned long long)GetLogged(), (unsigned long long)GetSuppressed());
+	ImGui::Text("Filtered %llu, dropped (ring full) %llu", (unsigned long long)GetFiltered(), (unsigned long long)GetDropped());
+
+	//The noisiest IDs are the ones worth looking at
+	std::vector<IdStats> stats = GetStats();
+	for (size_t i = 0; i < stats.size() && i < 8; i++)
+		ImGui::Text("%s %u: %llu (%.40s)", SourceName(stats[i].Source), stats[i].Id, (unsigned long long)stats[i].Count, stats[i].Text.c_str());
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+//Logs GL debug messages from a background thread, so the driver callback only copies the message
+//*Messages go through a lock-free ring (the driver can call back from its own threads), and
+//*repeats of the same ID are rate limited, with a summary of how many were held back
+class GlDebugLog abstract
+{
+public:
+	//What we know about one message ID
+	struct IdStats
+	{
+		GLenum Source = 0;
+		GLenum Type = 0;
+		GLenum Severity = 0;
+		GLuint Id = 0;
+		//Times it came in, was logged, and was held back by the rate limit
+		uint64_t Count = 0;
+		uint64_t Logged = 0;
+		uint64_t Suppressed = 0;
+		//The text of the first one we got
+		std::string Text;
+	};
+
+	//Starts the logging thread
+	static void Start();
+	//Logs whatever is left in the ring and stops the thread
+	static void Stop();
+
+	//Copies a message into the ring, this is all the driver callback does
+	//*Returns false if the ring was full (the message is counted as dropped)
+	static bool Push(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message);
+
+	//Counters
+	static uint64_t GetReceived();
+	static uint64_t GetDropped();
+	static uint64_t GetFiltered();
+	static uint64_t GetLogged();
+	static uint64_t GetSuppressed();
+	//Copies out the stats of every ID seen so far, most frequent first
+	static std::vector<IdStats> GetStats();
+
+	//Draws the counters and the noisiest IDs (call inside an ImGui window)
+	static void RenderImGui();
+
+	//Notification messages are thrown away in the callback when this is off
+	static std::atomic<bool> LogNotifications;
+	//Each ID gets logged at most this many times per interval (in seconds)
+	static std::atomic<int> MaxPerInterval;
+	static std::atomic<float> Interval;
+
+	//Longest message we keep, anything past this is cut off
+	static const int MAX_MESSAGE_LENGTH = 256;
+	//Messages the ring can hold (has to be a power of 2)
+	static const int RING_SIZE = 1024;
+
+private:
+	struct Message
+	{
+		GLenum Source;
+		GLenum Type;
+		GLenum Severity;
+		GLuint Id;
+		char Text[MAX_MESSAGE_LENGTH];
+	};
+
+	//A slot's sequence says whether it's free to write (== write position) or ready to read (== read position + 1)
+	struct Slot
+	{
+		std::atomic<size_t> Sequence;
+		Message Data;
+	};
+
+	//A line waiting to be logged, they're written once the stats lock is let go
+	struct Line
+	{
+		GLenum Source;
+		GLenum Severity;
+		std::string Text;
+	};
+
+	//The logging thread's own state for an ID
+	struct IdState
+	{
+		IdStats Stats;
+		double WindowStart = 0.0;
+		int WindowLogged = 0;
+		uint64_t WindowSuppressed = 0;
+	};
+
+	static void WorkerLoop();
+	//Takes the oldest message out of the ring, returns false if it's empty
+	static bool Pop(Message& message);
+	//Queues the message to be logged, or holds it back
+	static void Handle(const Message& message, double now);
+	//Queues how many repeats were held back once an ID's interval is up
+	static void FlushSuppressed(IdState& state, double now, bool force);
+	static void Write(const Line& line);
+
+	static Slot _ring[RING_SIZE];
+	static std::atomic<size_t> _writePos;
+	static size_t _readPos;
+
+	static std::thread _worker;
+	static std::atomic<bool> _running;
+
+	static std::mutex _statsMutex;
+	static std::unordered_map<uint64_t, IdState> _ids;
+	//Only touched by the logging thread
+	static std::vector<Line> _lines;
+
+	static std::atomic<uint64_t> _received;
+	static std::atomic<uint64_t> _dropped;
+	static std::atomic<uint64_t> _filtered;
+	static std::atomic<uint64_t> _logged;
+	static std::atomic<uint64_t> _suppressed;
+};
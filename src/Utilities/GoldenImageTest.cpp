@@ -0,0 +1,242 @@
+#include "GoldenImageTest.h"
+
+#include <filesystem>
+#include <fstream>
+#include <json.hpp>
+#include <Logging.h>
+
+#include "Utilities/ImageCompare.h"
+#include "Utilities/ImageIO.h"
+
+GoldenImageTest::GoldenImageTest(const std::vector<Case>& cases, const Settings& settings)
+{
+	_cases = cases;
+	_records.resize(cases.size());
+	_settings = settings;
+	//Need a few frames between cases for the GPU timings of the last one to come back
+	_settings.WarmupFrames = std::max(_settings.WarmupFrames, 8);
+	_settings.MeasuredFrames = std::max(_settings.MeasuredFrames, 1);
+}
+
+bool GoldenImageTest::FindGoldens(std::vector<std::string>& missing) const
+{
+	namespace fs = std::filesystem;
+	fs::path goldenDirectory = _settings.Directory;
+
+	nlohmann::json baseline;
+	std::ifstream file(goldenDirectory / "timings.json");
+	if (file.is_open())
+		baseline = nlohmann::json::parse(file, nullptr, false);
+
+	missing.clear();
+	for (const Case& testCase : _cases)
+	{
+		bool hasTiming = baseline.is_object() && baseline.contains(testCase.Name);
+		if (!hasTiming || !fs::exists(goldenDirectory / (testCase.Name + ".ppm")))
+			missing.push_back(testCase.Name);
+	}
+	return missing.empty();
+}
+
+bool GoldenImageTest::BeginFrame(uint64_t frameNumber)
+{
+	//Warmup, timed frames, then the capture frame
+	if (_currentCase < 0 || _caseFrame > _settings.WarmupFrames + _settings.MeasuredFrames)
+	{
+		_currentCase++;
+		if (_currentCase >= int(_cases.size()))
+			return false;
+
+		LOG_INFO("Golden image case {}", _cases[_currentCase].Name);
+		if (SetupCase)
+			SetupCase(_cases[_currentCase]);
+		_caseFrame = 0;
+	}
+
+	if (_caseFrame == _settings.WarmupFrames)
+		_records[_currentCase].FirstFrame = frameNumber;
+	if (IsCaptureFrame())
+		_records[_currentCase].EndFrame = frameNumber;
+
+	return true;
+}
+
+bool GoldenImageTest::IsCaptureFrame() const
+{
+	return _currentCase >= 0 && _caseFrame == _settings.WarmupFrames + _settings.MeasuredFrames;
+}
+
+void GoldenImageTest::Capture(std::vector<uint8_t>& pixels, unsigned width, unsigned height)
+{
+	CaseRecord& record = _records[_currentCase];
+	record.Width = width;
+	record.Height = height;
+	record.Pixels.swap(pixels);
+	//Files are stored top row first
+	ImageIO::FlipRows(record.Pixels, width, height);
+}
+
+void GoldenImageTest::EndFrame()
+{
+	_caseFrame++;
+}
+
+bool GoldenImageTest::Finish(const FrameStats& stats)
+{
+	namespace fs = std::filesystem;
+	fs::path goldenDirectory = _settings.Directory;
+	fs::path outputDirectory = _settings.OutputDirectory;
+	fs::create_directories(outputDirectory);
+	if (_settings.Update)
+		fs::create_directories(goldenDirectory);
+
+	std::vector<FrameStats::Sample> samples;
+	stats.CopyWindow(samples);
+
+	//The timings the goldens were made with
+	nlohmann::json baseline;
+	{
+		std::ifstream file(goldenDirectory / "timings.json");
+		if (file.is_open())
+			baseline = nlohmann::json::parse(file, nullptr, false);
+		if (baseline.is_discarded() || !baseline.is_object())
+			baseline = nlohmann::json::object();
+	}
+
+	nlohmann::json results;
+	results["update"] = _settings.Update;
+	results["min_psnr"] = _settings.MinPSNR;
+	results["min_ssim"] = _settings.MinSSIM;
+	results["time_tolerance"] = _settings.TimeTolerance;
+	results["cases"] = nlohmann::json::array();
+
+	nlohmann::json newBaseline = nlohmann::json::object();
+	bool passed = true;
+
+	for (size_t i = 0; i < _cases.size(); i++)
+	{
+		const Case& testCase = _cases[i];
+		const CaseRecord& record = _records[i];
+
+		nlohmann::json result;
+		result["name"] = testCase.Name;
+		std::vector<std::string> failures;
+
+		//Timings of the frames between the warmup and the capture
+		std::vector<float> cpu, gpu;
+		for (const FrameStats::Sample& sample : samples)
+		{
+			if (sample.Frame < record.FirstFrame || sample.Frame >= record.EndFrame)
+				continue;
+			cpu.push_back(sample.CpuTime);
+			if (sample.GpuTime >= 0.0f)
+				gpu.push_back(sample.GpuTime);
+		}
+		FrameStats::Distribution cpuTime = FrameStats::Describe(cpu);
+		FrameStats::Distribution gpuTime = FrameStats::Describe(gpu);
+		result["cpu_ms"] = cpuTime.P50;
+		result["gpu_ms"] = gpuTime.P50;
+		result["gpu_p95_ms"] = gpuTime.P95;
+
+		if (record.Pixels.empty())
+		{
+			failures.push_back("nothing was captured");
+		}
+		else if (_settings.Update)
+		{
+			ImageIO::WritePPM((goldenDirectory / (testCase.Name + ".ppm")).string(), record.Width, record.Height, record.Pixels.data(), false);
+			newBaseline[testCase.Name] = { { "cpu_ms", cpuTime.P50 }, { "gpu_ms", gpuTime.P50 } };
+		}
+		else
+		{
+			unsigned width = 0, height = 0;
+			std::vector<uint8_t> golden;
+			if (!ImageIO::ReadPPM((goldenDirectory / (testCase.Name + ".ppm")).string(), width, height, golden))
+			{
+				failures.push_back("no golden image (run with --update-golden)");
+			}
+			else if (width != record.Width || height != record.Height)
+			{
+				failures.push_back("golden is " + std::to_string(width) + "x" + std::to_string(height));
+			}
+			else
+			{
+				double psnr = ImageCompare::PSNR(golden.data(), record.Pixels.data(), width, height);
+				double ssim = ImageCompare::SSIM(golden.data(), record.Pixels.data(), width, height);
+				result["psnr"] = psnr;
+				result["ssim"] = ssim;
+
+				if (psnr < _settings.MinPSNR)
+					failures.push_back("psnr " + std::to_string(psnr));
+				if (ssim < _settings.MinSSIM)
+					failures.push_back("ssim " + std::to_string(ssim));
+
+				//Keep what we got and where it differs so the drift can be looked at
+				if (psnr < _settings.MinPSNR || ssim < _settings.MinSSIM)
+				{
+					std::vector<uint8_t> diff;
+					ImageCompare::MakeDiffImage(golden.data(), record.Pixels.data(), width, height, diff);
+					ImageIO::WritePPM((outputDirectory / (testCase.Name + "_actual.ppm")).string(), width, height, record.Pixels.data(), false);
+					ImageIO::WritePPM((outputDirectory / (testCase.Name + "_diff.ppm")).string(), width, height, diff.data(), false);
+				}
+			}
+
+			//Timing gates, only once there's something to compare against
+			if (baseline.contains(testCase.Name))
+			{
+				float baseGpu = baseline[testCase.Name].value("gpu_ms", 0.0f);
+				float baseCpu = baseline[testCase.Name].value("cpu_ms", 0.0f);
+				result["baseline_gpu_ms"] = baseGpu;
+				result["baseline_cpu_ms"] = baseCpu;
+
+				if (!gpu.empty() && gpuTime.P50 > baseGpu * (1.0f + _settings.TimeTolerance) && gpuTime.P50 - baseGpu > _settings.TimeSlack)
+					failures.push_back("gpu time " + std::to_string(gpuTime.P50) + " ms (was " + std::to_string(baseGpu) + " ms)");
+				if (cpuTime.P50 > baseCpu * (1.0f + _settings.TimeTolerance) && cpuTime.P50 - baseCpu > _settings.TimeSlack)
+					failures.push_back("cpu time " + std::to_string(cpuTime.P50) + " ms (was " + std::to_string(baseCpu) + " ms)");
+			}
+		}
+
+		result["passed"] = failures.empty();
+		result["failures"] = failures;
+		results["cases"].push_back(result);
+
+		if (failures.empty())
+		{
+			printf("[PASS] %-20s gpu %.3f ms  cpu %.3f ms\n", testCase.Name.c_str(), gpuTime.P50, cpuTime.P50);
+		}
+		else
+		{
+			passed = false;
+			printf("[FAIL] %-20s", testCase.Name.c_str());
+			for (const std::string& failure : failures)
+				printf(" %s;", failure.c_str());
+			printf("\n");
+		}
+	}
+
+	if (_settings.Update)
+	{
+		std::ofstream file(goldenDirectory / "timings.json");
+		file << newBaseline.dump(4);
+		printf("Updated goldens in %s\n", goldenDirectory.string().c_str());
+	}
+
+	results["passed"] = passed;
+	std::ofstream file(outputDirectory / "results.json");
+	file << results.dump(4);
+
+	return passed;
+}
+
+std::vector<GoldenImageTest::Case> GoldenImageTest::DefaultCases()
+{
+	//Effect indices match the order the effects are added in main
+	return {
+		{ "scene_front", glm::vec3(3.0f, 3.0f, 3.0f), glm::vec3(0.0f), Output::Scene, -1 },
+		{ "scene_top", glm::vec3(0.5f, 0.0f, 9.0f), glm::vec3(0.0f), Output::Scene, -1 },
+		{ "greyscale", glm::vec3(3.0f, 3.0f, 3.0f), glm::vec3(0.0f), Output::Effect, 0 },
+		{ "sepia", glm::vec3(3.0f, 3.0f, 3.0f), glm::vec3(0.0f), Output::Effect, 1 },
+		{ "bloom", glm::vec3(3.0f, 3.0f, 3.0f), glm::vec3(0.0f), Output::Effect, 2 },
+		{ "colour_correction", glm::vec3(3.0f, 3.0f, 3.0f), glm::vec3(0.0f), Output::ColourCorrection, -1 }
+	};
+}
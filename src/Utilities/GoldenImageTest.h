@@ -0,0 +1,97 @@
+#pragma once
+#include <GLM/glm.hpp>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Utilities/FrameStats.h"
+
+//Renders fixed views of the scene and compares them against stored golden images
+//*Each case is held for some warmup frames and then some timed frames, and the last frame is captured.
+//*A run fails if an image drifts past the PSNR/SSIM limits, or if the GPU time goes past the stored timing by more than the tolerance
+class GoldenImageTest
+{
+public:
+	//What to capture for a case
+	enum class Output
+	{
+		//The scene buffer, before any post effect
+		Scene,
+		//A post effect (Case::Effect is the index into the effect list)
+		Effect,
+		//The scene after the LUT colour correction
+		ColourCorrection
+	};
+
+	//A single view to check
+	struct Case
+	{
+		std::string Name;
+		glm::vec3 CameraPosition;
+		glm::vec3 CameraTarget;
+		Output Source;
+		int Effect;
+	};
+
+	struct Settings
+	{
+		//Folder the golden images and timings live in
+		std::string Directory = "golden";
+		//Folder the results (and the images of failed cases) get written to
+		std::string OutputDirectory = "golden_results";
+		//Writes new goldens instead of comparing against them
+		bool Update = false;
+		//Lowest PSNR (dB) and SSIM an image can have before it counts as drift
+		double MinPSNR = 40.0;
+		double MinSSIM = 0.98;
+		//How much slower (as a fraction) the GPU time can be than the stored timing
+		float TimeTolerance = 0.25f;
+		//Timing changes under this (in ms) are ignored, they're just noise
+		float TimeSlack = 0.1f;
+		int WarmupFrames = 10;
+		int MeasuredFrames = 30;
+	};
+
+	GoldenImageTest(const std::vector<Case>& cases, const Settings& settings);
+
+	//Checks every case has a golden image and a stored timing to compare against, missing gets the names of those that don't
+	bool FindGoldens(std::vector<std::string>& missing) const;
+
+	//Called whenever a new case starts, this should point the camera and pick the output
+	std::function<void(const Case&)> SetupCase;
+
+	//Call at the top of the frame with the frame number FrameStats is about to record
+	//*Returns false once every case has been rendered
+	bool BeginFrame(uint64_t frameNumber);
+	//Is this the frame that should be captured (it comes after the timed frames, so the readback isn't timed)
+	bool IsCaptureFrame() const;
+	//Hands over the captured frame (RGBA8, bottom row first like glReadPixels)
+	void Capture(std::vector<uint8_t>& pixels, unsigned width, unsigned height);
+	void EndFrame();
+
+	//Compares everything, writes results.json to the output folder and prints a summary
+	//*Returns true if every case passed (or the goldens were updated)
+	bool Finish(const FrameStats& stats);
+
+	//The fixed views (two of the scene, then greyscale, sepia, bloom and colour correction)
+	static std::vector<Case> DefaultCases();
+
+private:
+	//What we got for a case
+	struct CaseRecord
+	{
+		uint64_t FirstFrame = 0;
+		uint64_t EndFrame = 0;
+		unsigned Width = 0;
+		unsigned Height = 0;
+		std::vector<uint8_t> Pixels;
+	};
+
+
+	std::vector<Case> _cases;
+	std::vector<CaseRecord> _records;
+	Settings _settings;
+
+	int _currentCase = -1;
+	int _caseFrame = 0;
+};
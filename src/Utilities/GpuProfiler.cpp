@@ -0,0 +1,340 @@
+#include "GpuProfiler.h"
+
+#include <Logging.h>
+#include "imgui.h"
+
+bool GpuProfiler::Enabled = true;
+
+GpuProfiler::FrameRecord GpuProfiler::_frames[GpuProfiler::FRAME_LATENCY];
+int GpuProfiler::_currentFrame = 0;
+uint64_t GpuProfiler::_frameNumber = 0;
+bool GpuProfiler::_isInit = false;
+bool GpuProfiler::_inFrame = false;
+
+std::vector<GpuProfiler::PassResult> GpuProfiler::_lastResults;
+std::vector<GpuProfiler::FrameResult> GpuProfiler::_collectedFrames;
+float GpuProfiler::_lastFrameTime = 0.0f;
+uint64_t GpuProfiler::_lastFrameNumber = 0;
+uint64_t GpuProfiler::_droppedFrames = 0;
+
+std::vector<GpuProfiler::PassResult> GpuProfiler::_smoothedResults;
+float GpuProfiler::_smoothedFrameTime = 0.0f;
+
+std::ofstream GpuProfiler::_csv;
+
+GpuProfiler::Scope::Scope(const char* name)
+{
+	BeginPass(name);
+}
+
+GpuProfiler::Scope::~Scope()
+{
+	EndPass();
+}
+
+void GpuProfiler::Init()
+{
+	if (_isInit)
+		return;
+
+	//Generate all the queries up front so we never create them mid frame
+	for (int i = 0; i < FRAME_LATENCY; i++)
+	{
+		glGenQueries(MAX_PASSES * 2 + 2, _frames[i].Queries);
+		_frames[i].Passes.reserve(MAX_PASSES);
+		_frames[i].OpenPasses.reserve(MAX_PASSES);
+	}
+
+	_isInit = true;
+}
+
+void GpuProfiler::Shutdown()
+{
+	if (!_isInit)
+		return;
+
+	for (int i = 0; i < FRAME_LATENCY; i++)
+	{
+		glDeleteQueries(MAX_PASSES * 2 + 2, _frames[i].Queries);
+		_frames[i] = FrameRecord();
+	}
+
+	StopCsv();
+	_isInit = false;
+}
+
+void GpuProfiler::BeginFrame()
+{
+	//Frames are always counted, so frame numbers line up with the rest of the app even when disabled
+	uint64_t frameNumber = _frameNumber++;
+	_collectedFrames.clear();
+
+	if (!_isInit || !Enabled)
+		return;
+
+	//Collect every frame that is ready, oldest first, so the latest results win
+	//*Stop at the first one that isn't, so a newer frame never comes out before an older one (the csv stays in frame order)
+	for (int i = 0; i < FRAME_LATENCY; i++)
+	{
+		FrameRecord& frame = _frames[(_currentFrame + i) % FRAME_LATENCY];
+		if (frame.Pending && !Collect(frame))
+			break;
+	}
+
+	//If the slot we're about to reuse still isn't done we give up on it instead of waiting
+	FrameRecord& frame = _frames[_currentFrame];
+	if (frame.Pending)
+	{
+		frame.Pending = false;
+		_droppedFrames++;
+	}
+
+	frame.QueryCount = 0;
+	frame.Passes.clear();
+	frame.OpenPasses.clear();
+	frame.FrameNumber = frameNumber;
+
+	Timestamp(frame);
+	_inFrame = true;
+}
+
+void GpuProfiler::EndFrame()
+{
+	if (!_inFrame)
+		return;
+
+	FrameRecord& frame = _frames[_currentFrame];
+
+	//Close anything that was left open
+	while (!frame.OpenPasses.empty())
+		EndPass();
+
+	Timestamp(frame);
+	frame.Pending = true;
+
+	_currentFrame = (_currentFrame + 1) % FRAME_LATENCY;
+	_inFrame = false;
+}
+
+void GpuProfiler::BeginPass(const char* name)
+{
+	if (!_inFrame)
+		return;
+
+	FrameRecord& frame = _frames[_currentFrame];
+	if (int(frame.Passes.size()) >= MAX_PASSES)
+	{
+		//Still track it as open so the matching EndPass lines up
+		frame.OpenPasses.push_back(-1);
+		return;
+	}
+
+	PassRecord pass;
+	pass.Name = name;
+	pass.Depth = int(frame.OpenPasses.size());
+	pass.BeginQuery = Timestamp(frame);
+	pass.EndQuery = -1;
+
+	frame.OpenPasses.push_back(int(frame.Passes.size()));
+	frame.Passes.push_back(pass);
+}
+
+void GpuProfiler::EndPass()
+{
+	if (!_inFrame)
+		return;
+
+	FrameRecord& frame = _frames[_currentFrame];
+	if (frame.OpenPasses.empty())
+		return;
+
+	int index = frame.OpenPasses.back();
+	frame.OpenPasses.pop_back();
+
+	if (index >= 0)
+		frame.Passes[index].EndQuery = Timestamp(frame);
+}
+
+int GpuProfiler::Timestamp(FrameRecord& frame)
+{
+	int index = frame.QueryCount++;
+	glQueryCounter(frame.Queries[index], GL_TIMESTAMP);
+	return index;
+}
+
+bool GpuProfiler::Collect(FrameRecord& frame)
+{
+	//The last query finishes last, so if it's ready they all are
+	GLint available = 0;
+	glGetQueryObjectiv(frame.Queries[frame.QueryCount - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+		return false;
+
+	GLuint64 timestamps[MAX_PASSES * 2 + 2];
+	for (int i = 0; i < frame.QueryCount; i++)
+	{
+		glGetQueryObjectui64v(frame.Queries[i], GL_QUERY_RESULT, &timestamps[i]);
+	}
+
+	_lastResults.clear();
+	for (const PassRecord& pass : frame.Passes)
+	{
+		PassResult result;
+		result.Name = pass.Name;
+		result.Depth = pass.Depth;
+		result.Time = float(double(timestamps[pass.EndQuery] - timestamps[pass.BeginQuery]) / 1000000.0);
+		_lastResults.push_back(result);
+	}
+	_lastFrameTime = float(double(timestamps[frame.QueryCount - 1] - timestamps[0]) / 1000000.0);
+	_lastFrameNumber = frame.FrameNumber;
+	_collectedFrames.push_back({ frame.FrameNumber, _lastFrameTime });
+	frame.Pending = false;
+
+	//If the passes changed, start the smoothing over
+	bool samePasses = _smoothedResults.size() == _lastResults.size();
+	for (size_t i = 0; samePasses && i < _lastResults.size(); i++)
+	{
+		samePasses = _smoothedResults[i].Name == _lastResults[i].Name;
+	}
+	if (!samePasses)
+	{
+		_smoothedResults = _lastResults;
+		_smoothedFrameTime = _lastFrameTime;
+	}
+	else
+	{
+		for (size_t i = 0; i < _lastResults.size(); i++)
+		{
+			_smoothedResults[i].Time = _smoothedResults[i].Time * 0.9f + _lastResults[i].Time * 0.1f;
+		}
+		_smoothedFrameTime = _smoothedFrameTime * 0.9f + _lastFrameTime * 0.1f;
+	}
+
+	if (_csv.is_open())
+		WriteCsv();
+
+	return true;
+}
+
+bool GpuProfiler::StartCsv(const std::string& path)
+{
+	StopCsv();
+
+	_csv.open(path, std::ios::out | std::ios::trunc);
+	if (!_csv.is_open())
+	{
+		LOG_ERROR("Failed to open GPU timing csv {}", path);
+		return false;
+	}
+
+	//One row per pass keeps the file valid even when passes come and go
+	_csv << "frame,pass,depth,gpu_ms\n";
+	return true;
+}
+
+void GpuProfiler::StopCsv()
+{
+	if (_csv.is_open())
+		_csv.close();
+}
+
+bool GpuProfiler::IsWritingCsv()
+{
+	return _csv.is_open();
+}
+
+void GpuProfiler::WriteCsv()
+{
+	_csv << _lastFrameNumber << ",Frame,-1," << _lastFrameTime << "\n";
+	for (const PassResult& result : _lastResults)
+	{
+		_csv << _lastFrameNumber << "," << result.Name << "," << result.Depth << "," << result.Time << "\n";
+	}
+}
+
+void GpuProfiler::RenderImGui()
+{
+	if (!ImGui::CollapsingHeader("GPU Timings"))
+		return;
+
+	ImGui::Checkbox("Enable GPU Timers", &Enabled);
+
+	bool writeCsv = IsWritingCsv();
+	if (ImGui::Checkbox("Write CSV (gpu_timings.csv)", &writeCsv))
+	{
+		if (writeCsv)
+			StartCsv("gpu_timings.csv");
+		else
+			StopCsv();
+	}
+
+	ImGui::Text("GPU Frame: %.3f ms (dropped %llu)", _smoothedFrameTime, (unsigned long long)_droppedFrames);
+
+	//The bar is scaled to a 60hz frame, or the frame itself if it's longer
+	float scale = _smoothedFrameTime > 16.667f ? _smoothedFrameTime : 16.667f;
+	float barWidth = ImGui::GetContentRegionAvail().x;
+	float barHeight = 20.0f;
+
+	static const ImU32 colours[] = {
+		IM_COL32(230, 97, 1, 255), IM_COL32(253, 184, 99, 255), IM_COL32(178, 171, 210, 255),
+		IM_COL32(94, 60, 153, 255), IM_COL32(27, 158, 119, 255), IM_COL32(217, 95, 2, 255),
+		IM_COL32(117, 112, 179, 255), IM_COL32(231, 41, 138, 255)
+	};
+	const int numColours = sizeof(colours) / sizeof(colours[0]);
+
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+	ImVec2 start = ImGui::GetCursorScreenPos();
+	float x = start.x;
+
+	//Only the top level passes go in the bar, nested ones would be counted twice
+	for (size_t i = 0; i < _smoothedResults.size(); i++)
+	{
+		if (_smoothedResults[i].Depth != 0)
+			continue;
+
+		float width = (_smoothedResults[i].Time / scale) * barWidth;
+		drawList->AddRectFilled(ImVec2(x, start.y), ImVec2(x + width, start.y + barHeight), colours[i % numColours]);
+		x += width;
+	}
+	drawList->AddRect(start, ImVec2(start.x + barWidth, start.y + barHeight), IM_COL32(255, 255, 255, 128));
+	ImGui::Dummy(ImVec2(barWidth, barHeight));
+
+	//Legend
+	for (size_t i = 0; i < _smoothedResults.size(); i++)
+	{
+		const PassResult& result = _smoothedResults[i];
+		if (result.Depth == 0)
+		{
+			ImVec2 swatch = ImGui::GetCursorScreenPos();
+			drawList->AddRectFilled(swatch, ImVec2(swatch.x + 10.0f, swatch.y + 10.0f), colours[i % numColours]);
+			ImGui::Dummy(ImVec2(10.0f, 10.0f));
+			ImGui::SameLine();
+		}
+		ImGui::Text("%*s%s: %.3f ms", result.Depth * 2, "", result.Name, result.Time);
+	}
+}
+
+const std::vector<GpuProfiler::PassResult>& GpuProfiler::GetLastResults()
+{
+	return _lastResults;
+}
+
+float GpuProfiler::GetLastFrameTime()
+{
+	return _lastFrameTime;
+}
+
+uint64_t GpuProfiler::GetLastFrameNumber()
+{
+	return _lastFrameNumber;
+}
+
+const std::vector<GpuProfiler::FrameResult>& GpuProfiler::GetCollectedFrames()
+{
+	return _collectedFrames;
+}
+
+uint64_t GpuProfiler::GetDroppedFrames()
+{
+	return _droppedFrames;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+//Times sections of the frame on the GPU using timestamp queries
+//*Queries are kept in a ring a few frames deep, so results are read back
+//*once the GPU is done with them instead of stalling the pipeline
+class GpuProfiler abstract
+{
+public:
+	//The timing of a single pass, once its results come back
+	struct PassResult
+	{
+		//Pass names are expected to be string literals (they aren't copied)
+		const char* Name;
+		//How deep the pass is nested (0 is a top level pass)
+		int Depth;
+		//Time the GPU spent on the pass (in ms)
+		float Time;
+	};
+
+	//The total GPU time of a frame
+	struct FrameResult
+	{
+		uint64_t Frame;
+		float Time;
+	};
+
+	//Marks a pass for the lifetime of the scope
+	struct Scope
+	{
+		Scope(const char* name);
+		~Scope();
+	};
+
+	//Creates the query ring
+	static void Init();
+	//Deletes the queries and closes the csv (if open)
+	static void Shutdown();
+
+	//Starts and ends the frame, call these around all the rendering
+	//*BeginFrame also collects the results of old frames
+	static void BeginFrame();
+	static void EndFrame();
+
+	//Starts and ends a pass, these can be nested
+	static void BeginPass(const char* name);
+	static void EndPass();
+
+	//Starts writing a row per pass, per frame to a csv file
+	static bool StartCsv(const std::string& path);
+	static void StopCsv();
+	static bool IsWritingCsv();
+
+	//Draws the breakdown as a stacked bar (call inside an ImGui window)
+	static void RenderImGui();
+
+	//Getters for the most recent frame that finished
+	static const std::vector<PassResult>& GetLastResults();
+	static float GetLastFrameTime();
+	static uint64_t GetLastFrameNumber();
+	//Every frame whose results came back during the last BeginFrame (oldest first)
+	static const std::vector<FrameResult>& GetCollectedFrames();
+	//How many frames' results were thrown away because the GPU hadn't finished them
+	static uint64_t GetDroppedFrames();
+
+	//Can be turned off to skip all the queries
+	static bool Enabled;
+
+private:
+	//How many frames of queries we keep in flight
+	static const int FRAME_LATENCY = 4;
+	//Maximum passes per frame
+	static const int MAX_PASSES = 64;
+
+	//A single pass as it was recorded
+	struct PassRecord
+	{
+		const char* Name;
+		int Depth;
+		//Index into the frame's queries for the start and end timestamps
+		int BeginQuery;
+		int EndQuery;
+	};
+
+	//Everything recorded during one frame
+	struct FrameRecord
+	{
+		//Two per pass, plus the start and end of the frame
+		GLuint Queries[MAX_PASSES * 2 + 2];
+		int QueryCount = 0;
+		std::vector<PassRecord> Passes;
+		std::vector<int> OpenPasses;
+		uint64_t FrameNumber = 0;
+		bool Pending = false;
+	};
+
+	//Pushes a timestamp and returns the index of its query
+	static int Timestamp(FrameRecord& frame);
+	//Reads back the frame if it's done, returns false if it isn't
+	static bool Collect(FrameRecord& frame);
+	//Writes the latest results to the csv
+	static void WriteCsv();
+
+	static FrameRecord _frames[FRAME_LATENCY];
+	static int _currentFrame;
+	static uint64_t _frameNumber;
+	static bool _isInit;
+	static bool _inFrame;
+
+	static std::vector<PassResult> _lastResults;
+	static std::vector<FrameResult> _collectedFrames;
+	static float _lastFrameTime;
+	static uint64_t _lastFrameNumber;
+	static uint64_t _droppedFrames;
+
+	//Smoothed times for the display so it doesn't flicker
+	static std::vector<PassResult> _smoothedResults;
+	static float _smoothedFrameTime;
+
+	static std::ofstream _csv;
+};
@@ -0,0 +1,96 @@
+#include "ImageCompare.h"
+
+#include <algorithm>
+#include <cmath>
+
+double ImageCompare::PSNR(const uint8_t* a, const uint8_t* b, unsigned width, unsigned height)
+{
+	size_t pixels = size_t(width) * height;
+	double errorSum = 0.0;
+	for (size_t i = 0; i < pixels; i++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			double error = double(a[i * 4 + c]) - double(b[i * 4 + c]);
+			errorSum += error * error;
+		}
+	}
+
+	if (errorSum == 0.0)
+		return PERFECT_PSNR;
+
+	double meanError = errorSum / (pixels * 3);
+	return std::min(10.0 * std::log10(255.0 * 255.0 / meanError), PERFECT_PSNR);
+}
+
+double ImageCompare::SSIM(const uint8_t* a, const uint8_t* b, unsigned width, unsigned height)
+{
+	const int window = 8;
+	const int step = 4;
+	//The usual stabilising constants, (0.01 * 255)^2 and (0.03 * 255)^2
+	const double c1 = 6.5025;
+	const double c2 = 58.5225;
+
+	//Work on the luma
+	size_t pixels = size_t(width) * height;
+	std::vector<float> lumaA(pixels), lumaB(pixels);
+	for (size_t i = 0; i < pixels; i++)
+	{
+		lumaA[i] = 0.299f * a[i * 4] + 0.587f * a[i * 4 + 1] + 0.114f * a[i * 4 + 2];
+		lumaB[i] = 0.299f * b[i * 4] + 0.587f * b[i * 4 + 1] + 0.114f * b[i * 4 + 2];
+	}
+
+	if (width < unsigned(window) || height < unsigned(window))
+		return PSNR(a, b, width, height) >= PERFECT_PSNR ? 1.0 : 0.0;
+
+	double total = 0.0;
+	int windows = 0;
+	const double count = window * window;
+	for (unsigned y = 0; y + window <= height; y += step)
+	{
+		for (unsigned x = 0; x + window <= width; x += step)
+		{
+			double sumA = 0.0, sumB = 0.0, sumAA = 0.0, sumBB = 0.0, sumAB = 0.0;
+			for (int wy = 0; wy < window; wy++)
+			{
+				size_t row = size_t(y + wy) * width + x;
+				for (int wx = 0; wx < window; wx++)
+				{
+					double valueA = lumaA[row + wx];
+					double valueB = lumaB[row + wx];
+					sumA += valueA;
+					sumB += valueB;
+					sumAA += valueA * valueA;
+					sumBB += valueB * valueB;
+					sumAB += valueA * valueB;
+				}
+			}
+
+			double meanA = sumA / count, meanB = sumB / count;
+			double varianceA = sumAA / count - meanA * meanA;
+			double varianceB = sumBB / count - meanB * meanB;
+			double covariance = sumAB / count - meanA * meanB;
+
+			total += ((2.0 * meanA * meanB + c1) * (2.0 * covariance + c2)) /
+				((meanA * meanA + meanB * meanB + c1) * (varianceA + varianceB + c2));
+			windows++;
+		}
+	}
+
+	return total / windows;
+}
+
+void ImageCompare::MakeDiffImage(const uint8_t* a, const uint8_t* b, unsigned width, unsigned height, std::vector<uint8_t>& diff, int scale)
+{
+	size_t pixels = size_t(width) * height;
+	diff.resize(pixels * 4);
+	for (size_t i = 0; i < pixels; i++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			int difference = std::abs(int(a[i * 4 + c]) - int(b[i * 4 + c])) * scale;
+			diff[i * 4 + c] = uint8_t(std::min(difference, 255));
+		}
+		diff[i * 4 + 3] = 255;
+	}
+}
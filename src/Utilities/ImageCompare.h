@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+//Compares two RGBA8 images of the same size (alpha is ignored)
+namespace ImageCompare
+{
+	//Peak signal to noise ratio over the RGB channels, in dB
+	//*Identical images return PERFECT_PSNR instead of infinity so the result can go in json
+	double PSNR(const uint8_t* a, const uint8_t* b, unsigned width, unsigned height);
+	const double PERFECT_PSNR = 100.0;
+
+	//Mean structural similarity of the luma, over 8x8 windows that step 4 pixels (1 is identical)
+	double SSIM(const uint8_t* a, const uint8_t* b, unsigned width, unsigned height);
+
+	//Makes an image of the absolute differences, scaled up so small drift is visible
+	void MakeDiffImage(const uint8_t* a, const uint8_t* b, unsigned width, unsigned height, std::vector<uint8_t>& diff, int scale = 8);
+}
@@ -0,0 +1,78 @@
+#include "ImageIO.h"
+
+#include <algorithm>
+#include <fstream>
+
+bool ImageIO::WritePPM(const std::string& path, unsigned width, unsigned height, const uint8_t* rgba, bool flipY)
+{
+	std::ofstream file(path, std::ios::out | std::ios::binary);
+	if (!file.is_open())
+	{
+		printf("Failed to open %s for writing\n", path.c_str());
+		return false;
+	}
+
+	file << "P6\n" << width << " " << height << "\n255\n";
+
+	//Strip the alpha a row at a time
+	std::vector<uint8_t> row(width * 3);
+	for (unsigned y = 0; y < height; y++)
+	{
+		unsigned sourceRow = flipY ? height - 1 - y : y;
+		const uint8_t* source = rgba + size_t(sourceRow) * width * 4;
+		for (unsigned x = 0; x < width; x++)
+		{
+			row[x * 3 + 0] = source[x * 4 + 0];
+			row[x * 3 + 1] = source[x * 4 + 1];
+			row[x * 3 + 2] = source[x * 4 + 2];
+		}
+		file.write(reinterpret_cast<const char*>(row.data()), row.size());
+	}
+
+	return file.good();
+}
+
+bool ImageIO::ReadPPM(const std::string& path, unsigned& width, unsigned& height, std::vector<uint8_t>& rgba)
+{
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	std::string magic;
+	unsigned maxValue = 0;
+	file >> magic >> width >> height >> maxValue;
+	//Skip the single whitespace before the pixel data
+	file.get();
+
+	if (magic != "P6" || maxValue != 255 || width == 0 || height == 0)
+	{
+		printf("%s is not a binary 8 bit PPM\n", path.c_str());
+		return false;
+	}
+
+	std::vector<uint8_t> rgb(size_t(width) * height * 3);
+	file.read(reinterpret_cast<char*>(rgb.data()), rgb.size());
+	if (!file)
+		return false;
+
+	rgba.resize(size_t(width) * height * 4);
+	for (size_t i = 0; i < size_t(width) * height; i++)
+	{
+		rgba[i * 4 + 0] = rgb[i * 3 + 0];
+		rgba[i * 4 + 1] = rgb[i * 3 + 1];
+		rgba[i * 4 + 2] = rgb[i * 3 + 2];
+		rgba[i * 4 + 3] = 255;
+	}
+
+	return true;
+}
+
+void ImageIO::FlipRows(std::vector<uint8_t>& rgba, unsigned width, unsigned height)
+{
+	size_t rowSize = size_t(width) * 4;
+	for (unsigned y = 0; y < height / 2; y++)
+	{
+		std::swap_ranges(rgba.begin() + y * rowSize, rgba.begin() + (y + 1) * rowSize,
+			rgba.begin() + (height - 1 - y) * rowSize);
+	}
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ImageIO
+{
+	//Writes RGBA8 pixels out as a binary PPM (alpha is dropped)
+	//*flipY writes the rows bottom up, which is what glReadPixels gives us
+	bool WritePPM(const std::string& path, unsigned width, unsigned height, const uint8_t* rgba, bool flipY = true);
+
+	//Reads a binary PPM into RGBA8 pixels (alpha is set to 255)
+	bool ReadPPM(const std::string& path, unsigned& width, unsigned& height, std::vector<uint8_t>& rgba);
+
+	//Flips RGBA8 pixels upside down in place (to go between GL's bottom up rows and top down files)
+	void FlipRows(std::vector<uint8_t>& rgba, unsigned width, unsigned height);
+}
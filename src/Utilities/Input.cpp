@@ -0,0 +1,282 @@
+#include "Input.h"
+
+#include <algorithm>
+#include <Logging.h>
+
+const int Input::TRACKED_KEYS[] = {
+	GLFW_KEY_W, GLFW_KEY_A, GLFW_KEY_S, GLFW_KEY_D,
+	GLFW_KEY_Q, GLFW_KEY_E, GLFW_KEY_T, GLFW_KEY_Y,
+	GLFW_KEY_SPACE, GLFW_KEY_LEFT_CONTROL, GLFW_KEY_LEFT_SHIFT,
+	GLFW_KEY_UP, GLFW_KEY_DOWN, GLFW_KEY_LEFT, GLFW_KEY_RIGHT,
+	GLFW_KEY_KP_ADD, GLFW_KEY_KP_SUBTRACT, GLFW_KEY_ESCAPE
+};
+const int Input::TRACKED_KEY_COUNT = sizeof(TRACKED_KEYS) / sizeof(TRACKED_KEYS[0]);
+
+Input::FrameState Input::_current;
+Input::FrameState Input::_previous;
+
+std::ofstream Input::_recording;
+uint32_t Input::_recordedFrames = 0;
+std::ifstream Input::_replay;
+uint32_t Input::_replaySeed = 0;
+uint32_t Input::_replayFrames = 0;
+uint32_t Input::_replayedFrames = 0;
+
+namespace
+{
+	//File layout: header, then a frame record per frame
+	const char MAGIC[4] = { 'C', 'G', 'I', 'R' };
+	const uint32_t VERSION = 1;
+	//The frame count sits after the magic, version and seed
+	const std::streamoff FRAME_COUNT_OFFSET = 12;
+
+	//Frames only store what changed since the frame before
+	enum FrameFlags : uint8_t
+	{
+		KEYS_CHANGED = 1 << 0,
+		BUTTONS_CHANGED = 1 << 1,
+		CURSOR_CHANGED = 1 << 2,
+		UI_FOCUSED = 1 << 3
+	};
+
+	template <typename T>
+	void Write(std::ofstream& stream, const T& value)
+	{
+		stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	bool Read(std::ifstream& stream, T& value)
+	{
+		return bool(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+	}
+}
+
+void Input::Update(GLFWwindow* window, float& deltaTime, bool uiFocused)
+{
+	_previous = _current;
+
+	if (IsReplaying())
+	{
+		//Once the recording runs out everything is let go
+		if (!ReadFrame(_current))
+		{
+			_current.Keys = 0;
+			_current.Buttons = 0;
+		}
+		deltaTime = _current.DeltaTime;
+		return;
+	}
+
+	PollLive(window, _current);
+	_current.DeltaTime = deltaTime;
+	_current.UIFocused = uiFocused;
+
+	if (IsRecording())
+		WriteFrame(_current);
+}
+
+bool Input::IsKeyDown(int key)
+{
+	int bit = GetKeyBit(key);
+	return bit >= 0 && (_current.Keys & (1u << bit)) != 0;
+}
+
+bool Input::WasKeyPressed(int key)
+{
+	int bit = GetKeyBit(key);
+	return bit >= 0 && (_current.Keys & (1u << bit)) != 0 && (_previous.Keys & (1u << bit)) == 0;
+}
+
+bool Input::IsMouseButtonDown(int button)
+{
+	return button >= 0 && button < 8 && (_current.Buttons & (1u << button)) != 0;
+}
+
+void Input::GetCursorPos(double& x, double& y)
+{
+	x = _current.CursorX;
+	y = _current.CursorY;
+}
+
+bool Input::IsUIFocused()
+{
+	return _current.UIFocused;
+}
+
+bool Input::StartRecording(const std::string& path, uint32_t seed)
+{
+	StopRecording();
+
+	_recording.open(path, std::ios::out | std::ios::binary);
+	if (!_recording.is_open())
+	{
+		LOG_ERROR("Failed to open {} for recording", path);
+		return false;
+	}
+
+	_recording.write(MAGIC, sizeof(MAGIC));
+	Write(_recording, VERSION);
+	Write(_recording, seed);
+	//Filled in when the recording stops
+	Write(_recording, uint32_t(0));
+	_recordedFrames = 0;
+
+	LOG_INFO("Recording input to {}", path);
+	return true;
+}
+
+void Input::StopRecording()
+{
+	if (!_recording.is_open())
+		return;
+
+	_recording.seekp(FRAME_COUNT_OFFSET);
+	Write(_recording, _recordedFrames);
+	_recording.close();
+	LOG_INFO("Recorded {} frames of input", _recordedFrames);
+}
+
+bool Input::IsRecording()
+{
+	return _recording.is_open();
+}
+
+bool Input::StartReplay(const std::string& path)
+{
+	StopReplay();
+
+	_replay.open(path, std::ios::in | std::ios::binary);
+	if (!_replay.is_open())
+	{
+		LOG_ERROR("Failed to open {} for replay", path);
+		return false;
+	}
+
+	char magic[4];
+	uint32_t version = 0;
+	_replay.read(magic, sizeof(magic));
+	if (!_replay || std::equal(magic, magic + 4, MAGIC) == false || !Read(_replay, version) || version != VERSION ||
+		!Read(_replay, _replaySeed) || !Read(_replay, _replayFrames))
+	{
+		LOG_ERROR("{} is not an input recording", path);
+		_replay.close();
+		return false;
+	}
+
+	_replayedFrames = 0;
+	_current = FrameState();
+	_previous = FrameState();
+
+	LOG_INFO("Replaying {} frames of input from {}", _replayFrames, path);
+	return true;
+}
+
+void Input::StopReplay()
+{
+	if (_replay.is_open())
+		_replay.close();
+}
+
+bool Input::IsReplaying()
+{
+	return _replay.is_open();
+}
+
+bool Input::IsReplayFinished()
+{
+	return !IsReplaying() || _replayedFrames >= _replayFrames;
+}
+
+uint32_t Input::GetReplaySeed()
+{
+	return _replaySeed;
+}
+
+uint32_t Input::GetReplayFrameCount()
+{
+	return _replayFrames;
+}
+
+void Input::PollLive(GLFWwindow* window, FrameState& state)
+{
+	state.Keys = 0;
+	state.Buttons = 0;
+	//No window means no input (when we're headless), the cursor stays where it was
+	if (window == nullptr)
+		return;
+
+	for (int i = 0; i < TRACKED_KEY_COUNT; i++)
+	{
+		if (glfwGetKey(window, TRACKED_KEYS[i]) == GLFW_PRESS)
+			state.Keys |= 1u << i;
+	}
+	for (int i = 0; i < 8; i++)
+	{
+		if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_1 + i) == GLFW_PRESS)
+			state.Buttons |= uint8_t(1u << i);
+	}
+	glfwGetCursorPos(window, &state.CursorX, &state.CursorY);
+}
+
+void Input::WriteFrame(const FrameState& state)
+{
+	uint8_t flags = 0;
+	if (state.Keys != _previous.Keys || _recordedFrames == 0)
+		flags |= KEYS_CHANGED;
+	if (state.Buttons != _previous.Buttons || _recordedFrames == 0)
+		flags |= BUTTONS_CHANGED;
+	if (state.CursorX != _previous.CursorX || state.CursorY != _previous.CursorY || _recordedFrames == 0)
+		flags |= CURSOR_CHANGED;
+	if (state.UIFocused)
+		flags |= UI_FOCUSED;
+
+	Write(_recording, flags);
+	Write(_recording, state.DeltaTime);
+	if (flags & KEYS_CHANGED)
+		Write(_recording, state.Keys);
+	if (flags & BUTTONS_CHANGED)
+		Write(_recording, state.Buttons);
+	if (flags & CURSOR_CHANGED)
+	{
+		Write(_recording, state.CursorX);
+		Write(_recording, state.CursorY);
+	}
+	_recordedFrames++;
+}
+
+bool Input::ReadFrame(FrameState& state)
+{
+	if (_replayedFrames >= _replayFrames)
+		return false;
+
+	uint8_t flags = 0;
+	bool read = Read(_replay, flags) && Read(_replay, state.DeltaTime);
+	if (read && (flags & KEYS_CHANGED))
+		read = Read(_replay, state.Keys);
+	if (read && (flags & BUTTONS_CHANGED))
+		read = Read(_replay, state.Buttons);
+	if (read && (flags & CURSOR_CHANGED))
+		read = Read(_replay, state.CursorX) && Read(_replay, state.CursorY);
+	state.UIFocused = (flags & UI_FOCUSED) != 0;
+
+	if (!read)
+	{
+		LOG_ERROR("Input recording ended early after {} frames", _replayedFrames);
+		_replayFrames = _replayedFrames;
+		return false;
+	}
+
+	_replayedFrames++;
+	return true;
+}
+
+int Input::GetKeyBit(int key)
+{
+	for (int i = 0; i < TRACKED_KEY_COUNT; i++)
+	{
+		if (TRACKED_KEYS[i] == key)
+			return i;
+	}
+	return -1;
+}
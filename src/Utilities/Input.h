@@ -0,0 +1,75 @@
+#pragma once
+#include <GLFW/glfw3.h>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+//Keyboard and mouse state for the frame, polled once so it can be recorded and replayed
+//*Behaviours read input through here instead of asking GLFW, so a replay drives them the same way
+class Input abstract
+{
+public:
+	//Grabs this frame's input (from GLFW, or the next frame of a replay)
+	//*deltaTime is recorded, or replaced by the recorded one when replaying
+	//*uiFocused is whether ImGui has focus, game input is ignored while it does
+	static void Update(GLFWwindow* window, float& deltaTime, bool uiFocused = false);
+
+	//Key and mouse button state this frame (only the keys in TRACKED_KEYS are recorded)
+	static bool IsKeyDown(int key);
+	//Was the key pressed this frame (and not last frame)
+	static bool WasKeyPressed(int key);
+	static bool IsMouseButtonDown(int button);
+	static void GetCursorPos(double& x, double& y);
+	//Did ImGui have focus this frame
+	static bool IsUIFocused();
+
+	//Starts writing every frame's input and delta time to a file
+	//*seed is stored in the file so the replay can use the same one
+	static bool StartRecording(const std::string& path, uint32_t seed);
+	static void StopRecording();
+	static bool IsRecording();
+
+	//Starts feeding a recording back in place of the real input
+	static bool StartReplay(const std::string& path);
+	static void StopReplay();
+	static bool IsReplaying();
+	//Has every recorded frame been used
+	static bool IsReplayFinished();
+	//The seed and length of the recording being replayed
+	static uint32_t GetReplaySeed();
+	static uint32_t GetReplayFrameCount();
+
+	//Keys that get recorded (everything the app checks), up to 32 of them
+	static const int TRACKED_KEYS[];
+	static const int TRACKED_KEY_COUNT;
+
+private:
+	//Input for a single frame
+	struct FrameState
+	{
+		float DeltaTime = 0.0f;
+		//Bit per tracked key
+		uint32_t Keys = 0;
+		//Bit per mouse button
+		uint8_t Buttons = 0;
+		bool UIFocused = false;
+		double CursorX = 0.0;
+		double CursorY = 0.0;
+	};
+
+	//Reads GLFW into a frame
+	static void PollLive(GLFWwindow* window, FrameState& state);
+	static void WriteFrame(const FrameState& state);
+	static bool ReadFrame(FrameState& state);
+	static int GetKeyBit(int key);
+
+	static FrameState _current;
+	static FrameState _previous;
+
+	static std::ofstream _recording;
+	static uint32_t _recordedFrames;
+	static std::ifstream _replay;
+	static uint32_t _replaySeed;
+	static uint32_t _replayFrames;
+	static uint32_t _replayedFrames;
+};
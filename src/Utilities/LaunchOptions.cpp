@@ -0,0 +1,276 @@
+#include "LaunchOptions.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+LaunchOptions LaunchOptions::Parse(int argc, char** argv)
+{
+	LaunchOptions options;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		//Does this option have a value after it
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--headless")
+		{
+			options.Headless = true;
+		}
+		else if (arg == "--frames" && hasValue)
+		{
+			options.Frames = atoi(argv[++i]);
+		}
+		else if (arg == "--size" && hasValue)
+		{
+			//Expects WIDTHxHEIGHT
+			if (sscanf(argv[++i], "%dx%d", &options.Width, &options.Height) != 2)
+			{
+				printf("Size should look like 1280x720\n");
+				options.Valid = false;
+			}
+		}
+		else if (arg == "--output" && hasValue)
+		{
+			options.OutputDirectory = argv[++i];
+		}
+		else if (arg == "--readback" && hasValue)
+		{
+			options.Readback = argv[++i];
+			options.ForceReadback = true;
+			if (options.Readback != "async" && options.Readback != "sync")
+			{
+				printf("Readback should be async or sync\n");
+				options.Valid = false;
+			}
+		}
+		else if (arg == "--record" && hasValue)
+		{
+			options.RecordPath = argv[++i];
+		}
+		else if (arg == "--replay" && hasValue)
+		{
+			options.ReplayPath = argv[++i];
+		}
+		else if (arg == "--capture" && hasValue)
+		{
+			options.CapturePath = argv[++i];
+		}
+		else if (arg == "--capture-fps" && hasValue)
+		{
+			options.CaptureFps = atoi(argv[++i]);
+		}
+		else if (arg == "--capture-queue" && hasValue)
+		{
+			options.CaptureQueue = atoi(argv[++i]);
+		}
+		else if (arg == "--tick-rate" && hasValue)
+		{
+			options.TickRate = float(atof(argv[++i]));
+		}
+		else if (arg == "--gen-threads" && hasValue)
+		{
+			options.GenerationThreads = atoi(argv[++i]);
+		}
+		else if (arg == "--obj-threads" && hasValue)
+		{
+			options.ObjThreads = atoi(argv[++i]);
+		}
+		else if (arg == "--stream")
+		{
+			options.Stream = true;
+		}
+		else if (arg == "--terrain")
+		{
+			options.Terrain = true;
+		}
+		else if (arg == "--effect" && hasValue)
+		{
+			options.Effect = atoi(argv[++i]);
+		}
+		else if (arg == "--benchmark")
+		{
+			options.Benchmark = true;
+		}
+		else if (arg == "--windowed")
+		{
+			options.Windowed = true;
+		}
+		else if (arg == "--benchmark-output" && hasValue)
+		{
+			options.BenchmarkOutput = argv[++i];
+		}
+		else if (arg == "--scenes" && hasValue)
+		{
+			options.Scenes = argv[++i];
+		}
+		else if (arg == "--seed" && hasValue)
+		{
+			options.Seed = unsigned(strtoul(argv[++i], nullptr, 10));
+		}
+		else if (arg == "--microbench")
+		{
+			options.MicroBench = true;
+		}
+		else if (arg == "--microbench-filter" && hasValue)
+		{
+			options.MicroBenchFilter = argv[++i];
+		}
+		else if (arg == "--microbench-output" && hasValue)
+		{
+			options.MicroBenchOutput = argv[++i];
+		}
+		else if (arg == "--min-time" && hasValue)
+		{
+			options.MinTime = atof(argv[++i]);
+		}
+		else if (arg == "--repetitions" && hasValue)
+		{
+			options.Repetitions = atoi(argv[++i]);
+		}
+		else if (arg == "--mesh-report")
+		{
+			options.MeshReport = true;
+		}
+		else if (arg == "--mesh-report-output" && hasValue)
+		{
+			options.MeshReportOutput = argv[++i];
+		}
+		else if (arg == "--no-mesh-optimize")
+		{
+			options.NoMeshOptimize = true;
+		}
+		else if (arg == "--no-vertex-packing")
+		{
+			options.NoVertexPacking = true;
+		}
+		else if (arg == "--golden")
+		{
+			options.Golden = true;
+		}
+		else if (arg == "--update-golden")
+		{
+			options.Golden = true;
+			options.UpdateGolden = true;
+		}
+		else if (arg == "--golden-dir" && hasValue)
+		{
+			options.GoldenDirectory = argv[++i];
+		}
+		else if (arg == "--golden-output" && hasValue)
+		{
+			options.GoldenOutput = argv[++i];
+		}
+		else if (arg == "--psnr" && hasValue)
+		{
+			options.MinPSNR = atof(argv[++i]);
+		}
+		else if (arg == "--ssim" && hasValue)
+		{
+			options.MinSSIM = atof(argv[++i]);
+		}
+		else if (arg == "--time-tolerance" && hasValue)
+		{
+			options.TimeTolerance = float(atof(argv[++i]));
+		}
+		else
+		{
+			printf("Unknown option %s\n", arg.c_str());
+			options.Valid = false;
+		}
+	}
+
+	//Benchmarks default to headless so the window can't get in the way of the timings
+	if (options.Benchmark && !options.Windowed)
+		options.Headless = true;
+	//Golden images are always rendered offscreen, so the window size can't change them
+	if (options.Golden)
+		options.Headless = true;
+
+	if (options.Golden && options.Benchmark)
+	{
+		printf("Golden images and benchmarks can't run together\n");
+		options.Valid = false;
+	}
+
+	if (options.Frames <= 0 || options.Width <= 0 || options.Height <= 0)
+	{
+		printf("Frames and size need to be above zero\n");
+		options.Valid = false;
+	}
+
+	if (!options.RecordPath.empty() && !options.ReplayPath.empty())
+	{
+		printf("Can't record and replay at the same time\n");
+		options.Valid = false;
+	}
+
+	if (options.TickRate < 0.0f)
+	{
+		printf("Tick rate can't be negative\n");
+		options.Valid = false;
+	}
+
+	if (options.GenerationThreads < 0 || options.ObjThreads < 0)
+	{
+		printf("Generation and obj threads can't be negative\n");
+		options.Valid = false;
+	}
+
+	if (options.CaptureFps <= 0 || options.CaptureQueue <= 0)
+	{
+		printf("Capture fps and queue need to be above zero\n");
+		options.Valid = false;
+	}
+
+	if (options.MinTime <= 0.0 || options.Repetitions <= 0)
+	{
+		printf("Min time and repetitions need to be above zero\n");
+		options.Valid = false;
+	}
+
+	return options;
+}
+
+void LaunchOptions::PrintUsage()
+{
+	printf("Options:\n");
+	printf("  --headless          Render without a window (surfaceless EGL on linux)\n");
+	printf("  --frames N          Frames to render when headless (default 300)\n");
+	printf("  --size WxH          Framebuffer size when headless (default 1280x720)\n");
+	printf("  --output DIR        Write rendered frames to DIR as .ppm (otherwise discarded)\n");
+	printf("  --readback MODE     Read headless frames back with async (pixel buffers, default) or sync, even without --output\n");
+	printf("  --record FILE       Record each frame's input and delta time to FILE\n");
+	printf("  --replay FILE       Replay a recording (windowed or headless) instead of live input\n");
+	printf("  --capture FILE      Stream the final image to FILE (.y4m, or raw YUV420 for anything else)\n");
+	printf("  --capture-fps N     Frame rate written in the .y4m header (default 60)\n");
+	printf("  --capture-queue N   Frames that can wait on the disk before new ones are dropped (default 8)\n");
+	printf("  --tick-rate N       Simulation ticks per second, 0 ticks once a frame instead (default 60)\n");
+	printf("  --gen-threads N     Threads for placing generated props, 0 uses every core (default 0)\n");
+	printf("  --obj-threads N     Threads for reading .obj files, 0 uses every core and 1 is the single threaded reader (default 0)\n");
+	printf("  --stream            Stream a 4km wide prop world in chunks around the camera (ignored by --benchmark)\n");
+	printf("  --terrain           Put a generated heightmap terrain under the scene (ignored with --stream)\n");
+	printf("  --effect N          Post effect to use (0 greyscale, 1 sepia, 2 bloom)\n");
+	printf("  --benchmark         Run the scene benchmark suite (headless, --frames per scene)\n");
+	printf("  --windowed          Run the benchmark suite in a window instead\n");
+	printf("  --benchmark-output F  Benchmark results file (default benchmark_results.json)\n");
+	printf("  --scenes A,B        Only run these benchmark scenes (lego, props_1k, props_10k, props_100k, props_10k_baked, props_100k_baked, props_10k_instanced, props_100k_instanced, lego_lod, props_10k_lod, props_100k_lod, trees_100k_lod, trees_100k_impostors)\n");
+	printf("  --seed N            Seed for generated props (default 1234)\n");
+	printf("  --microbench        Run the CPU microbenchmarks (GL ones only run if a headless context can be made)\n");
+	printf("  --microbench-filter S  Only run microbenchmarks with S in their name\n");
+	printf("  --microbench-output F  Microbenchmark results file (default microbench_results.json)\n");
+	printf("  --min-time S        Minimum seconds per microbenchmark (default 0.5)\n");
+	printf("  --repetitions N     Times to repeat each microbenchmark, adds mean/median/stddev (default 1)\n");
+	printf("  --mesh-report       Print vertex counts and ACMR for every model before and after optimizing\n");
+	printf("  --mesh-report-output F  Mesh report file (default mesh_report.json)\n");
+	printf("  --no-mesh-optimize  Draw meshes in the order they were loaded in, without welding or reordering\n");
+	printf("  --no-vertex-packing Bake meshes with full float vertices instead of the smallest layout that fits\n");
+	printf("  --golden            Render the golden image views and compare them (exits with 1 on a failure)\n");
+	printf("  --update-golden     Write new golden images and timings instead of comparing\n");
+	printf("  --golden-dir DIR    Folder the goldens live in (default golden)\n");
+	printf("  --golden-output DIR Folder for results.json and images of failed cases (default golden_results)\n");
+	printf("  --psnr N            Lowest PSNR in dB before an image fails (default 40)\n");
+	printf("  --ssim N            Lowest SSIM before an image fails (default 0.98)\n");
+	printf("  --time-tolerance N  How much slower than the stored timings a case can get (default 0.25)\n");
+}
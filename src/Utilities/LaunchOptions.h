@@ -0,0 +1,93 @@
+#pragma once
+#include <string>
+
+//Options passed in on the command line
+struct LaunchOptions
+{
+	//Run with no window, rendering only into framebuffers
+	bool Headless = false;
+	//How many frames to render when headless (per scene when benchmarking)
+	int Frames = 300;
+	//Size of the framebuffers when headless
+	int Width = 1280;
+	int Height = 720;
+	//Folder to write the headless frames to (frames are discarded if this is empty)
+	std::string OutputDirectory;
+	//How headless frames are read back, "async" (pixel buffers) or "sync" (glReadPixels)
+	std::string Readback = "async";
+	//Read the frames back even without an output folder, so the readback can be measured on its own
+	bool ForceReadback = false;
+	//Records every frame's input and delta time to this file
+	std::string RecordPath;
+	//Replays a recording instead of taking live input (runs for as many frames as were recorded)
+	std::string ReplayPath;
+	//Video file to stream the final image to (.y4m, anything else is raw YUV420)
+	std::string CapturePath;
+	int CaptureFps = 60;
+	//Frames that can wait on the disk before new ones get dropped
+	int CaptureQueue = 8;
+	//Simulation ticks per second, 0 runs the behaviours once a frame with the frame time
+	float TickRate = 60.0f;
+	//Threads that work out where generated props go, 0 uses every core
+	int GenerationThreads = 0;
+	//Threads that read .obj files, 0 uses every core and 1 reads them the old way
+	int ObjThreads = 0;
+	//Stream a much bigger prop world in chunks around the camera instead of the small fixed one
+	bool Stream = false;
+	//Put a generated heightmap terrain under the scene, props stand on it
+	bool Terrain = false;
+	//Which post effect to use (-1 keeps the default)
+	int Effect = -1;
+
+	//Run the scene benchmark suite and quit
+	bool Benchmark = false;
+	//Benchmarks run headless unless this is set
+	bool Windowed = false;
+	//Where the benchmark results go
+	std::string BenchmarkOutput = "benchmark_results.json";
+	//Comma separated benchmark scenes to run (all of them if empty)
+	std::string Scenes;
+	//Seed for anything random, so runs are repeatable
+	unsigned Seed = 1234;
+
+	//Run the CPU microbenchmarks and quit
+	bool MicroBench = false;
+	//Only run microbenchmarks with this in their name
+	std::string MicroBenchFilter;
+	//Where the microbenchmark results go (Google Benchmark json)
+	std::string MicroBenchOutput = "microbench_results.json";
+	//Minimum time to run each microbenchmark for (in seconds)
+	double MinTime = 0.5;
+	//How many times to repeat each microbenchmark
+	int Repetitions = 1;
+
+	//Print and save vertex counts and cache stats for every model before and after optimizing, then quit
+	bool MeshReport = false;
+	//Where the mesh report goes
+	std::string MeshReportOutput = "mesh_report.json";
+	//Leave meshes in the order they were loaded in
+	bool NoMeshOptimize = false;
+	//Bake every mesh with full float vertices
+	bool NoVertexPacking = false;
+
+	//Render the golden image views and compare them against the stored ones
+	bool Golden = false;
+	//Write new golden images (and timings) instead of comparing
+	bool UpdateGolden = false;
+	//Where the golden images live, and where the results go
+	std::string GoldenDirectory = "golden";
+	std::string GoldenOutput = "golden_results";
+	//Lowest PSNR (dB) and SSIM before an image counts as changed
+	double MinPSNR = 40.0;
+	double MinSSIM = 0.98;
+	//How much slower than the stored timings a case can get (0.25 is 25%)
+	float TimeTolerance = 0.25f;
+
+	//Did everything parse
+	bool Valid = true;
+
+	//Reads the options from the command line
+	static LaunchOptions Parse(int argc, char** argv);
+	//Prints the available options
+	static void PrintUsage();
+};
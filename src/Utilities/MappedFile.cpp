@@ -0,0 +1,91 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& fileName)
+{
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return;
+	_file = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size))
+		return;
+	_size = size_t(size.QuadPart);
+	//Empty files can't be mapped, but there's nothing to read anyway
+	if (_size == 0)
+	{
+		_open = true;
+		return;
+	}
+
+	_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (_mapping == nullptr)
+		return;
+	_data = static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+	_open = _data != nullptr;
+#else
+	_file = open(fileName.c_str(), O_RDONLY);
+	if (_file < 0)
+		return;
+
+	struct stat info;
+	if (fstat(_file, &info) != 0)
+		return;
+	_size = size_t(info.st_size);
+	if (_size == 0)
+	{
+		_open = true;
+		return;
+	}
+
+	void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _file, 0);
+	if (data == MAP_FAILED)
+		return;
+	//The whole file gets read front to back, so ask for it to be read ahead
+	madvise(data, _size, MADV_SEQUENTIAL);
+	_data = static_cast<const char*>(data);
+	_open = true;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#if defined(_WIN32)
+	if (_data != nullptr)
+		UnmapViewOfFile(_data);
+	if (_mapping != nullptr)
+		CloseHandle(_mapping);
+	if (_file != nullptr)
+		CloseHandle(_file);
+#else
+	if (_data != nullptr)
+		munmap(const_cast<char*>(_data), _size);
+	if (_file >= 0)
+		close(_file);
+#endif
+}
+
+bool MappedFile::IsOpen() const
+{
+	return _open;
+}
+
+const char* MappedFile::GetData() const
+{
+	return _data;
+}
+
+size_t MappedFile::GetSize() const
+{
+	return _size;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+//A whole file mapped read only into memory, so it can be read (from any number of threads) without copying it
+//*Pages only get read from disk when something touches them
+class MappedFile
+{
+public:
+	explicit MappedFile(const std::string& fileName);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	//False if the file couldn't be opened or mapped
+	bool IsOpen() const;
+	//Not null terminated, and null for an empty file
+	const char* GetData() const;
+	size_t GetSize() const;
+
+private:
+	bool _open = false;
+	const char* _data = nullptr;
+	size_t _size = 0;
+#if defined(_WIN32)
+	void* _file = nullptr;
+	void* _mapping = nullptr;
+#else
+	int _file = -1;
+#endif
+};
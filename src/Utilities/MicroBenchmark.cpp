@@ -0,0 +1,313 @@
+#include "MicroBenchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <json.hpp>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+std::vector<MicroBenchmark::Benchmark> MicroBenchmark::_benchmarks;
+#if defined(_MSC_VER)
+const volatile char* MicroBenchmark::_sink = nullptr;
+#endif
+
+MicroBenchmark::State::State(int64_t iterations, const std::vector<int64_t>& args)
+{
+	_iterations = iterations;
+	_remaining = iterations;
+	_args = args;
+}
+
+bool MicroBenchmark::State::KeepRunning()
+{
+	//The first call starts the timer
+	if (!_started)
+	{
+		_started = true;
+		ResumeTiming();
+	}
+
+	if (_remaining > 0 && _error.empty())
+	{
+		_remaining--;
+		return true;
+	}
+
+	//And the last one stops it
+	if (_running)
+		PauseTiming();
+	return false;
+}
+
+void MicroBenchmark::State::PauseTiming()
+{
+	_realTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - _realStart).count();
+	_cpuTime += double(std::clock() - _cpuStart) / CLOCKS_PER_SEC;
+	_running = false;
+}
+
+void MicroBenchmark::State::ResumeTiming()
+{
+	_running = true;
+	_cpuStart = std::clock();
+	_realStart = std::chrono::steady_clock::now();
+}
+
+int64_t MicroBenchmark::State::Range(size_t index) const
+{
+	return index < _args.size() ? _args[index] : 0;
+}
+
+int64_t MicroBenchmark::State::Iterations() const
+{
+	return _iterations;
+}
+
+void MicroBenchmark::State::SetItemsProcessed(int64_t items)
+{
+	_items = items;
+}
+
+void MicroBenchmark::State::SetBytesProcessed(int64_t bytes)
+{
+	_bytes = bytes;
+}
+
+void MicroBenchmark::State::SkipWithError(const std::string& error)
+{
+	_error = error;
+}
+
+void MicroBenchmark::Register(const std::string& name, Function function, const std::vector<int64_t>& args, bool needsContext)
+{
+	_benchmarks.push_back({ name, function, args, needsContext });
+}
+
+void MicroBenchmark::ClobberMemory()
+{
+#if defined(_MSC_VER)
+	_ReadWriteBarrier();
+#else
+	asm volatile("" : : : "memory");
+#endif
+}
+
+std::vector<int64_t> MicroBenchmark::Range(int64_t start, int64_t end, int64_t multiplier)
+{
+	std::vector<int64_t> result;
+	for (int64_t i = start; i < end; i *= multiplier)
+		result.push_back(i);
+	result.push_back(end);
+	return result;
+}
+
+void MicroBenchmark::RunOnce(const Benchmark& benchmark, const std::vector<int64_t>& args, State& state)
+{
+	benchmark.Func(state);
+	//In case the benchmark returned without finishing the loop
+	if (state._running)
+		state.PauseTiming();
+}
+
+int MicroBenchmark::RunAll(const std::string& filter, const std::string& outputPath, bool hasContext, double minTime, int repetitions)
+{
+	std::vector<Run> runs;
+	nlohmann::json results = nlohmann::json::array();
+	repetitions = std::max(repetitions, 1);
+	bool failed = false;
+
+	printf("%-48s %14s %14s %12s\n", "Benchmark", "Time", "CPU", "Iterations");
+	printf("%s\n", std::string(91, '-').c_str());
+
+	for (const Benchmark& benchmark : _benchmarks)
+	{
+		//Benchmarks without arguments still run once
+		std::vector<std::vector<int64_t>> argSets;
+		for (int64_t arg : benchmark.Args)
+			argSets.push_back({ arg });
+		if (argSets.empty())
+			argSets.push_back({});
+
+		for (const std::vector<int64_t>& args : argSets)
+		{
+			std::string name = benchmark.Name;
+			for (int64_t arg : args)
+				name += "/" + std::to_string(arg);
+
+			if (name.find(filter) == std::string::npos)
+				continue;
+
+			if (benchmark.NeedsContext && !hasContext)
+			{
+				printf("%-48s skipped (needs a GL context)\n", name.c_str());
+				continue;
+			}
+
+			//Keep growing the iterations until a run takes long enough to trust
+			int64_t iterations = 1;
+			std::vector<Run> repeats;
+			std::string error;
+			while (true)
+			{
+				State state(iterations, args);
+				RunOnce(benchmark, args, state);
+				if (!state._error.empty())
+				{
+					error = state._error;
+					break;
+				}
+
+				if (state._realTime >= minTime || iterations >= 1000000000)
+				{
+					double seconds = state._realTime;
+					repeats.push_back({ name, iterations, state._realTime, state._cpuTime,
+						seconds > 0.0 ? state._items / seconds : 0.0, seconds > 0.0 ? state._bytes / seconds : 0.0 });
+					break;
+				}
+
+				//Same prediction Google Benchmark makes, aim a bit past the minimum time
+				double multiplier = state._realTime / minTime > 0.1 ? minTime * 1.4 / std::max(state._realTime, 1e-9) : 10.0;
+				iterations = std::max(int64_t(iterations * multiplier), iterations + 1);
+			}
+
+			if (!error.empty())
+			{
+				printf("%-48s error: %s\n", name.c_str(), error.c_str());
+				failed = true;
+				continue;
+			}
+
+			//The rest of the repetitions use the same iteration count
+			for (int i = 1; i < repetitions; i++)
+			{
+				State state(iterations, args);
+				RunOnce(benchmark, args, state);
+				double seconds = state._realTime;
+				repeats.push_back({ name, iterations, state._realTime, state._cpuTime,
+					seconds > 0.0 ? state._items / seconds : 0.0, seconds > 0.0 ? state._bytes / seconds : 0.0 });
+			}
+
+			for (size_t i = 0; i < repeats.size(); i++)
+			{
+				const Run& run = repeats[i];
+				double realNs = run.RealTime * 1e9 / run.Iterations;
+				double cpuNs = run.CpuTime * 1e9 / run.Iterations;
+				printf("%-48s %11.1f ns %11.1f ns %12lld", name.c_str(), realNs, cpuNs, (long long)run.Iterations);
+				if (run.BytesPerSecond > 0.0)
+					printf(" %10.1f MB/s", run.BytesPerSecond / 1e6);
+				printf("\n");
+
+				nlohmann::json entry;
+				entry["name"] = name;
+				entry["run_name"] = name;
+				entry["run_type"] = "iteration";
+				entry["repetitions"] = repetitions;
+				entry["repetition_index"] = i;
+				entry["threads"] = 1;
+				entry["iterations"] = run.Iterations;
+				entry["real_time"] = realNs;
+				entry["cpu_time"] = cpuNs;
+				entry["time_unit"] = "ns";
+				if (run.ItemsPerSecond > 0.0)
+					entry["items_per_second"] = run.ItemsPerSecond;
+				if (run.BytesPerSecond > 0.0)
+					entry["bytes_per_second"] = run.BytesPerSecond;
+				results.push_back(entry);
+			}
+
+			//Mean, median and standard deviation across the repetitions
+			if (repeats.size() > 1)
+			{
+				std::vector<double> real, cpu;
+				for (const Run& run : repeats)
+				{
+					real.push_back(run.RealTime * 1e9 / run.Iterations);
+					cpu.push_back(run.CpuTime * 1e9 / run.Iterations);
+				}
+
+				auto mean = [](const std::vector<double>& values) {
+					double total = 0.0;
+					for (double value : values)
+						total += value;
+					return total / values.size();
+				};
+				auto median = [](std::vector<double> values) {
+					std::sort(values.begin(), values.end());
+					size_t mid = values.size() / 2;
+					return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) * 0.5;
+				};
+				auto stddev = [&](const std::vector<double>& values) {
+					double average = mean(values), total = 0.0;
+					for (double value : values)
+						total += (value - average) * (value - average);
+					return std::sqrt(total / (values.size() - 1));
+				};
+
+				const char* names[] = { "mean", "median", "stddev" };
+				double realValues[] = { mean(real), median(real), stddev(real) };
+				double cpuValues[] = { mean(cpu), median(cpu), stddev(cpu) };
+				for (int i = 0; i < 3; i++)
+				{
+					nlohmann::json entry;
+					entry["name"] = name + "_" + names[i];
+					entry["run_name"] = name;
+					entry["run_type"] = "aggregate";
+					entry["repetitions"] = repetitions;
+					entry["threads"] = 1;
+					entry["aggregate_name"] = names[i];
+					entry["iterations"] = repeats.size();
+					entry["real_time"] = realValues[i];
+					entry["cpu_time"] = cpuValues[i];
+					entry["time_unit"] = "ns";
+					results.push_back(entry);
+					printf("%-48s %11.1f ns %11.1f ns\n", (name + "_" + names[i]).c_str(), realValues[i], cpuValues[i]);
+				}
+			}
+		}
+	}
+
+	if (outputPath.empty())
+		return failed ? 1 : 0;
+
+	//Same layout as Google Benchmark's --benchmark_format=json, so its compare.py works on two of these
+	nlohmann::json root;
+	char date[32];
+	std::time_t now = std::time(nullptr);
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+	char hostName[256] = "unknown";
+#if defined(_WIN32)
+	DWORD hostSize = sizeof(hostName);
+	GetComputerNameA(hostName, &hostSize);
+#else
+	gethostname(hostName, sizeof(hostName));
+#endif
+	root["context"]["date"] = date;
+	root["context"]["host_name"] = hostName;
+	root["context"]["executable"] = "CGAssignmentProject";
+	root["context"]["num_cpus"] = std::thread::hardware_concurrency();
+	root["context"]["mhz_per_cpu"] = 0;
+	root["context"]["cpu_scaling_enabled"] = false;
+	root["context"]["caches"] = nlohmann::json::array();
+#ifdef _DEBUG
+	root["context"]["library_build_type"] = "debug";
+#else
+	root["context"]["library_build_type"] = "release";
+#endif
+	root["benchmarks"] = results;
+
+	std::ofstream file(outputPath);
+	if (!file.is_open())
+	{
+		printf("Failed to write %s\n", outputPath.c_str());
+		return 1;
+	}
+	file << root.dump(2);
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+//A small benchmark harness that works like Google Benchmark
+//*Each benchmark is a function that loops while State::KeepRunning() is true,
+//*and the results are written in Google Benchmark's json format so they can be compared between commits
+class MicroBenchmark abstract
+{
+public:
+	//Passed to each benchmark, tracks the iterations and the timer
+	class State
+	{
+	public:
+		State(int64_t iterations, const std::vector<int64_t>& args);
+
+		//Returns true until the benchmark has done all its iterations
+		bool KeepRunning();
+
+		//Stops the timer for setup work inside the loop
+		void PauseTiming();
+		void ResumeTiming();
+
+		//The argument the benchmark was registered with
+		int64_t Range(size_t index = 0) const;
+		int64_t Iterations() const;
+
+		//Lets the results report a throughput
+		void SetItemsProcessed(int64_t items);
+		void SetBytesProcessed(int64_t bytes);
+		//Marks the run as skipped (results aren't written)
+		void SkipWithError(const std::string& error);
+
+	private:
+		friend class MicroBenchmark;
+
+		int64_t _iterations;
+		int64_t _remaining;
+		std::vector<int64_t> _args;
+		bool _started = false;
+		bool _running = false;
+
+		std::chrono::steady_clock::time_point _realStart;
+		std::clock_t _cpuStart = 0;
+		double _realTime = 0.0;
+		double _cpuTime = 0.0;
+
+		int64_t _items = 0;
+		int64_t _bytes = 0;
+		std::string _error;
+	};
+
+	typedef void (*Function)(State&);
+
+	//Adds a benchmark, it is run once for each argument (or once if there are none)
+	//*Benchmarks that need a GL context are skipped when there isn't one
+	static void Register(const std::string& name, Function function, const std::vector<int64_t>& args = {}, bool needsContext = false);
+
+	//Runs every benchmark with a name containing filter, and writes the results to outputPath (if it isn't empty)
+	//*Each benchmark runs for at least minTime seconds, repetitions times
+	//*Returns 1 if any benchmark stopped with an error (or the results couldn't be written), so checks in them can fail the run
+	static int RunAll(const std::string& filter, const std::string& outputPath, bool hasContext, double minTime = 0.5, int repetitions = 1);
+
+	//Stops the compiler from optimising a value away
+	template <typename T>
+	static void DoNotOptimize(const T& value)
+	{
+#if defined(_MSC_VER)
+		_sink = reinterpret_cast<const volatile char*>(&value);
+#else
+		asm volatile("" : : "r,m"(value) : "memory");
+#endif
+	}
+
+	//Stops the compiler from reordering memory accesses across this point
+	static void ClobberMemory();
+
+	//Powers of multiplier from start to end (like Google Benchmark's RangeMultiplier)
+	static std::vector<int64_t> Range(int64_t start, int64_t end, int64_t multiplier = 8);
+
+private:
+	struct Benchmark
+	{
+		std::string Name;
+		Function Func;
+		std::vector<int64_t> Args;
+		bool NeedsContext;
+	};
+
+	//The result of one repetition
+	struct Run
+	{
+		std::string Name;
+		int64_t Iterations;
+		double RealTime;
+		double CpuTime;
+		double ItemsPerSecond;
+		double BytesPerSecond;
+	};
+
+	//Runs a benchmark once with a set number of iterations
+	static void RunOnce(const Benchmark& benchmark, const std::vector<int64_t>& args, State& state);
+
+	static std::vector<Benchmark> _benchmarks;
+#if defined(_MSC_VER)
+	static const volatile char* _sink;
+#endif
+};
@@ -0,0 +1,181 @@
+#include "Noise.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NOISE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	//Mixes a lattice point into 32 random bits, the SIMD version below does the same steps
+	inline uint32_t Hash(int32_t x, int32_t y, uint32_t seed)
+	{
+		uint32_t h = (uint32_t(x) * 0x27d4eb2du) ^ (uint32_t(y) * 0x165667b1u) ^ seed;
+		h ^= h >> 15;
+		h *= 0x2c1b3c6du;
+		h ^= h >> 12;
+		return h;
+	}
+
+	//Dot product with one of the 4 diagonal gradients, picked by the low bits of the hash
+	inline float Grad(uint32_t h, float dx, float dy)
+	{
+		return ((h & 1u) ? -dx : dx) + ((h & 2u) ? -dy : dy);
+	}
+
+	//Each octave gets its own lattice, so they don't line up at the origin
+	inline uint32_t OctaveSeed(uint32_t seed, int octave)
+	{
+		return seed + uint32_t(octave) * 0x9e3779b9u;
+	}
+}
+
+float Noise::Gradient(float x, float y, uint32_t seed)
+{
+	//Written out rather than floorf, so it matches the SIMD floor exactly
+	float fx = float(int32_t(x));
+	if (fx > x)
+		fx -= 1.0f;
+	float fy = float(int32_t(y));
+	if (fy > y)
+		fy -= 1.0f;
+	int32_t ix = int32_t(fx);
+	int32_t iy = int32_t(fy);
+	float dx = x - fx;
+	float dy = y - fy;
+
+	float u = dx * dx * dx * (dx * (dx * 6.0f - 15.0f) + 10.0f);
+	float v = dy * dy * dy * (dy * (dy * 6.0f - 15.0f) + 10.0f);
+
+	float g00 = Grad(Hash(ix, iy, seed), dx, dy);
+	float g10 = Grad(Hash(ix + 1, iy, seed), dx - 1.0f, dy);
+	float g01 = Grad(Hash(ix, iy + 1, seed), dx, dy - 1.0f);
+	float g11 = Grad(Hash(ix + 1, iy + 1, seed), dx - 1.0f, dy - 1.0f);
+
+	float bottom = g00 + u * (g10 - g00);
+	float top = g01 + u * (g11 - g01);
+	return bottom + v * (top - bottom);
+}
+
+float Noise::Fbm(float x, float y, const FbmSettings& settings)
+{
+	float sum = 0.0f;
+	float amplitude = 1.0f;
+	float frequency = settings.Frequency;
+	for (int octave = 0; octave < settings.Octaves; octave++)
+	{
+		sum += amplitude * Gradient(x * frequency, y * frequency, OctaveSeed(settings.Seed, octave));
+		frequency *= settings.Lacunarity;
+		amplitude *= settings.Gain;
+	}
+	return sum;
+}
+
+void Noise::FbmRowScalar(float x, float y, float step, int count, const FbmSettings& settings, float* out)
+{
+	for (int i = 0; i < count; i++)
+		out[i] = Fbm(x + float(i) * step, y, settings);
+}
+
+#ifdef NOISE_SSE2
+namespace
+{
+	//SSE2 has no 32 bit multiply that keeps the low half, so do the even and odd lanes separately
+	inline __m128i MultiplyLow(__m128i a, __m128i b)
+	{
+		__m128i even = _mm_mul_epu32(a, b);
+		__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+		return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+	}
+
+	inline __m128 Floor(__m128 x)
+	{
+		__m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+		return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, x), _mm_set1_ps(1.0f)));
+	}
+
+	inline __m128i Hash(__m128i x, __m128i y, uint32_t seed)
+	{
+		__m128i h = _mm_xor_si128(_mm_xor_si128(MultiplyLow(x, _mm_set1_epi32(0x27d4eb2d)), MultiplyLow(y, _mm_set1_epi32(0x165667b1))), _mm_set1_epi32(int(seed)));
+		h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+		h = MultiplyLow(h, _mm_set1_epi32(0x2c1b3c6d));
+		return _mm_xor_si128(h, _mm_srli_epi32(h, 12));
+	}
+
+	//Flipping the sign bit is the same as the scalar version's negation
+	inline __m128 Grad(__m128i h, __m128 dx, __m128 dy)
+	{
+		__m128 flipX = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31));
+		__m128 flipY = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30));
+		return _mm_add_ps(_mm_xor_ps(dx, flipX), _mm_xor_ps(dy, flipY));
+	}
+
+	inline __m128 Fade(__m128 d)
+	{
+		__m128 cubed = _mm_mul_ps(_mm_mul_ps(d, d), d);
+		__m128 inner = _mm_add_ps(_mm_mul_ps(d, _mm_sub_ps(_mm_mul_ps(d, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))), _mm_set1_ps(10.0f));
+		return _mm_mul_ps(cubed, inner);
+	}
+
+	inline __m128 Lerp(__m128 a, __m128 b, __m128 t)
+	{
+		return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+	}
+
+	__m128 Gradient4(__m128 x, __m128 y, uint32_t seed)
+	{
+		__m128 fx = Floor(x);
+		__m128 fy = Floor(y);
+		__m128i ix = _mm_cvttps_epi32(fx);
+		__m128i iy = _mm_cvttps_epi32(fy);
+		__m128i ix1 = _mm_add_epi32(ix, _mm_set1_epi32(1));
+		__m128i iy1 = _mm_add_epi32(iy, _mm_set1_epi32(1));
+		__m128 dx = _mm_sub_ps(x, fx);
+		__m128 dy = _mm_sub_ps(y, fy);
+		__m128 dx1 = _mm_sub_ps(dx, _mm_set1_ps(1.0f));
+		__m128 dy1 = _mm_sub_ps(dy, _mm_set1_ps(1.0f));
+
+		__m128 g00 = Grad(Hash(ix, iy, seed), dx, dy);
+		__m128 g10 = Grad(Hash(ix1, iy, seed), dx1, dy);
+		__m128 g01 = Grad(Hash(ix, iy1, seed), dx, dy1);
+		__m128 g11 = Grad(Hash(ix1, iy1, seed), dx1, dy1);
+
+		__m128 u = Fade(dx);
+		__m128 bottom = Lerp(g00, g10, u);
+		__m128 top = Lerp(g01, g11, u);
+		return Lerp(bottom, top, Fade(dy));
+	}
+}
+#endif
+
+void Noise::FbmRow(float x, float y, float step, int count, const FbmSettings& settings, float* out)
+{
+#ifdef NOISE_SSE2
+	int simdCount = count & ~3;
+	const __m128 lanes = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+	for (int i = 0; i < simdCount; i += 4)
+	{
+		__m128 px = _mm_add_ps(_mm_set1_ps(x), _mm_mul_ps(_mm_add_ps(_mm_set1_ps(float(i)), lanes), _mm_set1_ps(step)));
+		__m128 py = _mm_set1_ps(y);
+
+		__m128 sum = _mm_setzero_ps();
+		float amplitude = 1.0f;
+		float frequency = settings.Frequency;
+		for (int octave = 0; octave < settings.Octaves; octave++)
+		{
+			__m128 frequencies = _mm_set1_ps(frequency);
+			__m128 noise = Gradient4(_mm_mul_ps(px, frequencies), _mm_mul_ps(py, frequencies), OctaveSeed(settings.Seed, octave));
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(amplitude), noise));
+			frequency *= settings.Lacunarity;
+			amplitude *= settings.Gain;
+		}
+		_mm_storeu_ps(out + i, sum);
+	}
+
+	//Whatever's left past the last group of 4
+	for (int i = simdCount; i < count; i++)
+		out[i] = Fbm(x + float(i) * step, y, settings);
+#else
+	FbmRowScalar(x, y, step, count, settings, out);
+#endif
+}
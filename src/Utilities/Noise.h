@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+
+//Gradient noise, and fractal sums of it (fBm) for things like terrain
+//*Every function gives exactly the same numbers for the same input, whichever version runs
+class Noise abstract
+{
+public:
+	//How the octaves of an fBm sum are built
+	struct FbmSettings
+	{
+		//Features per unit of the first octave
+		float Frequency = 0.02f;
+		int Octaves = 5;
+		//Each octave's frequency is the last one's times Lacunarity, and its strength the last one's times Gain
+		float Lacunarity = 2.0f;
+		float Gain = 0.5f;
+		uint32_t Seed = 0;
+	};
+
+	//Roughly -1 to 1, 0 on every whole number
+	static float Gradient(float x, float y, uint32_t seed);
+	static float Fbm(float x, float y, const FbmSettings& settings);
+
+	//Fills out[i] with Fbm(x + i * step, y), 4 at a time with SSE2
+	static void FbmRow(float x, float y, float step, int count, const FbmSettings& settings, float* out);
+	//The plain version, used for the end of the row and where SSE2 isn't available
+	static void FbmRowScalar(float x, float y, float step, int count, const FbmSettings& settings, float* out);
+};
@@ -0,0 +1,252 @@
+#include "PoissonDisk.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	const float TWO_PI = 6.28318530718f;
+
+	size_t NextPowerOfTwo(size_t value)
+	{
+		size_t result = 1;
+		while (result < value)
+			result <<= 1;
+		return result;
+	}
+}
+
+void PoissonDisk::Reset(float cellSize, size_t expectedPoints)
+{
+	_cellSize = cellSize > 0.0f ? cellSize : 1.0f;
+	_maxRadius = 0.0f;
+	_points.clear();
+	_radii.clear();
+	_next.clear();
+	_points.reserve(expectedPoints);
+	_radii.reserve(expectedPoints);
+	_next.reserve(expectedPoints);
+	//Twice as many buckets as points keeps the lists short
+	Rehash(NextPowerOfTwo(std::max<size_t>(expectedPoints, 512)) * 2);
+}
+
+size_t PoissonDisk::Generate(Util::Random& random, glm::vec2 from, glm::vec2 to, float radius, size_t count,
+	Util::Span<const glm::vec2> avoidFrom, Util::Span<const glm::vec2> avoidTo, std::vector<glm::vec2>& out)
+{
+	glm::vec2 min = glm::min(from, to);
+	glm::vec2 max = glm::max(from, to);
+	radius = std::max(radius, 0.0f);
+
+	Util::RegionSampler<glm::vec2> sampler(min, max, avoidFrom, avoidTo);
+	if (sampler.IsCovered() || count == 0)
+		return 0;
+	_avoid.Build(min, max, avoidFrom, avoidTo);
+
+	size_t first = _points.size();
+	size_t placed = 0;
+
+	//Random points spread evenly until most of them land too close to another one
+	//*Growing out from a single point would bunch everything up when there's room for more than count
+	int failures = 0;
+	while (placed < count && failures < DartFailures)
+	{
+		glm::vec2 point = sampler.Sample(random);
+		if (IsBlocked(point, radius))
+		{
+			failures++;
+			continue;
+		}
+		failures = 0;
+		Add(point, radius);
+		out.push_back(point);
+		placed++;
+	}
+
+	//Then fill the gaps, trying points in the ring between one and two spacings out from each point we have
+	float spacing = 2.0f * radius;
+	_active.clear();
+	for (size_t i = first; i < _points.size(); i++)
+		_active.push_back(int(i));
+	while (placed < count && !_active.empty())
+	{
+		size_t pick = random.NextUInt(uint32_t(_active.size()));
+		glm::vec2 centre = _points[_active[pick]];
+
+		bool found = false;
+		for (int attempt = 0; attempt < Attempts; attempt++)
+		{
+			float angle = random.NextFloat() * TWO_PI;
+			//The square root spreads them evenly over the ring's area
+			float distance = spacing * std::sqrt(1.0f + 3.0f * random.NextFloat());
+			glm::vec2 candidate = centre + glm::vec2(std::cos(angle), std::sin(angle)) * distance;
+			if (!IsAllowed(candidate, min, max) || IsBlocked(candidate, radius))
+				continue;
+
+			_active.push_back(int(_points.size()));
+			Add(candidate, radius);
+			out.push_back(candidate);
+			placed++;
+			found = true;
+			break;
+		}
+
+		//Nothing fits around this one any more
+		if (!found)
+		{
+			_active[pick] = _active.back();
+			_active.pop_back();
+		}
+	}
+
+	return placed;
+}
+
+bool PoissonDisk::IsBlocked(glm::vec2 point, float radius) const
+{
+	if (_points.empty())
+		return false;
+
+	//Anything that could be in range is within our radius plus the biggest one placed
+	float reach = radius + _maxRadius;
+	int minX = int(std::floor((point.x - reach) / _cellSize));
+	int maxX = int(std::floor((point.x + reach) / _cellSize));
+	int minY = int(std::floor((point.y - reach) / _cellSize));
+	int maxY = int(std::floor((point.y + reach) / _cellSize));
+	for (int y = minY; y <= maxY; y++)
+	{
+		for (int x = minX; x <= maxX; x++)
+		{
+			//Other cells can share the bucket, the distance check sorts those out
+			for (int i = _buckets[Bucket(x, y)]; i != -1; i = _next[i])
+			{
+				float limit = radius + _radii[i];
+				glm::vec2 offset = point - _points[i];
+				if (offset.x * offset.x + offset.y * offset.y < limit * limit)
+					return true;
+			}
+		}
+	}
+	return false;
+}
+
+size_t PoissonDisk::GetPointCount() const
+{
+	return _points.size();
+}
+
+bool PoissonDisk::IsAllowed(glm::vec2 point, glm::vec2 from, glm::vec2 to) const
+{
+	if (point.x < from.x || point.x > to.x || point.y < from.y || point.y > to.y)
+		return false;
+	return !_avoid.Contains(point);
+}
+
+void PoissonDisk::Add(glm::vec2 point, float radius)
+{
+	if (_points.size() >= _buckets.size())
+		Rehash(_buckets.size() * 2);
+
+	int index = int(_points.size());
+	size_t bucket = Bucket(int(std::floor(point.x / _cellSize)), int(std::floor(point.y / _cellSize)));
+	_points.push_back(point);
+	_radii.push_back(radius);
+	_next.push_back(_buckets[bucket]);
+	_buckets[bucket] = index;
+	_maxRadius = std::max(_maxRadius, radius);
+}
+
+size_t PoissonDisk::Bucket(int x, int y) const
+{
+	uint32_t hash = (uint32_t(x) * 73856093u) ^ (uint32_t(y) * 19349663u);
+	return size_t(hash) & (_buckets.size() - 1);
+}
+
+void PoissonDisk::Rehash(size_t buckets)
+{
+	_buckets.assign(buckets, -1);
+	for (size_t i = 0; i < _points.size(); i++)
+	{
+		size_t bucket = Bucket(int(std::floor(_points[i].x / _cellSize)), int(std::floor(_points[i].y / _cellSize)));
+		_next[i] = _buckets[bucket];
+		_buckets[bucket] = int(i);
+	}
+}
+
+void PoissonDisk::AvoidGrid::Build(glm::vec2 from, glm::vec2 to, Util::Span<const glm::vec2> avoidFrom, Util::Span<const glm::vec2> avoidTo)
+{
+	BoxMin.clear();
+	BoxMax.clear();
+	for (size_t i = 0; i < std::min(avoidFrom.size(), avoidTo.size()); i++)
+	{
+		glm::vec2 boxMin = glm::min(avoidFrom[i], avoidTo[i]);
+		glm::vec2 boxMax = glm::max(avoidFrom[i], avoidTo[i]);
+		if (boxMax.x < from.x || boxMin.x > to.x || boxMax.y < from.y || boxMin.y > to.y)
+			continue;
+		BoxMin.push_back(boxMin);
+		BoxMax.push_back(boxMax);
+	}
+
+	Width = 0;
+	Height = 0;
+	Starts.clear();
+	Indices.clear();
+	if (BoxMin.empty())
+		return;
+
+	//A few boxes per cell at most, without the grid getting big for a long avoid list
+	int side = std::min(64, std::max(1, int(std::ceil(std::sqrt(float(BoxMin.size()) * 4.0f)))));
+	Width = side;
+	Height = side;
+	Min = from;
+	CellSize = (to - from) / float(side);
+	CellSize.x = CellSize.x > 0.0f ? CellSize.x : 1.0f;
+	CellSize.y = CellSize.y > 0.0f ? CellSize.y : 1.0f;
+
+	auto cellRange = [&](size_t box, int& minX, int& maxX, int& minY, int& maxY) {
+		minX = std::max(0, int((BoxMin[box].x - Min.x) / CellSize.x));
+		maxX = std::min(Width - 1, int((BoxMax[box].x - Min.x) / CellSize.x));
+		minY = std::max(0, int((BoxMin[box].y - Min.y) / CellSize.y));
+		maxY = std::min(Height - 1, int((BoxMax[box].y - Min.y) / CellSize.y));
+	};
+
+	//Count the boxes in each cell, then fill them in
+	Starts.assign(size_t(Width) * Height + 1, 0);
+	int minX, maxX, minY, maxY;
+	for (size_t box = 0; box < BoxMin.size(); box++)
+	{
+		cellRange(box, minX, maxX, minY, maxY);
+		for (int y = minY; y <= maxY; y++)
+			for (int x = minX; x <= maxX; x++)
+				Starts[y * Width + x + 1]++;
+	}
+	for (size_t i = 1; i < Starts.size(); i++)
+		Starts[i] += Starts[i - 1];
+
+	Indices.resize(Starts.back());
+	std::vector<int> filled(Starts.begin(), Starts.end() - 1);
+	for (size_t box = 0; box < BoxMin.size(); box++)
+	{
+		cellRange(box, minX, maxX, minY, maxY);
+		for (int y = minY; y <= maxY; y++)
+			for (int x = minX; x <= maxX; x++)
+				Indices[filled[y * Width + x]++] = int(box);
+	}
+}
+
+bool PoissonDisk::AvoidGrid::Contains(glm::vec2 point) const
+{
+	if (Width == 0)
+		return false;
+
+	int x = std::min(Width - 1, std::max(0, int((point.x - Min.x) / CellSize.x)));
+	int y = std::min(Height - 1, std::max(0, int((point.y - Min.y) / CellSize.y)));
+	int cell = y * Width + x;
+	for (int i = Starts[cell]; i < Starts[cell + 1]; i++)
+	{
+		const glm::vec2& boxMin = BoxMin[Indices[i]];
+		const glm::vec2& boxMax = BoxMax[Indices[i]];
+		if (point.x >= boxMin.x && point.x <= boxMax.x && point.y >= boxMin.y && point.y <= boxMax.y)
+			return true;
+	}
+	return false;
+}
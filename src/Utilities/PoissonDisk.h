@@ -0,0 +1,71 @@
+#pragma once
+#include <GLM/glm.hpp>
+#include <vector>
+
+#include "Utilities/Util.h"
+
+//Places points so that none are closer than their radii allow (Poisson-disk, or blue noise)
+//*Uses Bridson's algorithm, with a spatial hash so checking a point only looks at its neighbours,
+//*which keeps it linear in the number of points
+//*Points from earlier calls to Generate stay in, so different object types keep their distance from each other too
+class PoissonDisk
+{
+public:
+	PoissonDisk() = default;
+
+	//Removes every point, the cell size should be about twice the biggest radius that will be used
+	void Reset(float cellSize, size_t expectedPoints = 0);
+
+	//Places up to count points in the box from - to, outside of the avoid boxes
+	//*Two points have to be at least the sum of their radii apart
+	//*Returns how many were placed, which is less than count if they don't fit
+	size_t Generate(Util::Random& random, glm::vec2 from, glm::vec2 to, float radius, size_t count,
+		Util::Span<const glm::vec2> avoidFrom, Util::Span<const glm::vec2> avoidTo, std::vector<glm::vec2>& out);
+
+	//Adds a point that was placed somewhere else (like a neighbouring chunk), so new points keep away from it
+	void Add(glm::vec2 point, float radius);
+	//Would a point here be too close to one that's already placed
+	bool IsBlocked(glm::vec2 point, float radius) const;
+
+	size_t GetPointCount() const;
+
+	//Tries around each point before giving up on it (the k in Bridson's paper)
+	int Attempts = 30;
+	//Random tries in a row that can fail before we switch to filling in around the points we have
+	int DartFailures = 30;
+
+private:
+	//Which avoid boxes overlap each cell of the spawn box, so a point only checks the ones near it
+	struct AvoidGrid
+	{
+		void Build(glm::vec2 from, glm::vec2 to, Util::Span<const glm::vec2> avoidFrom, Util::Span<const glm::vec2> avoidTo);
+		bool Contains(glm::vec2 point) const;
+
+		glm::vec2 Min;
+		glm::vec2 CellSize;
+		int Width = 0;
+		int Height = 0;
+		std::vector<glm::vec2> BoxMin;
+		std::vector<glm::vec2> BoxMax;
+		//Cell i's boxes are Indices[Starts[i]] to Indices[Starts[i + 1]]
+		std::vector<int> Starts;
+		std::vector<int> Indices;
+	};
+
+	//Is the point inside the spawn box and out of the avoid boxes
+	bool IsAllowed(glm::vec2 point, glm::vec2 from, glm::vec2 to) const;
+	size_t Bucket(int x, int y) const;
+	void Rehash(size_t buckets);
+
+	float _cellSize = 1.0f;
+	float _maxRadius = 0.0f;
+	std::vector<glm::vec2> _points;
+	std::vector<float> _radii;
+	//Each bucket is the head of a list of points through _next, -1 ends it
+	std::vector<int> _buckets;
+	std::vector<int> _next;
+
+	AvoidGrid _avoid;
+	//This call's points that might still have room around them
+	std::vector<int> _active;
+};
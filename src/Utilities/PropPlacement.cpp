@@ -0,0 +1,236 @@
+#include "PropPlacement.h"
+
+#include <algorithm>
+#include <cmath>
+
+int PropPlacement::PropsPerChunk = 500;
+
+namespace
+{
+	struct Chunk
+	{
+		int X;
+		int Y;
+		glm::vec2 Min;
+		glm::vec2 Max;
+		//Per object
+		std::vector<float> Areas;
+		std::vector<int> Counts;
+		std::vector<std::vector<PropPlacement::Placement>> Placements;
+		PoissonDisk Disk;
+	};
+
+	//Chunks that touch are never in the same pass
+	int GetPass(int x, int y)
+	{
+		return (x & 1) + 2 * (y & 1);
+	}
+
+	//The part of the object's spawn area inside the chunk, false if there's none
+	bool Clip(const PropPlacement::Object& object, glm::vec2 chunkMin, glm::vec2 chunkMax, glm::vec2& min, glm::vec2& max)
+	{
+		min = glm::max(glm::min(object.SpawnFrom, object.SpawnTo), chunkMin);
+		max = glm::min(glm::max(object.SpawnFrom, object.SpawnTo), chunkMax);
+		return min.x <= max.x && min.y <= max.y;
+	}
+}
+
+void PropPlacement::PlaceAll(const std::vector<Object>& objects, uint64_t seed, WorkerPool& pool, std::vector<std::vector<Placement>>& out)
+{
+	out.assign(objects.size(), std::vector<Placement>());
+
+	//The chunks cover everything any object can spawn in
+	glm::vec2 min(0.0f), max(0.0f);
+	float maxRadius = 0.0f;
+	size_t total = 0;
+	for (const Object& object : objects)
+	{
+		if (object.Count <= 0)
+			continue;
+		glm::vec2 from = glm::min(object.SpawnFrom, object.SpawnTo);
+		glm::vec2 to = glm::max(object.SpawnFrom, object.SpawnTo);
+		min = total == 0 ? from : glm::min(min, from);
+		max = total == 0 ? to : glm::max(max, to);
+		maxRadius = std::max(maxRadius, object.Radius);
+		total += object.Count;
+	}
+	if (total == 0)
+		return;
+
+	//Chunks have to be at least as big as the furthest two props can reach, so a pass's chunks can't affect each other
+	glm::vec2 size = max - min;
+	float reach = 2.0f * maxRadius;
+	float targetChunks = std::min(4096.0f, std::max(1.0f, float(total) / std::max(PropsPerChunk, 1)));
+	float chunkSize = std::max(2.0f * reach, std::sqrt(size.x * size.y / targetChunks));
+	if (!(chunkSize > 0.0f))
+		chunkSize = std::max(std::max(size.x, size.y), 1.0f);
+	int columns = std::max(1, int(size.x / chunkSize));
+	int rows = std::max(1, int(size.y / chunkSize));
+	glm::vec2 extent(size.x / columns, size.y / rows);
+
+	std::vector<Chunk> chunks(size_t(columns) * rows);
+	pool.ParallelFor(chunks.size(), [&](size_t index) {
+		Chunk& chunk = chunks[index];
+		chunk.X = int(index % columns);
+		chunk.Y = int(index / columns);
+		chunk.Min = min + extent * glm::vec2(float(chunk.X), float(chunk.Y));
+		//The last row and column end exactly on the edge, whatever the rounding
+		chunk.Max.x = chunk.X == columns - 1 ? max.x : min.x + extent.x * (chunk.X + 1);
+		chunk.Max.y = chunk.Y == rows - 1 ? max.y : min.y + extent.y * (chunk.Y + 1);
+		chunk.Areas.resize(objects.size());
+		for (size_t i = 0; i < objects.size(); i++)
+			chunk.Areas[i] = objects[i].Count > 0 ? GetArea(objects[i], chunk.Min, chunk.Max) : 0.0f;
+		chunk.Counts.assign(objects.size(), 0);
+		chunk.Placements.resize(objects.size());
+	});
+
+	//Each chunk gets its share of an object by area, what's left over after rounding down goes to the biggest remainders
+	std::vector<std::pair<double, size_t>> remainders;
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		double totalArea = 0.0;
+		for (const Chunk& chunk : chunks)
+			totalArea += chunk.Areas[i];
+		if (objects[i].Count <= 0 || totalArea <= 0.0)
+			continue;
+
+		remainders.clear();
+		int assigned = 0;
+		for (size_t c = 0; c < chunks.size(); c++)
+		{
+			double quota = objects[i].Count * (chunks[c].Areas[i] / totalArea);
+			chunks[c].Counts[i] = int(quota);
+			assigned += int(quota);
+			remainders.emplace_back(quota - int(quota), c);
+		}
+		std::stable_sort(remainders.begin(), remainders.end(), [](const std::pair<double, size_t>& a, const std::pair<double, size_t>& b) {
+			return a.first > b.first;
+		});
+		for (size_t k = 0; k < remainders.size() && assigned < objects[i].Count; k++, assigned++)
+			chunks[remainders[k].second].Counts[i]++;
+	}
+
+	std::vector<size_t> pass;
+	for (int p = 0; p < 4; p++)
+	{
+		pass.clear();
+		for (size_t c = 0; c < chunks.size(); c++)
+		{
+			if (GetPass(chunks[c].X, chunks[c].Y) == p)
+				pass.push_back(c);
+		}
+
+		pool.ParallelFor(pass.size(), [&](size_t index) {
+			Chunk& chunk = chunks[pass[index]];
+			size_t expected = 0;
+			for (int count : chunk.Counts)
+				expected += count;
+			chunk.Disk.Reset(2.0f * maxRadius, expected);
+
+			//Neighbours from earlier passes are done, so keep away from their props near our edges
+			for (int y = chunk.Y - 1; y <= chunk.Y + 1; y++)
+			{
+				for (int x = chunk.X - 1; x <= chunk.X + 1; x++)
+				{
+					if (x < 0 || y < 0 || x >= columns || y >= rows || GetPass(x, y) >= p)
+						continue;
+					const Chunk& neighbour = chunks[size_t(y) * columns + x];
+					for (size_t i = 0; i < objects.size(); i++)
+					{
+						if (objects[i].Radius <= 0.0f)
+							continue;
+						for (const Placement& placement : neighbour.Placements[i])
+						{
+							const glm::vec2& position = placement.Position;
+							if (position.x >= chunk.Min.x - reach && position.x <= chunk.Max.x + reach &&
+								position.y >= chunk.Min.y - reach && position.y <= chunk.Max.y + reach)
+								chunk.Disk.Add(position, objects[i].Radius);
+						}
+					}
+				}
+			}
+
+			PlaceChunk(objects, chunk.Counts, chunk.Min, chunk.Max, false, seed, chunk.X, chunk.Y, chunk.Disk, chunk.Placements);
+		});
+	}
+
+	//Put each object's placements together in chunk order, so the result doesn't depend on which thread finished first
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		size_t count = 0;
+		for (const Chunk& chunk : chunks)
+			count += chunk.Placements[i].size();
+		out[i].reserve(count);
+		for (const Chunk& chunk : chunks)
+			out[i].insert(out[i].end(), chunk.Placements[i].begin(), chunk.Placements[i].end());
+	}
+}
+
+void PropPlacement::PlaceChunk(const std::vector<Object>& objects, const std::vector<int>& counts, glm::vec2 chunkMin, glm::vec2 chunkMax,
+	bool keepInside, uint64_t seed, int chunkX, int chunkY, PoissonDisk& disk, std::vector<std::vector<Placement>>& out)
+{
+	//Biggest first, they're the hardest to fit
+	std::vector<size_t> order(objects.size());
+	for (size_t i = 0; i < order.size(); i++)
+		order[i] = i;
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return objects[a].Radius > objects[b].Radius; });
+
+	std::vector<glm::vec2> positions;
+	for (size_t i : order)
+	{
+		const Object& object = objects[i];
+		if (counts[i] <= 0)
+			continue;
+
+		glm::vec2 min, max;
+		if (!Clip(object, chunkMin, chunkMax, min, max))
+			continue;
+		if (keepInside && object.Radius > 0.0f)
+		{
+			//Only the chunk's own edges, the spawn area's edges are fine to go up to
+			glm::vec2 spawnMin = glm::min(object.SpawnFrom, object.SpawnTo);
+			glm::vec2 spawnMax = glm::max(object.SpawnFrom, object.SpawnTo);
+			if (chunkMin.x > spawnMin.x)
+				min.x += object.Radius;
+			if (chunkMin.y > spawnMin.y)
+				min.y += object.Radius;
+			if (chunkMax.x < spawnMax.x)
+				max.x -= object.Radius;
+			if (chunkMax.y < spawnMax.y)
+				max.y -= object.Radius;
+			if (min.x > max.x || min.y > max.y)
+				continue;
+		}
+
+		Util::Random random(seed, GetStream(i, chunkX, chunkY));
+		positions.clear();
+		if (object.Radius > 0.0f)
+			disk.Generate(random, min, max, object.Radius, size_t(counts[i]), object.AvoidFrom, object.AvoidTo, positions);
+		else
+		{
+			Util::RegionSampler<glm::vec2> sampler(min, max, object.AvoidFrom, object.AvoidTo);
+			if (sampler.IsCovered())
+				continue;
+			positions.resize(size_t(counts[i]));
+			sampler.Fill(random, positions);
+		}
+
+		out[i].reserve(out[i].size() + positions.size());
+		for (const glm::vec2& position : positions)
+			out[i].push_back({ position, random.Range(0.0f, 360.0f), 1.0f });
+	}
+}
+
+float PropPlacement::GetArea(const Object& object, glm::vec2 chunkMin, glm::vec2 chunkMax)
+{
+	glm::vec2 min, max;
+	if (!Clip(object, chunkMin, chunkMax, min, max))
+		return 0.0f;
+	return Util::RegionSampler<glm::vec2>(min, max, object.AvoidFrom, object.AvoidTo).GetArea();
+}
+
+uint64_t PropPlacement::GetStream(size_t object, int chunkX, int chunkY)
+{
+	uint64_t chunk = (uint64_t(uint32_t(chunkX)) << 32) | uint32_t(chunkY);
+	return chunk ^ (uint64_t(object) * 0x9E3779B97F4A7C15ull);
+}
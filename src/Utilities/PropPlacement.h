@@ -0,0 +1,55 @@
+#pragma once
+#include <GLM/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "Utilities/PoissonDisk.h"
+#include "Utilities/Util.h"
+#include "Utilities/WorkerPool.h"
+
+//Works out where generated props go, a square chunk of the world at a time
+//*Every object type in every chunk gets its own random stream made from the seed, so the result is
+//*the same whatever order the chunks run in and however many threads there are
+class PropPlacement abstract
+{
+public:
+	//Where one prop goes
+	struct Placement
+	{
+		glm::vec2 Position;
+		//Degrees around z
+		float Rotation;
+		float Scale;
+	};
+
+	//How one type of prop gets placed
+	struct Object
+	{
+		glm::vec2 SpawnFrom;
+		glm::vec2 SpawnTo;
+		std::vector<glm::vec2> AvoidFrom;
+		std::vector<glm::vec2> AvoidTo;
+		//Props with a radius keep the sum of their radii away from each other, 0 goes anywhere
+		float Radius = 0.0f;
+		int Count = 0;
+	};
+
+	//Places every object over its whole spawn area, out gets each object's placements
+	//*Chunks next to each other run in different passes, so spaced props still keep their distance across chunk edges
+	static void PlaceAll(const std::vector<Object>& objects, uint64_t seed, WorkerPool& pool, std::vector<std::vector<Placement>>& out);
+
+	//Places counts[i] of each object inside the chunk from chunkMin to chunkMax, adding to out[i]
+	//*disk has to be reset by the caller, and can already hold props from around the chunk to keep away from
+	//*With keepInside, spaced props stay their radius inside the chunk, so chunks made on their own never overlap
+	static void PlaceChunk(const std::vector<Object>& objects, const std::vector<int>& counts, glm::vec2 chunkMin, glm::vec2 chunkMax,
+		bool keepInside, uint64_t seed, int chunkX, int chunkY, PoissonDisk& disk, std::vector<std::vector<Placement>>& out);
+
+	//Space an object has in a chunk once its avoid boxes are taken out
+	static float GetArea(const Object& object, glm::vec2 chunkMin, glm::vec2 chunkMax);
+
+	//The random stream an object uses in a chunk
+	static uint64_t GetStream(size_t object, int chunkX, int chunkY);
+
+	//Roughly how many props a chunk gets, fewer means more chunks to share out
+	static int PropsPerChunk;
+};
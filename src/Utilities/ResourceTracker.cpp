@@ -0,0 +1,305 @@
+#include "ResourceTracker.h"
+
+#include <algorithm>
+#include <fstream>
+#include <json.hpp>
+#include <unordered_set>
+#include <RendererComponent.h>
+#include "imgui.h"
+
+std::unordered_map<uint64_t, ResourceTracker::Entry> ResourceTracker::_entries[(int)ResourceTracker::Category::Count];
+ResourceTracker::Totals ResourceTracker::_totals[(int)ResourceTracker::Category::Count];
+size_t ResourceTracker::_gpuBytes = 0;
+size_t ResourceTracker::_cpuBytes = 0;
+size_t ResourceTracker::_peakGpuBytes = 0;
+size_t ResourceTracker::_peakCpuBytes = 0;
+
+void ResourceTracker::Track(Category category, uint64_t id, size_t bytes)
+{
+	Untrack(category, id);
+	Entry entry;
+	entry.Bytes = bytes;
+	_entries[(int)category][id] = entry;
+	Add(category, bytes);
+}
+
+void ResourceTracker::Track(Category category, uint64_t id, size_t bytes, const std::shared_ptr<void>& owner)
+{
+	Untrack(category, id);
+	Entry entry;
+	entry.Bytes = bytes;
+	entry.Owner = owner;
+	entry.HasOwner = true;
+	_entries[(int)category][id] = entry;
+	Add(category, bytes);
+}
+
+void ResourceTracker::Untrack(Category category, uint64_t id)
+{
+	auto& entries = _entries[(int)category];
+	auto it = entries.find(id);
+	if (it == entries.end())
+		return;
+	Remove(category, it->second.Bytes);
+	entries.erase(it);
+}
+
+void ResourceTracker::TrackTexture(const ITexture::sptr& texture, Category category)
+{
+	if (texture == nullptr || texture->GetHandle() == GL_NONE)
+		return;
+	int faces = category == Category::TextureCubeMap ? 6 : 1;
+	Track(category, texture->GetHandle(), TextureBytes(texture->GetHandle(), faces), texture);
+}
+
+void ResourceTracker::TrackMesh(const VertexArrayObject::sptr& mesh)
+{
+	if (mesh == nullptr || mesh->GetHandle() == GL_NONE)
+		return;
+	GLuint vao = mesh->GetHandle();
+	Track(Category::VertexArray, vao, 0, mesh);
+
+	//The toolkit doesn't hand out its vertex buffers, so ask the vertex array which ones it reads from
+	GLint maxAttribs = 0;
+	glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &maxAttribs);
+	for (GLint i = 0; i < maxAttribs; i++)
+	{
+		GLint buffer = 0;
+		glGetVertexArrayIndexediv(vao, i, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &buffer);
+		if (buffer != 0)
+			Track(Category::VertexBuffer, GLuint(buffer), BufferBytes(GLuint(buffer)), mesh);
+	}
+	GLint indices = 0;
+	glGetVertexArrayiv(vao, GL_ELEMENT_ARRAY_BUFFER_BINDING, &indices);
+	if (indices != 0)
+		Track(Category::VertexBuffer, GLuint(indices), BufferBytes(GLuint(indices)), mesh);
+}
+
+void ResourceTracker::TrackShader(const Shader::sptr& shader)
+{
+	if (shader == nullptr || shader->GetHandle() == GL_NONE)
+		return;
+	//The linked binary is the closest thing we get to the size of a program
+	GLint length = 0;
+	glGetProgramiv(shader->GetHandle(), GL_PROGRAM_BINARY_LENGTH, &length);
+	Track(Category::Shader, shader->GetHandle(), size_t(std::max(length, 0)), shader);
+}
+
+void ResourceTracker::TrackScene(entt::registry& registry)
+{
+	//Props share a handful of meshes and shaders, so only query each one once instead of once per entity
+	std::unordered_set<VertexArrayObject*> meshes;
+	std::unordered_set<Shader*> shaders;
+	registry.view<RendererComponent>().each([&](entt::entity, RendererComponent& renderer) {
+		if (renderer.Mesh != nullptr && meshes.insert(renderer.Mesh.get()).second)
+			TrackMesh(renderer.Mesh);
+		if (renderer.Material != nullptr && renderer.Material->Shader != nullptr && shaders.insert(renderer.Material->Shader.get()).second)
+			TrackShader(renderer.Material->Shader);
+	});
+}
+
+void ResourceTracker::Update()
+{
+	for (int i = 0; i < (int)Category::Count; i++)
+	{
+		auto& entries = _entries[i];
+		for (auto it = entries.begin(); it != entries.end();)
+		{
+			if (it->second.HasOwner && it->second.Owner.expired())
+			{
+				Remove((Category)i, it->second.Bytes);
+				it = entries.erase(it);
+			}
+			else
+				++it;
+		}
+	}
+}
+
+size_t ResourceTracker::TextureBytes(GLuint handle, int faces)
+{
+	static const GLenum componentSizes[] = {
+		GL_TEXTURE_RED_SIZE, GL_TEXTURE_GREEN_SIZE, GL_TEXTURE_BLUE_SIZE,
+		GL_TEXTURE_ALPHA_SIZE, GL_TEXTURE_DEPTH_SIZE, GL_TEXTURE_STENCIL_SIZE
+	};
+
+	size_t total = 0;
+	//Levels that don't exist come back with a width of 0
+	for (int level = 0; level < 16; level++)
+	{
+		GLint width = 0, height = 0, depth = 0;
+		glGetTextureLevelParameteriv(handle, level, GL_TEXTURE_WIDTH, &width);
+		if (width <= 0)
+			break;
+		glGetTextureLevelParameteriv(handle, level, GL_TEXTURE_HEIGHT, &height);
+		glGetTextureLevelParameteriv(handle, level, GL_TEXTURE_DEPTH, &depth);
+
+		GLint compressed = 0;
+		glGetTextureLevelParameteriv(handle, level, GL_TEXTURE_COMPRESSED, &compressed);
+		if (compressed)
+		{
+			GLint size = 0;
+			glGetTextureLevelParameteriv(handle, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+			total += size_t(size);
+			continue;
+		}
+
+		GLint bits = 0;
+		for (GLenum component : componentSizes)
+		{
+			GLint size = 0;
+			glGetTextureLevelParameteriv(handle, level, component, &size);
+			bits += size;
+		}
+		total += size_t(width) * std::max(height, 1) * std::max(depth, 1) * ((bits + 7) / 8);
+	}
+	return total * faces;
+}
+
+size_t ResourceTracker::BufferBytes(GLuint handle)
+{
+	GLint64 size = 0;
+	glGetNamedBufferParameteri64v(handle, GL_BUFFER_SIZE, &size);
+	return size_t(std::max<GLint64>(size, 0));
+}
+
+const ResourceTracker::Totals& ResourceTracker::GetTotals(Category category)
+{
+	return _totals[(int)category];
+}
+
+const char* ResourceTracker::GetName(Category category)
+{
+	switch (category)
+	{
+	case Category::FramebufferColour: return "Framebuffer Colour";
+	case Category::FramebufferDepth: return "Framebuffer Depth";
+	case Category::Texture2D: return "Textures";
+	case Category::TextureCubeMap: return "Cube Maps";
+	case Category::Texture3D: return "3D Textures (LUT)";
+	case Category::VertexBuffer: return "Vertex/Index Buffers";
+	case Category::VertexArray: return "Vertex Arrays";
+	case Category::Shader: return "Shader Programs";
+	case Category::ReadbackBuffer: return "Readback Buffers";
+	case Category::LUTData: return "LUT Tables (CPU)";
+	case Category::CaptureBuffer: return "Capture Buffers (CPU)";
+	default: return "Unknown";
+	}
+}
+
+bool ResourceTracker::IsGpu(Category category)
+{
+	return category != Category::LUTData && category != Category::CaptureBuffer;
+}
+
+size_t ResourceTracker::GetGpuBytes()
+{
+	return _gpuBytes;
+}
+
+size_t ResourceTracker::GetCpuBytes()
+{
+	return _cpuBytes;
+}
+
+size_t ResourceTracker::GetPeakGpuBytes()
+{
+	return _peakGpuBytes;
+}
+
+size_t ResourceTracker::GetPeakCpuBytes()
+{
+	return _peakCpuBytes;
+}
+
+void ResourceTracker::RenderImGui()
+{
+	if (!ImGui::CollapsingHeader("Resources"))
+		return;
+
+	const float mb = 1.0f / (1024.0f * 1024.0f);
+	ImGui::Text("GPU: %.2f MB (peak %.2f MB)", _gpuBytes * mb, _peakGpuBytes * mb);
+	ImGui::Text("CPU: %.2f MB (peak %.2f MB)", _cpuBytes * mb, _peakCpuBytes * mb);
+
+	ImGui::Columns(4, "Resources");
+	ImGui::Text("Category");
+	ImGui::NextColumn();
+	ImGui::Text("Count");
+	ImGui::NextColumn();
+	ImGui::Text("MB");
+	ImGui::NextColumn();
+	ImGui::Text("Peak MB");
+	ImGui::NextColumn();
+	ImGui::Separator();
+	for (int i = 0; i < (int)Category::Count; i++)
+	{
+		const Totals& totals = _totals[i];
+		ImGui::Text("%s", GetName((Category)i));
+		ImGui::NextColumn();
+		ImGui::Text("%zu", totals.Count);
+		ImGui::NextColumn();
+		ImGui::Text("%.2f", totals.Bytes * mb);
+		ImGui::NextColumn();
+		ImGui::Text("%.2f", totals.PeakBytes * mb);
+		ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+}
+
+bool ResourceTracker::WriteJson(const std::string& path)
+{
+	nlohmann::json root;
+	root["units"] = "bytes";
+	root["gpu"]["bytes"] = _gpuBytes;
+	root["gpu"]["peak_bytes"] = _peakGpuBytes;
+	root["cpu"]["bytes"] = _cpuBytes;
+	root["cpu"]["peak_bytes"] = _peakCpuBytes;
+	for (int i = 0; i < (int)Category::Count; i++)
+	{
+		const Totals& totals = _totals[i];
+		nlohmann::json category;
+		category["memory"] = IsGpu((Category)i) ? "gpu" : "cpu";
+		category["count"] = totals.Count;
+		category["bytes"] = totals.Bytes;
+		category["peak_count"] = totals.PeakCount;
+		category["peak_bytes"] = totals.PeakBytes;
+		root["categories"][GetName((Category)i)] = category;
+	}
+
+	std::ofstream file(path);
+	if (!file.is_open())
+		return false;
+	file << root.dump(4);
+	return true;
+}
+
+void ResourceTracker::Add(Category category, size_t bytes)
+{
+	Totals& totals = _totals[(int)category];
+	totals.Count++;
+	totals.Bytes += bytes;
+	totals.PeakCount = std::max(totals.PeakCount, totals.Count);
+	totals.PeakBytes = std::max(totals.PeakBytes, totals.Bytes);
+
+	if (IsGpu(category))
+	{
+		_gpuBytes += bytes;
+		_peakGpuBytes = std::max(_peakGpuBytes, _gpuBytes);
+	}
+	else
+	{
+		_cpuBytes += bytes;
+		_peakCpuBytes = std::max(_peakCpuBytes, _cpuBytes);
+	}
+}
+
+void ResourceTracker::Remove(Category category, size_t bytes)
+{
+	Totals& totals = _totals[(int)category];
+	totals.Count--;
+	totals.Bytes -= bytes;
+	if (IsGpu(category))
+		_gpuBytes -= bytes;
+	else
+		_cpuBytes -= bytes;
+}
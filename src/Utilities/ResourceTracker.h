@@ -0,0 +1,101 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <Scene.h>
+#include <Texture2D.h>
+#include <Shader.h>
+#include <VertexArrayObject.h>
+
+//Keeps count of how much memory every GPU resource (and the CPU copies we hold on to) is using
+//*Resources we create are tracked and untracked by hand, toolkit ones are tied to their shared pointer
+//*and dropped once it expires
+class ResourceTracker abstract
+{
+public:
+	//What a resource is, each gets its own totals
+	enum class Category
+	{
+		FramebufferColour,
+		FramebufferDepth,
+		Texture2D,
+		TextureCubeMap,
+		Texture3D,
+		VertexBuffer,
+		VertexArray,
+		Shader,
+		ReadbackBuffer,
+		LUTData,
+		CaptureBuffer,
+		Count
+	};
+
+	//Totals for a category
+	struct Totals
+	{
+		size_t Count = 0;
+		size_t Bytes = 0;
+		size_t PeakCount = 0;
+		size_t PeakBytes = 0;
+	};
+
+	//Adds a resource, tracking the same id again replaces it
+	static void Track(Category category, uint64_t id, size_t bytes);
+	//Adds a resource that goes away when owner does
+	static void Track(Category category, uint64_t id, size_t bytes, const std::shared_ptr<void>& owner);
+	//Removes a resource (does nothing if it isn't tracked)
+	static void Untrack(Category category, uint64_t id);
+
+	//Helpers for toolkit resources, these ask GL how big they are
+	static void TrackTexture(const ITexture::sptr& texture, Category category = Category::Texture2D);
+	//Tracks the vertex array and every buffer attached to it
+	static void TrackMesh(const VertexArrayObject::sptr& mesh);
+	static void TrackShader(const Shader::sptr& shader);
+	//Tracks the mesh and shader of everything that renders
+	static void TrackScene(entt::registry& registry);
+
+	//Drops toolkit resources whose owners have been freed, call once a frame
+	static void Update();
+
+	//Size of a texture as the driver reports it, over every mip level (faces is 6 for cube maps)
+	static size_t TextureBytes(GLuint handle, int faces = 1);
+	//Size of a buffer's data store
+	static size_t BufferBytes(GLuint handle);
+
+	//Getters
+	static const Totals& GetTotals(Category category);
+	static const char* GetName(Category category);
+	//Does the category live on the GPU (otherwise it's CPU memory)
+	static bool IsGpu(Category category);
+	static size_t GetGpuBytes();
+	static size_t GetCpuBytes();
+	static size_t GetPeakGpuBytes();
+	static size_t GetPeakCpuBytes();
+
+	//Draws the totals per category (call inside an ImGui window)
+	static void RenderImGui();
+	//Writes the current and peak totals to a json file
+	static bool WriteJson(const std::string& path);
+
+private:
+	struct Entry
+	{
+		size_t Bytes = 0;
+		//Only set for toolkit resources
+		std::weak_ptr<void> Owner;
+		bool HasOwner = false;
+	};
+
+	//Adjusts the totals after a change in a category
+	static void Add(Category category, size_t bytes);
+	static void Remove(Category category, size_t bytes);
+
+	static std::unordered_map<uint64_t, Entry> _entries[(int)Category::Count];
+	static Totals _totals[(int)Category::Count];
+	static size_t _gpuBytes;
+	static size_t _cpuBytes;
+	static size_t _peakGpuBytes;
+	static size_t _peakCpuBytes;
+};
@@ -1,13 +1,404 @@
 #include "Util.h"
 
+#include <atomic>
+#include <utility>
+
+namespace
+{
+    //Seed every thread's generator starts from, bumping the generation makes them all reseed
+    std::atomic<unsigned> randomSeed(0);
+    std::atomic<uint64_t> randomGeneration(1);
+    //Stream 0 is the main thread's (set in Init), the rest go out in the order threads ask
+    std::atomic<uint64_t> nextStream(1);
+
+    struct ThreadRandom
+    {
+        Util::Random Generator;
+        uint64_t Generation = 0;
+        uint64_t Stream = 0;
+        bool HasStream = false;
+    };
+    thread_local ThreadRandom threadRandom;
+
+    uint64_t SplitMix64(uint64_t& x)
+    {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t RotateLeft(uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    //Lets the region sampler treat a float like a one component vector
+    template <typename T>
+    struct Components
+    {
+        static const int Count = T::length();
+        static float Get(const T& v, int i) { return v[i]; }
+        static float& Ref(T& v, int i) { return v[i]; }
+    };
+
+    template <>
+    struct Components<float>
+    {
+        static const int Count = 1;
+        static float Get(const float& v, int) { return v; }
+        static float& Ref(float& v, int) { return v; }
+    };
+
+    struct Box
+    {
+        float Min[4];
+        float Max[4];
+    };
+
+    //Does the avoid box cut into the region (an axis with no size only has to be inside the box)
+    bool Overlaps(const Box& region, const Box& box, int dims)
+    {
+        for (int i = 0; i < dims; i++)
+        {
+            if (region.Min[i] == region.Max[i])
+            {
+                if (box.Min[i] > region.Min[i] || box.Max[i] < region.Min[i])
+                    return false;
+            }
+            else if (box.Max[i] <= region.Min[i] || box.Min[i] >= region.Max[i])
+                return false;
+        }
+        return true;
+    }
+
+    //Splits the region into slabs along each axis in turn, at the edges of the boxes that cut into it
+    //*covering has the boxes that span the whole region on every axis before this one
+    //*A piece with no boxes left is free, one that a box still covers after the last axis is thrown out
+    void Decompose(int axis, int dims, const Box& region, const std::vector<Box>& avoid, const std::vector<int>& covering, std::vector<Box>& out)
+    {
+        if (covering.empty())
+        {
+            out.push_back(region);
+            return;
+        }
+        if (axis == dims)
+            return;
+        if (region.Min[axis] == region.Max[axis])
+        {
+            Decompose(axis + 1, dims, region, avoid, covering, out);
+            return;
+        }
+
+        std::vector<float> cuts = { region.Min[axis], region.Max[axis] };
+        for (int index : covering)
+        {
+            if (avoid[index].Min[axis] > region.Min[axis])
+                cuts.push_back(avoid[index].Min[axis]);
+            if (avoid[index].Max[axis] < region.Max[axis])
+                cuts.push_back(avoid[index].Max[axis]);
+        }
+        std::sort(cuts.begin(), cuts.end());
+        cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+
+        std::vector<int> next;
+        for (size_t i = 0; i + 1 < cuts.size(); i++)
+        {
+            Box slab = region;
+            slab.Min[axis] = cuts[i];
+            slab.Max[axis] = cuts[i + 1];
+
+            //The cuts are at every box edge, so a box either spans the slab or misses it
+            next.clear();
+            for (int index : covering)
+            {
+                if (avoid[index].Min[axis] <= slab.Min[axis] && avoid[index].Max[axis] >= slab.Max[axis])
+                    next.push_back(index);
+            }
+            Decompose(axis + 1, dims, slab, avoid, next, out);
+        }
+    }
+
+    //Splits from to to - 1 into the runs of ints that aren't in an avoid range, as (first, count)
+    int64_t AllowedInts(int from, int to, Util::Span<const int> avoidFrom, Util::Span<const int> avoidTo, std::vector<std::pair<int64_t, int64_t>>& allowed)
+    {
+        thread_local std::vector<std::pair<int64_t, int64_t>> avoid;
+        avoid.clear();
+        for (size_t i = 0; i < std::min(avoidFrom.size(), avoidTo.size()); i++)
+            avoid.emplace_back(std::min(avoidFrom[i], avoidTo[i]), std::max(avoidFrom[i], avoidTo[i]));
+        std::sort(avoid.begin(), avoid.end());
+
+        allowed.clear();
+        int64_t total = 0;
+        int64_t next = from;
+        for (const auto& range : avoid)
+        {
+            if (range.first > next)
+            {
+                int64_t end = std::min<int64_t>(range.first, to);
+                if (end > next)
+                {
+                    allowed.emplace_back(next, end - next);
+                    total += end - next;
+                }
+            }
+            next = std::max(next, range.second + 1);
+        }
+        if (next < to)
+        {
+            allowed.emplace_back(next, to - next);
+            total += to - next;
+        }
+        return total;
+    }
+
+    int PickAllowedInt(Util::Random& random, const std::vector<std::pair<int64_t, int64_t>>& allowed, int64_t total)
+    {
+        int64_t pick = random.NextUInt(uint32_t(total));
+        for (const auto& range : allowed)
+        {
+            if (pick < range.second)
+                return int(range.first + pick);
+            pick -= range.second;
+        }
+        return int(allowed.back().first);
+    }
+}
+
 bool Util::Init()
 {
     //Seeds random so we can use it
-    srand(time(NULL));
+    SetSeed(unsigned(time(NULL)));
+    SetThreadStream(0);
 
     return true;
 }
 
+void Util::SetSeed(unsigned seed)
+{
+    randomSeed = seed;
+    randomGeneration++;
+}
+
+unsigned Util::GetSeed()
+{
+    return randomSeed;
+}
+
+Util::Random::Random(uint64_t seed, uint64_t stream)
+{
+    Seed(seed, stream);
+}
+
+void Util::Random::Seed(uint64_t seed, uint64_t stream)
+{
+    //SplitMix64 spreads the seed over the whole state, the stream moves it somewhere unrelated
+    uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ull);
+    for (int i = 0; i < 4; i++)
+        _state[i] = SplitMix64(x);
+}
+
+uint64_t Util::Random::Next()
+{
+    uint64_t result = RotateLeft(_state[1] * 5, 7) * 9;
+    uint64_t t = _state[1] << 17;
+
+    _state[2] ^= _state[0];
+    _state[3] ^= _state[1];
+    _state[1] ^= _state[2];
+    _state[0] ^= _state[3];
+    _state[2] ^= t;
+    _state[3] = RotateLeft(_state[3], 45);
+
+    return result;
+}
+
+uint32_t Util::Random::NextUInt(uint32_t bound)
+{
+    //Lemire's multiply and shift, only retries for the few values that would be biased
+    uint64_t m = (Next() >> 32) * uint64_t(bound);
+    uint32_t low = uint32_t(m);
+    if (low < bound)
+    {
+        uint32_t threshold = uint32_t(-bound) % bound;
+        while (low < threshold)
+        {
+            m = (Next() >> 32) * uint64_t(bound);
+            low = uint32_t(m);
+        }
+    }
+    return uint32_t(m >> 32);
+}
+
+float Util::Random::NextFloat()
+{
+    //The top 24 bits fill a float's mantissa exactly
+    return float(Next() >> 40) * (1.0f / 16777216.0f);
+}
+
+float Util::Random::Range(float from, float to)
+{
+    return from + (to - from) * NextFloat();
+}
+
+int Util::Random::Range(int from, int to)
+{
+    if (to <= from)
+        return from;
+    return int(int64_t(from) + NextUInt(uint32_t(int64_t(to) - from)));
+}
+
+Util::Random& Util::GetRandom()
+{
+    ThreadRandom& local = threadRandom;
+    uint64_t generation = randomGeneration.load(std::memory_order_relaxed);
+    if (local.Generation != generation)
+    {
+        if (!local.HasStream)
+        {
+            local.Stream = nextStream++;
+            local.HasStream = true;
+        }
+        local.Generator.Seed(randomSeed, local.Stream);
+        local.Generation = generation;
+    }
+    return local.Generator;
+}
+
+void Util::SetThreadStream(uint64_t stream)
+{
+    threadRandom.Stream = stream;
+    threadRandom.HasStream = true;
+    //Reseed on the next use
+    threadRandom.Generation = 0;
+}
+
+template <typename T>
+Util::RegionSampler<T>::RegionSampler(const T& from, const T& to, Span<const T> avoidFrom, Span<const T> avoidTo)
+{
+    Set(from, to, avoidFrom, avoidTo);
+}
+
+template <typename T>
+void Util::RegionSampler<T>::Set(const T& from, const T& to, Span<const T> avoidFrom, Span<const T> avoidTo)
+{
+    const int dims = Components<T>::Count;
+
+    Box region;
+    for (int i = 0; i < dims; i++)
+    {
+        region.Min[i] = std::min(Components<T>::Get(from, i), Components<T>::Get(to, i));
+        region.Max[i] = std::max(Components<T>::Get(from, i), Components<T>::Get(to, i));
+        Components<T>::Ref(_from, i) = region.Min[i];
+        Components<T>::Ref(_size, i) = region.Max[i] - region.Min[i];
+    }
+
+    thread_local std::vector<Box> avoid;
+    thread_local std::vector<int> covering;
+    thread_local std::vector<Box> pieces;
+    avoid.clear();
+    covering.clear();
+    pieces.clear();
+    for (size_t i = 0; i < std::min(avoidFrom.size(), avoidTo.size()); i++)
+    {
+        Box box;
+        for (int j = 0; j < dims; j++)
+        {
+            box.Min[j] = std::min(Components<T>::Get(avoidFrom[i], j), Components<T>::Get(avoidTo[i], j));
+            box.Max[j] = std::max(Components<T>::Get(avoidFrom[i], j), Components<T>::Get(avoidTo[i], j));
+        }
+        if (Overlaps(region, box, dims))
+        {
+            covering.push_back(int(avoid.size()));
+            avoid.push_back(box);
+        }
+    }
+    Decompose(0, dims, region, avoid, covering, pieces);
+
+    _pieces.clear();
+    _cumulative.clear();
+    float total = 0.0f;
+    for (const Box& box : pieces)
+    {
+        Piece piece;
+        float volume = 1.0f;
+        for (int i = 0; i < dims; i++)
+        {
+            Components<T>::Ref(piece.Min, i) = box.Min[i];
+            Components<T>::Ref(piece.Size, i) = box.Max[i] - box.Min[i];
+            //Axes with no size don't count towards the volume
+            if (region.Max[i] > region.Min[i])
+                volume *= box.Max[i] - box.Min[i];
+        }
+        if (volume <= 0.0f)
+            continue;
+        total += volume;
+        _pieces.push_back(piece);
+        _cumulative.push_back(total);
+    }
+
+    //Nothing left to pick from, so fall back to the whole box rather than failing
+    _covered = _pieces.empty();
+    if (_covered)
+    {
+        _pieces.push_back({ _from, _size });
+        _cumulative.push_back(1.0f);
+    }
+}
+
+template <typename T>
+T Util::RegionSampler<T>::Sample(Random& random) const
+{
+    const int dims = Components<T>::Count;
+
+    size_t index = 0;
+    if (_pieces.size() > 1)
+    {
+        float pick = random.NextFloat() * _cumulative.back();
+        index = std::upper_bound(_cumulative.begin(), _cumulative.end(), pick) - _cumulative.begin();
+        index = std::min(index, _pieces.size() - 1);
+    }
+
+    const Piece& piece = _pieces[index];
+    T result = piece.Min;
+    for (int i = 0; i < dims; i++)
+        Components<T>::Ref(result, i) += Components<T>::Get(piece.Size, i) * random.NextFloat();
+    return result;
+}
+
+template <typename T>
+void Util::RegionSampler<T>::Fill(Random& random, Span<T> out) const
+{
+    //A local copy of the generator lets the compiler keep its state in registers
+    Random local = random;
+    for (T& value : out)
+        value = Sample(local);
+    random = local;
+}
+
+template <typename T>
+bool Util::RegionSampler<T>::IsCovered() const
+{
+    return _covered;
+}
+
+template <typename T>
+size_t Util::RegionSampler<T>::GetPieceCount() const
+{
+    return _covered ? 0 : _pieces.size();
+}
+
+template <typename T>
+float Util::RegionSampler<T>::GetArea() const
+{
+    return _covered ? 0.0f : _cumulative.back();
+}
+
+template class Util::RegionSampler<float>;
+template class Util::RegionSampler<glm::vec2>;
+template class Util::RegionSampler<glm::vec3>;
+template class Util::RegionSampler<glm::vec4>;
+
 bool Util::CheckNumBetween(int num, int min, int max)
 {
     //Is the num greater than the minimum
@@ -60,100 +451,78 @@ bool Util::CheckNumBetween(glm::vec4 num, glm::vec4 min, glm::vec4 max)
     return (x && y && z && w);
 }
 
-int Util::GetRandomNumberBetween(int from, int to, std::vector<int> avoidFrom, std::vector<int> avoidTo)
+int Util::GetRandomNumberBetween(int from, int to, Span<const int> avoidFrom, Span<const int> avoidTo)
 {
-    //Just the typical random number generation within range
-    int randomNum = (rand() % (to - from)) + from;
-
-    for (int i = 0; i < avoidFrom.size(); i++)
-    {
-        if (CheckNumBetween(randomNum, avoidFrom[i], avoidTo[i]))
-        {
-            return GetRandomNumberBetween(from, to, avoidFrom, avoidTo);
-        }
-    }
+    Random& random = GetRandom();
+    if (avoidFrom.empty())
+        return random.Range(from, to);
 
-    return randomNum;
+    //Pick straight from what's left over instead of retrying until we miss the avoid ranges
+    thread_local std::vector<std::pair<int64_t, int64_t>> allowed;
+    int64_t total = AllowedInts(from, to, avoidFrom, avoidTo, allowed);
+    if (total == 0)
+        return random.Range(from, to);
+    return PickAllowedInt(random, allowed, total);
 }
 
-float Util::GetRandomNumberBetween(float from, float to, std::vector<float> avoidFrom, std::vector<float> avoidTo)
+float Util::GetRandomNumberBetween(float from, float to, Span<const float> avoidFrom, Span<const float> avoidTo)
 {
-    //DO NOT DIVIDE BY Z    if (to == 0.0f || from == 0.0f)
-    {
-        //Just add very small number to make sure it isn't zero
-        to += 0.0001f;
-        from += 0.0001f;
-    }
-
-    //Uses static casting to convert rand to a float to allow us
-    //to divide it by RAND_MAX (which has been modified to suit our range)
-    //in order to convert it into a float range
-    float randomNum = from + static_cast<float>(rand()) / (static_cast<float>(RAND_MAX / (to - from)));
+    Random& random = GetRandom();
+    if (avoidFrom.empty())
+        return random.Range(from, to);
 
-    for (int i = 0; i < avoidFrom.size(); i++)
-    {
-        if (CheckNumBetween(randomNum, avoidFrom[i], avoidTo[i]))
-        {
-            return GetRandomNumberBetween(from, to, avoidFrom, avoidTo);
-        }
-    }
+    thread_local RegionSampler<float> sampler;
+    sampler.Set(from, to, avoidFrom, avoidTo);
+    return sampler.Sample(random);
+}
 
-    return randomNum;
+glm::vec2 Util::GetRandomNumberBetween(glm::vec2 from, glm::vec2 to, Span<const glm::vec2> avoidFrom, Span<const glm::vec2> avoidTo)
+{
+    thread_local RegionSampler<glm::vec2> sampler;
+    sampler.Set(from, to, avoidFrom, avoidTo);
+    return sampler.Sample(GetRandom());
 }
 
-glm::vec2 Util::GetRandomNumberBetween(glm::vec2 from, glm::vec2 to, std::vector <glm::vec2> avoidFrom, std::vector <glm::vec2> avoidTo)
+glm::vec3 Util::GetRandomNumberBetween(glm::vec3 from, glm::vec3 to, Span<const glm::vec3> avoidFrom, Span<const glm::vec3> avoidTo)
 {
-    //Calls the float version on individual components
-    glm::vec2 randomNum;
-    randomNum.x = GetRandomNumberBetween(from.x, to.x);
-    randomNum.y = GetRandomNumberBetween(from.y, to.y);
+    thread_local RegionSampler<glm::vec3> sampler;
+    sampler.Set(from, to, avoidFrom, avoidTo);
+    return sampler.Sample(GetRandom());
+}
 
-    for (int i = 0; i < avoidFrom.size(); i++)
-    {
-        if (CheckNumBetween(randomNum, avoidFrom[i], avoidTo[i]))
-        {
-            return GetRandomNumberBetween(from, to, avoidFrom, avoidTo);
-        }
-    }
+glm::vec4 Util::GetRandomNumberBetween(glm::vec4 from, glm::vec4 to, Span<const glm::vec4> avoidFrom, Span<const glm::vec4> avoidTo)
+{
+    thread_local RegionSampler<glm::vec4> sampler;
+    sampler.Set(from, to, avoidFrom, avoidTo);
+    return sampler.Sample(GetRandom());
+}
 
-    return randomNum;
+void Util::FillRandomNumbersBetween(Span<int> out, int from, int to, Span<const int> avoidFrom, Span<const int> avoidTo)
+{
+    Random local = GetRandom();
+    std::vector<std::pair<int64_t, int64_t>> allowed;
+    int64_t total = AllowedInts(from, to, avoidFrom, avoidTo, allowed);
+    for (int& value : out)
+        value = total == 0 ? local.Range(from, to) : PickAllowedInt(local, allowed, total);
+    GetRandom() = local;
 }
 
-glm::vec3 Util::GetRandomNumberBetween(glm::vec3 from, glm::vec3 to, std::vector <glm::vec3> avoidFrom, std::vector <glm::vec3> avoidTo)
+void Util::FillRandomNumbersBetween(Span<float> out, float from, float to, Span<const float> avoidFrom, Span<const float> avoidTo)
 {
-    //Calls the float version on individual components
-    glm::vec3 randomNum;
-    randomNum.x = GetRandomNumberBetween(from.x, to.x);
-    randomNum.y = GetRandomNumberBetween(from.y, to.y);
-    randomNum.z = GetRandomNumberBetween(from.z, to.z);
-    
-    for (int i = 0; i < avoidFrom.size(); i++)
-    {
-        if (CheckNumBetween(randomNum, avoidFrom[i], avoidTo[i]))
-        {
-            return GetRandomNumberBetween(from, to, avoidFrom, avoidTo);
-        }
-    }
+    RegionSampler<float>(from, to, avoidFrom, avoidTo).Fill(GetRandom(), out);
+}
 
-    return randomNum;
+void Util::FillRandomNumbersBetween(Span<glm::vec2> out, glm::vec2 from, glm::vec2 to, Span<const glm::vec2> avoidFrom, Span<const glm::vec2> avoidTo)
+{
+    RegionSampler<glm::vec2>(from, to, avoidFrom, avoidTo).Fill(GetRandom(), out);
 }
 
-glm::vec3 Util::GetRandomNumberBetween(glm::vec4 from, glm::vec4 to, std::vector <glm::vec4> avoidFrom, std::vector <glm::vec4> avoidTo)
+void Util::FillRandomNumbersBetween(Span<glm::vec3> out, glm::vec3 from, glm::vec3 to, Span<const glm::vec3> avoidFrom, Span<const glm::vec3> avoidTo)
 {
-    //Calls the float version on individual components
-    glm::vec4 randomNum;
-    randomNum.x = GetRandomNumberBetween(from.x, to.x);
-    randomNum.y = GetRandomNumberBetween(from.y, to.y);
-    randomNum.z = GetRandomNumberBetween(from.z, to.z);
-    randomNum.w = GetRandomNumberBetween(from.w, to.w);
-    
-    for (int i = 0; i < avoidFrom.size(); i++)
-    {
-        if (CheckNumBetween(randomNum, avoidFrom[i], avoidTo[i]))
-        {
-            return GetRandomNumberBetween(from, to, avoidFrom, avoidTo);
-        }
-    }
+    RegionSampler<glm::vec3>(from, to, avoidFrom, avoidTo).Fill(GetRandom(), out);
+}
 
-    return randomNum;
+void Util::FillRandomNumbersBetween(Span<glm::vec4> out, glm::vec4 from, glm::vec4 to, Span<const glm::vec4> avoidFrom, Span<const glm::vec4> avoidTo)
+{
+    RegionSampler<glm::vec4>(from, to, avoidFrom, avoidTo).Fill(GetRandom(), out);
 }
@@ -1,21 +1,119 @@
 #pragma once
 #include <GLM/glm.hpp>
+#include <algorithm>
+#include <cstdint>
 #include <time.h>
 #include <vector>
 
 namespace Util
 {
 	bool Init();
+	//Reseeds random, so a run can be repeated
+	//*Every thread's generator picks up the new seed the next time it's used
+	void SetSeed(unsigned seed);
+	unsigned GetSeed();
+
+	//A view of elements that live somewhere else, so functions can take a vector (or part of one) without copying it
+	//*std::span is C++20, this is the bit of it we need
+	template <typename T>
+	class Span
+	{
+	public:
+		Span() = default;
+		Span(T* data, size_t size) : _data(data), _size(size) {}
+		//Works for vectors (and anything else with data() and size()), a const vector gives a Span<const T>
+		template <typename Container>
+		Span(Container& container) : _data(container.data()), _size(container.size()) {}
+
+		T* begin() const { return _data; }
+		T* end() const { return _data + _size; }
+		T* data() const { return _data; }
+		size_t size() const { return _size; }
+		bool empty() const { return _size == 0; }
+		T& operator[](size_t index) const { return _data[index]; }
+
+	private:
+		T* _data = nullptr;
+		size_t _size = 0;
+	};
+
+	//xoshiro256** random number generator
+	//*Much faster than rand(), and small enough that every thread can have its own
+	class Random
+	{
+	public:
+		Random(uint64_t seed = 0, uint64_t stream = 0);
+
+		//Seeds the state, different streams with the same seed give unrelated sequences
+		void Seed(uint64_t seed, uint64_t stream = 0);
+
+		uint64_t Next();
+		//0 to bound - 1, without the bias of a modulo
+		uint32_t NextUInt(uint32_t bound);
+		//0 to 1 (not including 1)
+		float NextFloat();
+		//from to to (not including to)
+		float Range(float from, float to);
+		int Range(int from, int to);
+
+	private:
+		uint64_t _state[4];
+	};
+
+	//This thread's generator
+	//*It's seeded from SetSeed and the thread's stream, so each thread gets its own sequence
+	Random& GetRandom();
+	//Sets the stream this thread's generator uses (threads are given one in the order they first use it otherwise)
+	void SetThreadStream(uint64_t stream);
+
+	//Picks points uniformly from a box with other boxes cut out of it
+	//*The space that's left is split into boxes up front, so sampling picks straight from them and never retries
+	//*Works for float, vec2, vec3 and vec4, an axis with no size (from == to) just keeps that value
+	template <typename T>
+	class RegionSampler
+	{
+	public:
+		RegionSampler() = default;
+		RegionSampler(const T& from, const T& to, Span<const T> avoidFrom = Span<const T>(), Span<const T> avoidTo = Span<const T>());
+
+		//Sets up the box and the boxes to avoid (keeps the memory from last time)
+		void Set(const T& from, const T& to, Span<const T> avoidFrom = Span<const T>(), Span<const T> avoidTo = Span<const T>());
+
+		T Sample(Random& random) const;
+		//Fills out with samples, much faster than sampling one at a time
+		void Fill(Random& random, Span<T> out) const;
+
+		//Did the avoid boxes cover everything (samples then come from the whole box, so they never fail)
+		bool IsCovered() const;
+		//How many boxes the space was split into
+		size_t GetPieceCount() const;
+		//Size of the space that's left (length for floats, area for vec2 and so on), 0 if it's all covered
+		float GetArea() const;
+
+	private:
+		struct Piece
+		{
+			T Min;
+			T Size;
+		};
+
+		std::vector<Piece> _pieces;
+		//Running total of the piece volumes, for picking one in proportion to its size
+		std::vector<float> _cumulative;
+		T _from = T(0.0f);
+		T _size = T(0.0f);
+		bool _covered = false;
+	};
 
 	//Find templated type in vector
 	template <typename T>
-	static int FindInVector(T toFind, std::vector<T> findIn)
+	static int FindInVector(const T& toFind, const std::vector<T>& findIn)
 	{
 		auto iter = std::find(findIn.begin(), findIn.end(), toFind);
 
 		if (iter != findIn.end())
 		{
-			return std::distance(findIn.begin(), iter);
+			return int(std::distance(findIn.begin(), iter));
 		}
 		else
 		{
@@ -31,9 +129,18 @@ namespace Util
 	bool CheckNumBetween(glm::vec4 num, glm::vec4 min, glm::vec4 max);
 
 	//Get random number between two values, while avoiding multiple specific ranges of numbers (or none)
-	int GetRandomNumberBetween(int from, int to, std::vector<int> avoidFrom = std::vector<int>(), std::vector<int> avoidTo = std::vector<int>());
-	float GetRandomNumberBetween(float from, float to, std::vector<float> avoidFrom = std::vector<float>(), std::vector<float> avoidTo = std::vector<float>());
-	glm::vec2 GetRandomNumberBetween(glm::vec2 from, glm::vec2 to, std::vector <glm::vec2> avoidFrom = std::vector <glm::vec2>(), std::vector <glm::vec2> avoidTo = std::vector <glm::vec2>());
-	glm::vec3 GetRandomNumberBetween(glm::vec3 from, glm::vec3 to, std::vector <glm::vec3> avoidFrom = std::vector <glm::vec3>(), std::vector <glm::vec3> avoidTo = std::vector <glm::vec3>());
-	glm::vec3 GetRandomNumberBetween(glm::vec4 from, glm::vec4 to, std::vector <glm::vec4> avoidFrom = std::vector <glm::vec4>(), std::vector <glm::vec4> avoidTo = std::vector <glm::vec4>());
-}
\ No newline at end of file
+	//*Ints go from "from" to "to - 1", the avoid ranges include both ends
+	//*If the avoid ranges cover everything the avoid ranges are ignored
+	int GetRandomNumberBetween(int from, int to, Span<const int> avoidFrom = Span<const int>(), Span<const int> avoidTo = Span<const int>());
+	float GetRandomNumberBetween(float from, float to, Span<const float> avoidFrom = Span<const float>(), Span<const float> avoidTo = Span<const float>());
+	glm::vec2 GetRandomNumberBetween(glm::vec2 from, glm::vec2 to, Span<const glm::vec2> avoidFrom = Span<const glm::vec2>(), Span<const glm::vec2> avoidTo = Span<const glm::vec2>());
+	glm::vec3 GetRandomNumberBetween(glm::vec3 from, glm::vec3 to, Span<const glm::vec3> avoidFrom = Span<const glm::vec3>(), Span<const glm::vec3> avoidTo = Span<const glm::vec3>());
+	glm::vec4 GetRandomNumberBetween(glm::vec4 from, glm::vec4 to, Span<const glm::vec4> avoidFrom = Span<const glm::vec4>(), Span<const glm::vec4> avoidTo = Span<const glm::vec4>());
+
+	//Fills out with random numbers, the same as calling the above for each one but a lot faster
+	void FillRandomNumbersBetween(Span<int> out, int from, int to, Span<const int> avoidFrom = Span<const int>(), Span<const int> avoidTo = Span<const int>());
+	void FillRandomNumbersBetween(Span<float> out, float from, float to, Span<const float> avoidFrom = Span<const float>(), Span<const float> avoidTo = Span<const float>());
+	void FillRandomNumbersBetween(Span<glm::vec2> out, glm::vec2 from, glm::vec2 to, Span<const glm::vec2> avoidFrom = Span<const glm::vec2>(), Span<const glm::vec2> avoidTo = Span<const glm::vec2>());
+	void FillRandomNumbersBetween(Span<glm::vec3> out, glm::vec3 from, glm::vec3 to, Span<const glm::vec3> avoidFrom = Span<const glm::vec3>(), Span<const glm::vec3> avoidTo = Span<const glm::vec3>());
+	void FillRandomNumbersBetween(Span<glm::vec4> out, glm::vec4 from, glm::vec4 to, Span<const glm::vec4> avoidFrom = Span<const glm::vec4>(), Span<const glm::vec4> avoidTo = Span<const glm::vec4>());
+}
@@ -0,0 +1,319 @@
+#include "VideoCapture.h"
+#include "ResourceTracker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <Logging.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VIDEO_CAPTURE_SSE2
+#include <emmintrin.h>
+#endif
+
+VideoCapture::~VideoCapture()
+{
+	Stop();
+}
+
+bool VideoCapture::Start(const std::string& path, unsigned width, unsigned height, int fps, Format format, int queueDepth)
+{
+	Stop();
+
+	if (width == 0 || height == 0 || width % 2 != 0 || height % 2 != 0)
+	{
+		LOG_ERROR("Capture size has to be even, got {}x{}", width, height);
+		return false;
+	}
+
+	_file = fopen(path.c_str(), "wb");
+	if (_file == nullptr)
+	{
+		LOG_ERROR("Failed to open {} for capture", path);
+		return false;
+	}
+	//Bigger writes keep the disk busy with fewer calls
+	setvbuf(_file, nullptr, _IOFBF, 1 << 22);
+
+	_format = format;
+	_width = width;
+	_height = height;
+	_frameSize = size_t(width) * height * 3 / 2;
+	_written = 0;
+	_dropped = 0;
+	_highWater = 0;
+	_wrongSize = 0;
+	_convertTime = 0.0;
+	_converted = 0;
+	_writeTime = 0.0;
+	_stopping = false;
+
+	if (_format == Format::Y4M)
+		fprintf(_file, "YUV4MPEG2 W%u H%u F%d:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n", width, height, fps);
+
+	//All the buffers are made up front so capturing never allocates
+	_free.clear();
+	for (int i = 0; i < std::max(queueDepth, 1); i++)
+		_free.emplace_back(_frameSize);
+	ResourceTracker::Track(ResourceTracker::Category::CaptureBuffer, uint64_t(uintptr_t(this)), _free.size() * _frameSize);
+
+	_writer = std::thread(&VideoCapture::WriterLoop, this);
+	LOG_INFO("Capturing {}x{} at {} fps to {}", width, height, fps, path);
+	return true;
+}
+
+void VideoCapture::Stop()
+{
+	if (_file == nullptr)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_wake.notify_one();
+	if (_writer.joinable())
+		_writer.join();
+
+	fclose(_file);
+	_file = nullptr;
+
+	uint64_t written = _written;
+	LOG_INFO("Capture wrote {} frames, dropped {} ({} after the window changed size), queue peaked at {}", written, _dropped.load(), _wrongSize, _highWater);
+	if (written > 0)
+	{
+		//Dropped frames never got converted, so they don't count towards the average
+		LOG_INFO("Capture averaged {:.3f} ms converting and {:.3f} ms writing per frame ({:.1f} MB/s)",
+			_converted > 0 ? _convertTime / _converted * 1000.0 : 0.0, _writeTime / written * 1000.0,
+			_writeTime > 0.0 ? written * _frameSize / _writeTime / (1024.0 * 1024.0) : 0.0);
+	}
+
+	_queue.clear();
+	_free.clear();
+	ResourceTracker::Untrack(ResourceTracker::Category::CaptureBuffer, uint64_t(uintptr_t(this)));
+}
+
+bool VideoCapture::IsCapturing() const
+{
+	return _file != nullptr;
+}
+
+bool VideoCapture::Submit(const uint8_t* rgba, unsigned width, unsigned height)
+{
+	if (_file == nullptr)
+		return false;
+
+	//The stream can't change size partway through, so nothing more gets captured until it's restarted
+	if (width != _width || height != _height)
+	{
+		if (_wrongSize == 0)
+			LOG_WARN("Window changed size from {}x{} to {}x{}, capture is dropping every frame from here on", _width, _height, width, height);
+		_wrongSize++;
+		_dropped++;
+		return false;
+	}
+
+	//Grab a spare buffer, if there isn't one the writer is behind and this frame goes
+	std::vector<uint8_t> frame;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (_free.empty())
+		{
+			_dropped++;
+			return false;
+		}
+		frame.swap(_free.back());
+		_free.pop_back();
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	uint8_t* y = frame.data();
+	uint8_t* u = y + size_t(width) * height;
+	uint8_t* v = u + size_t(width / 2) * (height / 2);
+	//Start from the last row and walk up, so the video is the right way up
+	ptrdiff_t stride = ptrdiff_t(width) * 4;
+	ConvertRGBAToYUV420(rgba + (height - 1) * stride, -stride, width, height, y, u, v);
+	_convertTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	_converted++;
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_queue.push_back(std::move(frame));
+		_highWater = std::max(_highWater, int(_queue.size()));
+	}
+	_wake.notify_one();
+	return true;
+}
+
+void VideoCapture::WriterLoop()
+{
+	while (true)
+	{
+		std::vector<uint8_t> frame;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_wake.wait(lock, [this]() { return _stopping || !_queue.empty(); });
+			//Only stop once everything queued is on disk
+			if (_queue.empty())
+				return;
+			frame.swap(_queue.front());
+			_queue.pop_front();
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		if (_format == Format::Y4M)
+			fwrite("FRAME\n", 1, 6, _file);
+		fwrite(frame.data(), 1, frame.size(), _file);
+		_writeTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		_written++;
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_free.push_back(std::move(frame));
+	}
+}
+
+uint64_t VideoCapture::GetFramesWritten() const
+{
+	return _written;
+}
+
+uint64_t VideoCapture::GetFramesDropped() const
+{
+	return _dropped;
+}
+
+int VideoCapture::GetQueueHighWater() const
+{
+	return _highWater;
+}
+
+namespace
+{
+	//Converts one 2x2 block, the chroma is the average of the 4 pixels
+	inline void ConvertBlock(const uint8_t* top, const uint8_t* bottom, uint8_t* yTop, uint8_t* yBottom, uint8_t* u, uint8_t* v)
+	{
+		int r = 0, g = 0, b = 0;
+		const uint8_t* pixels[4] = { top, top + 4, bottom, bottom + 4 };
+		uint8_t* lumas[4] = { yTop, yTop + 1, yBottom, yBottom + 1 };
+		for (int i = 0; i < 4; i++)
+		{
+			int pr = pixels[i][0], pg = pixels[i][1], pb = pixels[i][2];
+			*lumas[i] = uint8_t(((66 * pr + 129 * pg + 25 * pb + 128) >> 8) + 16);
+			r += pr;
+			g += pg;
+			b += pb;
+		}
+
+		r = (r + 2) >> 2;
+		g = (g + 2) >> 2;
+		b = (b + 2) >> 2;
+		*u = uint8_t(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+		*v = uint8_t(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+	}
+}
+
+void VideoCapture::ConvertRGBAToYUV420Scalar(const uint8_t* rgba, ptrdiff_t stride, unsigned width, unsigned height,
+	uint8_t* y, uint8_t* u, uint8_t* v)
+{
+	unsigned chromaWidth = width / 2;
+	for (unsigned row = 0; row < height; row += 2)
+	{
+		const uint8_t* top = rgba + ptrdiff_t(row) * stride;
+		uint8_t* yTop = y + size_t(row) * width;
+		size_t chroma = size_t(row / 2) * chromaWidth;
+		for (unsigned x = 0; x < width; x += 2)
+			ConvertBlock(top + x * 4, top + stride + x * 4, yTop + x, yTop + width + x, u + chroma + x / 2, v + chroma + x / 2);
+	}
+}
+
+#ifdef VIDEO_CAPTURE_SSE2
+namespace
+{
+	//Splits 8 RGBA pixels into 16 bit R, G and B
+	inline void Deinterleave(const uint8_t* pixels, __m128i& r, __m128i& g, __m128i& b)
+	{
+		const __m128i mask = _mm_set1_epi32(0xFF);
+		__m128i low = _mm_loadu_si128((const __m128i*)pixels);
+		__m128i high = _mm_loadu_si128((const __m128i*)(pixels + 16));
+		//Everything fits in 8 bits, so the signed pack doesn't clamp anything
+		r = _mm_packs_epi32(_mm_and_si128(low, mask), _mm_and_si128(high, mask));
+		g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(low, 8), mask), _mm_and_si128(_mm_srli_epi32(high, 8), mask));
+		b = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(low, 16), mask), _mm_and_si128(_mm_srli_epi32(high, 16), mask));
+	}
+
+	//Luma of 8 pixels, the sum tops out at 56228 so it wraps correctly as unsigned 16 bit
+	inline __m128i Luma(__m128i r, __m128i g, __m128i b)
+	{
+		__m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(66)), _mm_mullo_epi16(g, _mm_set1_epi16(129))),
+			_mm_add_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(25)), _mm_set1_epi16(128)));
+		return _mm_add_epi16(_mm_srli_epi16(sum, 8), _mm_set1_epi16(16));
+	}
+
+	//Averages 2x2 blocks of two rows of 8 channel values, giving 4 values in the low 16 bits of each 32 bit lane
+	inline __m128i Average(__m128i top, __m128i bottom)
+	{
+		__m128i sum = _mm_add_epi16(top, bottom);
+		__m128i pairs = _mm_add_epi32(_mm_and_si128(sum, _mm_set1_epi32(0xFFFF)), _mm_srli_epi32(sum, 16));
+		return _mm_srli_epi32(_mm_add_epi32(pairs, _mm_set1_epi32(2)), 2);
+	}
+}
+#endif
+
+void VideoCapture::ConvertRGBAToYUV420(const uint8_t* rgba, ptrdiff_t stride, unsigned width, unsigned height,
+	uint8_t* y, uint8_t* u, uint8_t* v)
+{
+#ifdef VIDEO_CAPTURE_SSE2
+	unsigned chromaWidth = width / 2;
+	//8 pixels (4 chroma samples) at a time, anything left over on the right goes to the scalar version
+	unsigned simdWidth = width & ~7u;
+
+	for (unsigned row = 0; row < height; row += 2)
+	{
+		const uint8_t* top = rgba + ptrdiff_t(row) * stride;
+		const uint8_t* bottom = top + stride;
+		uint8_t* yTop = y + size_t(row) * width;
+		uint8_t* yBottom = yTop + width;
+		uint8_t* uRow = u + size_t(row / 2) * chromaWidth;
+		uint8_t* vRow = v + size_t(row / 2) * chromaWidth;
+
+		for (unsigned x = 0; x < simdWidth; x += 8)
+		{
+			__m128i rTop, gTop, bTop, rBottom, gBottom, bBottom;
+			Deinterleave(top + x * 4, rTop, gTop, bTop);
+			Deinterleave(bottom + x * 4, rBottom, gBottom, bBottom);
+
+			//Two rows of 8 luma values, packed to bytes
+			__m128i luma = _mm_packus_epi16(Luma(rTop, gTop, bTop), Luma(rBottom, gBottom, bBottom));
+			_mm_storel_epi64((__m128i*)(yTop + x), luma);
+			_mm_storel_epi64((__m128i*)(yBottom + x), _mm_srli_si128(luma, 8));
+
+			//4 averaged colours, back down to 16 bit (the top half is a copy that gets thrown away)
+			__m128i r = _mm_packs_epi32(Average(rTop, rBottom), Average(rTop, rBottom));
+			__m128i g = _mm_packs_epi32(Average(gTop, gBottom), Average(gTop, gBottom));
+			__m128i b = _mm_packs_epi32(Average(bTop, bBottom), Average(bTop, bBottom));
+
+			//These stay within +-28688, so signed 16 bit is enough
+			__m128i round = _mm_set1_epi16(128);
+			__m128i chromaU = _mm_add_epi16(_mm_sub_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(112)),
+				_mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(38)), _mm_mullo_epi16(g, _mm_set1_epi16(74)))), round);
+			__m128i chromaV = _mm_add_epi16(_mm_sub_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(112)),
+				_mm_add_epi16(_mm_mullo_epi16(g, _mm_set1_epi16(94)), _mm_mullo_epi16(b, _mm_set1_epi16(18)))), round);
+			chromaU = _mm_add_epi16(_mm_srai_epi16(chromaU, 8), round);
+			chromaV = _mm_add_epi16(_mm_srai_epi16(chromaV, 8), round);
+
+			//Low 4 bytes of each are the samples we want
+			__m128i chroma = _mm_packus_epi16(chromaU, chromaV);
+			int uBytes = _mm_cvtsi128_si32(chroma);
+			int vBytes = _mm_cvtsi128_si32(_mm_srli_si128(chroma, 8));
+			memcpy(uRow + x / 2, &uBytes, 4);
+			memcpy(vRow + x / 2, &vBytes, 4);
+		}
+
+		//The columns the SIMD loop didn't get to
+		for (unsigned x = simdWidth; x < width; x += 2)
+			ConvertBlock(top + x * 4, bottom + x * 4, yTop + x, yBottom + x, uRow + x / 2, vRow + x / 2);
+	}
+#else
+	ConvertRGBAToYUV420Scalar(rgba, stride, width, height, y, u, v);
+#endif
+}
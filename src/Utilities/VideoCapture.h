@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Streams frames to a .y4m (or headerless raw YUV420) file
+//*Frames are converted to YUV420 on the calling thread (straight out of the mapped pixel buffer),
+//*then a writer thread puts them on disk. The queue between them is bounded, and frames that
+//*arrive while it's full are dropped (and counted) instead of making the render loop wait
+class VideoCapture
+{
+public:
+	enum class Format
+	{
+		//YUV4MPEG2, plays in ffplay/mpv and most editors
+		Y4M,
+		//Just the planes back to back, the size and rate have to be given to whatever reads it
+		Raw
+	};
+
+	VideoCapture() = default;
+	~VideoCapture();
+
+	//Opens the file and starts the writer thread
+	//*Width and height have to be even, queueDepth is how many frames can wait on the disk
+	bool Start(const std::string& path, unsigned width, unsigned height, int fps = 60, Format format = Format::Y4M, int queueDepth = 8);
+	//Writes everything still queued, then closes the file
+	void Stop();
+	bool IsCapturing() const;
+
+	//Queues a frame of RGBA8 pixels (bottom row first, like glReadPixels)
+	//*Returns false if the frame was dropped, which happens to every frame once the size stops matching the stream's
+	bool Submit(const uint8_t* rgba, unsigned width, unsigned height);
+
+	uint64_t GetFramesWritten() const;
+	uint64_t GetFramesDropped() const;
+	//Most frames that were ever waiting at once
+	int GetQueueHighWater() const;
+
+	//Converts RGBA8 to planar YUV420 (BT.601, limited range), averaging each 2x2 block for the chroma
+	//*stride is the distance between rows in bytes, a negative one flips the image
+	static void ConvertRGBAToYUV420(const uint8_t* rgba, ptrdiff_t stride, unsigned width, unsigned height,
+		uint8_t* y, uint8_t* u, uint8_t* v);
+	//The plain version, used for the edges and where SSE2 isn't available
+	static void ConvertRGBAToYUV420Scalar(const uint8_t* rgba, ptrdiff_t stride, unsigned width, unsigned height,
+		uint8_t* y, uint8_t* u, uint8_t* v);
+
+private:
+	//Pulls frames off the queue and writes them
+	void WriterLoop();
+
+	FILE* _file = nullptr;
+	Format _format = Format::Y4M;
+	unsigned _width = 0;
+	unsigned _height = 0;
+	size_t _frameSize = 0;
+
+	std::thread _writer;
+	std::mutex _mutex;
+	std::condition_variable _wake;
+	bool _stopping = false;
+
+	//Frames waiting to be written, and spare buffers to convert into (there are never more than queueDepth buffers)
+	std::deque<std::vector<uint8_t>> _queue;
+	std::vector<std::vector<uint8_t>> _free;
+
+	std::atomic<uint64_t> _written{ 0 };
+	std::atomic<uint64_t> _dropped{ 0 };
+	int _highWater = 0;
+	//Frames dropped because the window changed size (counted in _dropped too), it's only logged the first time
+	uint64_t _wrongSize = 0;
+	//Time spent converting and writing, and how many frames were converted, for the summary
+	double _convertTime = 0.0;
+	uint64_t _converted = 0;
+	double _writeTime = 0.0;
+};
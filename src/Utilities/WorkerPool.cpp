@@ -0,0 +1,87 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+WorkerPool::WorkerPool(int threads) :
+	_next(0)
+{
+	if (threads <= 0)
+		threads = std::max(1, int(std::thread::hardware_concurrency()));
+
+	//The caller is the first thread
+	for (int i = 1; i < threads; i++)
+		_threads.emplace_back(&WorkerPool::WorkerLoop, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_wake.notify_all();
+	for (std::thread& thread : _threads)
+		thread.join();
+}
+
+void WorkerPool::ParallelFor(size_t count, const std::function<void(size_t)>& job)
+{
+	if (count == 0)
+		return;
+
+	//Not worth waking anyone up for
+	if (_threads.empty() || count == 1)
+	{
+		for (size_t i = 0; i < count; i++)
+			job(i);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_job = &job;
+		_count = count;
+		_next = 0;
+		_busy = _threads.size();
+		_loop++;
+	}
+	_wake.notify_all();
+
+	RunJobs();
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_done.wait(lock, [this]() { return _busy == 0; });
+	_job = nullptr;
+}
+
+int WorkerPool::GetThreadCount() const
+{
+	return int(_threads.size()) + 1;
+}
+
+void WorkerPool::WorkerLoop()
+{
+	uint64_t loop = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_wake.wait(lock, [this, loop]() { return _stopping || _loop != loop; });
+			if (_stopping)
+				return;
+			loop = _loop;
+		}
+
+		RunJobs();
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (--_busy == 0)
+			_done.notify_one();
+	}
+}
+
+void WorkerPool::RunJobs()
+{
+	for (size_t i = _next++; i < _count; i = _next++)
+		(*_job)(i);
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//A fixed set of threads that share out the iterations of a loop
+//*The thread calling ParallelFor works through the loop too, so a pool of 1 just runs it in place
+class WorkerPool
+{
+public:
+	//0 uses one thread per core
+	explicit WorkerPool(int threads = 0);
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	//Calls job for every index below count, spread over the threads, and waits until they're all done
+	//*The order the indices run in isn't fixed, so jobs should only write to their own index's results
+	void ParallelFor(size_t count, const std::function<void(size_t)>& job);
+
+	//Threads working on a loop, counting the one that calls ParallelFor
+	int GetThreadCount() const;
+
+private:
+	void WorkerLoop();
+	//Takes indices until there are none left
+	void RunJobs();
+
+	std::vector<std::thread> _threads;
+	std::mutex _mutex;
+	std::condition_variable _wake;
+	std::condition_variable _done;
+
+	const std::function<void(size_t)>* _job = nullptr;
+	size_t _count = 0;
+	std::atomic<size_t> _next;
+	//Workers that haven't finished the current loop
+	size_t _busy = 0;
+	//Goes up every loop, so workers can tell there's a new one
+	uint64_t _loop = 0;
+	bool _stopping = false;
+};
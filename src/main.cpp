@@ -4,6 +4,9 @@
 #include <filesystem>
 #include <json.hpp>
 #include <fstream>
+#include <climits>
+#include <chrono>
+#include <map>
 
 #include <Texture2D.h>
 #include <Texture2DData.h>
@@ -23,27 +26,90 @@
 
 #include <Behaviours/CameraControlBehaviour.h>
 #include <Behaviours/RotateObjectBehaviour.h>
+#include <Behaviours/CameraPathBehaviour.h>
 
 #include <IBehaviour.h>
 #include <FollowPathBehaviour.h>
 #include <SimpleMoveBehaviour.h>
 
-int main() {
-	int frameIx = 0;
-	float fpsBuffer[128];
-	float minFps, maxFps, avgFps;
+int main(int argc, char** argv) {
 	int selectedVao = 0; // select cube by default
+	int exitCode = 0;
 	std::vector<GameObject> controllables;
 
-	BackendHandler::InitAll();
+	LaunchOptions options = LaunchOptions::Parse(argc, argv);
+	if (!options.Valid) {
+		LaunchOptions::PrintUsage();
+		return 1;
+	}
+
+	// The microbenchmarks mostly don't need GL, so they run before (and without) the rest of the app
+	if (options.MicroBench) {
+		bool hasContext = BackendHandler::InitAllHeadless(options.Width, options.Height);
+		if (!hasContext)
+			printf("No GL context, benchmarks that need one will be skipped\n");
+		Util::SetSeed(options.Seed);
+
+		CpuBenchmarks::RegisterAll();
+		int result = MicroBenchmark::RunAll(options.MicroBenchFilter, options.MicroBenchOutput, hasContext, options.MinTime, options.Repetitions);
+
+		if (hasContext) {
+			GpuProfiler::Shutdown();
+			BackendHandler::ShutdownHeadless();
+		}
+		Logger::Uninitialize();
+		return result;
+	}
+
+	ObjParser::Threads = options.ObjThreads;
+
+	// The mesh report only reads the models, so it doesn't need GL either
+	if (options.MeshReport) {
+		Logger::Init();
+		int result = MeshOptimizer::WriteReport("models", options.MeshReportOutput) ? 0 : 1;
+		Logger::Uninitialize();
+		return result;
+	}
+	MeshOptimizer::Enabled = !options.NoMeshOptimize;
+	VertexPacking::Enabled = !options.NoVertexPacking;
+
+	if (options.Headless) {
+		if (!BackendHandler::InitAllHeadless(options.Width, options.Height)) {
+			// Nothing that needs the context has started yet, so only the backend and logger need undoing
+			printf("Could not create a headless context\n");
+			BackendHandler::ShutdownHeadless();
+			Logger::Uninitialize();
+			return 1;
+		}
+	}
+	else {
+		BackendHandler::InitAll();
+	}
 
 	// Let OpenGL know that we want debug output, and route it to our handler function
+	// The handler hands messages to a logging thread, so it's cheap enough to leave on
+	GlDebugLog::Start();
 	glEnable(GL_DEBUG_OUTPUT);
 	glDebugMessageCallback(BackendHandler::GlDebugMessage, nullptr);
 
 	// Enable texturing
 	glEnable(GL_TEXTURE_2D);
 
+	// Recordings keep the seed, so a replay gets the same world and random numbers as well as the same input
+	// This has to be done before anything is generated, streaming takes its world seed from the first random number
+	if (!options.ReplayPath.empty()) {
+		if (Input::StartReplay(options.ReplayPath))
+			options.Seed = Input::GetReplaySeed();
+		else {
+			printf("Could not replay %s\n", options.ReplayPath.c_str());
+			exitCode = 1;
+		}
+	}
+	else if (!options.RecordPath.empty()) {
+		if (!Input::StartRecording(options.RecordPath, options.Seed))
+			printf("Could not record to %s\n", options.RecordPath.c_str());
+	}
+
 	// Push another scope so most memory should be freed *before* we exit the app
 	{
 		#pragma region Shader and ImGui
@@ -97,6 +163,8 @@ int main() {
 
 		int activeEffect = 2;
 		std::vector<PostEffect*> effects;
+		// Names for the GPU timings, these match up with effects
+		std::vector<const char*> effectNames;
 
 		GreyscaleEffect* greyscaleEffect;
 
@@ -104,6 +172,20 @@ int main() {
 
 		BloomEffect* bloomEffect;
 
+		UpscaleEffect* upscaleEffect;
+
+		// Scales the scene buffer to try and hold our target frame time
+		DynamicResolution dynamicResolution;
+
+		// Raw frame times and percentiles, dumped to json on exit
+		FrameStats frameStats;
+
+		// Behaviours tick at a fixed rate, and rendering blends between the last two ticks
+		FixedTimestep fixedTimestep;
+		fixedTimestep.Enabled = options.TickRate > 0.0f;
+		fixedTimestep.TickRate = options.TickRate > 0.0f ? options.TickRate : 60.0f;
+		EnvironmentGenerator::WorkerThreads = options.GenerationThreads;
+
 		// We'll add some ImGui controls to control our shader
 		BackendHandler::imGuiCallbacks.push_back([&]() {
 			if (ImGui::Checkbox("No Lighting", &noLighting)) {
@@ -164,6 +246,8 @@ int main() {
 			shader->SetUniform("u_NoLight", (int)noLighting);
 			shader->SetUniform("u_SpecularOnly", (int)specularOnly);
 			shader->SetUniform("u_AmbientOnly", (int)ambientOnly);
+			// Impostors are captured unlit, so far away things only get the ambient light when lighting is on
+			LodSystem::ImpostorLighting = noLighting ? glm::vec3(1.0f) : ambientCol * ambientPow;
 			bloomEffect->SetShaderUniform("u_ApplyBloom", (int)applyBloom);
 			/*if (ImGui::CollapsingHeader("Effect Controls"))
 			{
@@ -244,16 +328,45 @@ int main() {
 
 			ImGui::Text("Q/E -> Yaw\nLeft/Right -> Roll\nUp/Down -> Pitch\nY -> Toggle Mode");*/
 
-			minFps = FLT_MAX;
-			maxFps = 0;
-			avgFps = 0;
-			for (int ix = 0; ix < 128; ix++) {
-				if (fpsBuffer[ix] < minFps) { minFps = fpsBuffer[ix]; }
-				if (fpsBuffer[ix] > maxFps) { maxFps = fpsBuffer[ix]; }
-				avgFps += fpsBuffer[ix];
+			frameStats.RenderImGui();
+			ResourceTracker::RenderImGui();
+			GlDebugLog::RenderImGui();
+			EnvironmentGenerator::RenderStreamingImGui();
+			LodSystem::RenderImGui();
+			if (EnvironmentGenerator::GetTerrain() != nullptr)
+				EnvironmentGenerator::GetTerrain()->RenderImGui();
+
+			if (ImGui::CollapsingHeader("Dynamic Resolution"))
+			{
+				ImGui::Checkbox("Enabled", &dynamicResolution.Enabled);
+				ImGui::SliderFloat("Target Frame Time (ms)", &dynamicResolution.TargetFrameTime, 4.0f, 50.0f);
+				ImGui::SliderFloat("Min Scale", &dynamicResolution.MinScale, 0.5f, dynamicResolution.MaxScale);
+
+				float sharpness = upscaleEffect->GetSharpness();
+				if (ImGui::SliderFloat("Sharpness", &sharpness, 0.0f, 1.0f))
+				{
+					upscaleEffect->SetSharpness(sharpness);
+				}
+
+				ImGui::Text("State: %s", dynamicResolution.GetStateName());
+				ImGui::Text("Scale: %.3f (applied %.2f)", dynamicResolution.GetScale(), dynamicResolution.GetAppliedScale());
+				ImGui::Text("Scene Resolution: %u x %u", dynamicResolution.GetWidth(), dynamicResolution.GetHeight());
+				ImGui::Text("Filtered Frame Time: %.2f ms", dynamicResolution.GetFilteredFrameTime());
+				ImGui::Text("Error: %.3f Integral: %.3f", dynamicResolution.GetError(), dynamicResolution.GetIntegral());
+			}
+
+			if (ImGui::CollapsingHeader("Simulation"))
+			{
+				ImGui::Checkbox("Fixed Timestep", &fixedTimestep.Enabled);
+				ImGui::SliderFloat("Tick Rate (Hz)", &fixedTimestep.TickRate, 10.0f, 240.0f);
+				ImGui::Checkbox("Interpolate", &fixedTimestep.Interpolate);
+				ImGui::SliderInt("Max Ticks Per Frame", &fixedTimestep.MaxTicks, 1, 16);
+				ImGui::Text("Ticks: %d this frame, %llu total", fixedTimestep.GetTicks(), (unsigned long long)fixedTimestep.GetTotalTicks());
+				ImGui::Text("Alpha: %.3f", fixedTimestep.GetAlpha());
+				ImGui::Text("Dropped: %.3f s", fixedTimestep.GetDroppedTime());
 			}
-			ImGui::PlotLines("FPS", fpsBuffer, 128);
-			ImGui::Text("MIN: %f MAX: %f AVG: %f", minFps, maxFps, avgFps / 128.0f);
+
+			GpuProfiler::RenderImGui();
 			});
 
 		#pragma endregion 
@@ -302,6 +415,14 @@ int main() {
 		// Clear it with a white colour
 		texture2->Clear();
 
+		// Count the textures towards the resource totals, they're dropped again once they're freed
+		for (const Texture2D::sptr& loaded : { diffuse, diffuse2, specular, reflectivity, legodiffuse1, legospecular1, legodiffuse2,
+			legodiffuse3, legodiffuse4, legodiffuse5, nospecular, darkspecular, offwhitespecular, legoblockred, legoblockbrown, texture2 })
+			ResourceTracker::TrackTexture(loaded);
+		ResourceTracker::TrackTexture(environmentMap, ResourceTracker::Category::TextureCubeMap);
+		ResourceTracker::TrackShader(passthroughShader);
+		ResourceTracker::TrackShader(colourCorrectionShader);
+
 		#pragma endregion
 
 		///////////////////////////////////// Scene Generation //////////////////////////////////////////////////
@@ -311,6 +432,7 @@ int main() {
 		GameScene::RegisterComponentType<RendererComponent>();
 		GameScene::RegisterComponentType<BehaviourBinding>();
 		GameScene::RegisterComponentType<Camera>();
+		GameScene::RegisterComponentType<InterpolatedTransform>();
 
 		// Create a scene, and set it to be the active scene in the application
 		GameScene::sptr scene = GameScene::Create("test");
@@ -419,15 +541,17 @@ int main() {
 
 		GameObject LegoFloor = scene->CreateEntity("lego_floor");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/LegoFloor.obj");
-			LegoFloor.emplace<RendererComponent>().SetMesh(vao).SetMaterial(legoblock1);
+			LodChain::sptr lods = LodChain::LoadFromFile("models/LegoFloor.obj");
+			LegoFloor.emplace<LodGroup>().Chain = lods;
+			LegoFloor.emplace<RendererComponent>().SetMesh(lods->Levels[0].Mesh).SetMaterial(legoblock1);
 			LegoFloor.get<Transform>().SetLocalPosition(0.0f, 0.0f, 0.0f);
 		}
 
 		GameObject LegoTable = scene->CreateEntity("lego_table");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/LegoTable.obj");
-			LegoTable.emplace<RendererComponent>().SetMesh(vao).SetMaterial(legoblock2);
+			LodChain::sptr lods = LodChain::LoadFromFile("models/LegoTable.obj");
+			LegoTable.emplace<LodGroup>().Chain = lods;
+			LegoTable.emplace<RendererComponent>().SetMesh(lods->Levels[0].Mesh).SetMaterial(legoblock2);
 			LegoTable.get<Transform>().SetLocalPosition(0.0f, 0.0f, 0.0f);
 		}
 
@@ -446,39 +570,44 @@ int main() {
 
 		GameObject LegoCharacter1 = scene->CreateEntity("lego_character");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/LegoCharacter.obj");
-			LegoCharacter1.emplace<RendererComponent>().SetMesh(vao).SetMaterial(legocharacter1);
+			LodChain::sptr lods = LodChain::LoadFromFile("models/LegoCharacter.obj");
+			LegoCharacter1.emplace<LodGroup>().Chain = lods;
+			LegoCharacter1.emplace<RendererComponent>().SetMesh(lods->Levels[0].Mesh).SetMaterial(legocharacter1);
 			LegoCharacter1.get<Transform>().SetLocalPosition(0.0f, -3.0f, 0.0f);
 		}
 
 		GameObject LegoCharacter2 = scene->CreateEntity("lego_character1");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/LegoCharacter.obj");
-			LegoCharacter2.emplace<RendererComponent>().SetMesh(vao).SetMaterial(legocharacter2);
+			LodChain::sptr lods = LodChain::LoadFromFile("models/LegoCharacter.obj");
+			LegoCharacter2.emplace<LodGroup>().Chain = lods;
+			LegoCharacter2.emplace<RendererComponent>().SetMesh(lods->Levels[0].Mesh).SetMaterial(legocharacter2);
 			LegoCharacter2.get<Transform>().SetLocalPosition(3.0f, 0.0f, 0.0f);
 			LegoCharacter2.get<Transform>().SetLocalRotation(0, 0, 90);
 		}
 
 		GameObject LegoCharacter3 = scene->CreateEntity("lego_character2");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/LegoCharacter.obj");
-			LegoCharacter3.emplace<RendererComponent>().SetMesh(vao).SetMaterial(legocharacter3);
+			LodChain::sptr lods = LodChain::LoadFromFile("models/LegoCharacter.obj");
+			LegoCharacter3.emplace<LodGroup>().Chain = lods;
+			LegoCharacter3.emplace<RendererComponent>().SetMesh(lods->Levels[0].Mesh).SetMaterial(legocharacter3);
 			LegoCharacter3.get<Transform>().SetLocalPosition(-3.0f, 0.0f, 0.0f);
 			LegoCharacter3.get<Transform>().SetLocalRotation(0, 0, -90);
 		}
 
 		GameObject LegoCharacter4 = scene->CreateEntity("lego_character3");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/LegoCharacter.obj");
-			LegoCharacter4.emplace<RendererComponent>().SetMesh(vao).SetMaterial(legocharacter4);
+			LodChain::sptr lods = LodChain::LoadFromFile("models/LegoCharacter.obj");
+			LegoCharacter4.emplace<LodGroup>().Chain = lods;
+			LegoCharacter4.emplace<RendererComponent>().SetMesh(lods->Levels[0].Mesh).SetMaterial(legocharacter4);
 			LegoCharacter4.get<Transform>().SetLocalPosition(0.0f, 3.0f, 0.0f);
 			LegoCharacter4.get<Transform>().SetLocalRotation(0, 0, 180);
 		}
 
 		GameObject LegoCharacter5 = scene->CreateEntity("lego_character4");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/LegoHead.obj");
-			LegoCharacter5.emplace<RendererComponent>().SetMesh(vao).SetMaterial(legocharacter5);
+			LodChain::sptr lods = LodChain::LoadFromFile("models/LegoHead.obj");
+			LegoCharacter5.emplace<LodGroup>().Chain = lods;
+			LegoCharacter5.emplace<RendererComponent>().SetMesh(lods->Levels[0].Mesh).SetMaterial(legocharacter5);
 			LegoCharacter5.get<Transform>().SetLocalPosition(0.0f, 0.0f, 3.5f);
 			BehaviourBinding::Bind<RotateObjectBehaviour>(LegoCharacter5);
 
@@ -504,8 +633,122 @@ int main() {
 			BehaviourBinding::Bind<CameraControlBehaviour>(cameraObject);
 		}
 
+		// Props for the benchmark scenes, these get spawned in by the environment generator
+		ShaderMaterial::sptr propMaterial = ShaderMaterial::Create();
+		propMaterial->Shader = shader;
+		propMaterial->Set("s_Diffuse", legoblockbrown);
+		propMaterial->Set("s_Specular", nospecular);
+		propMaterial->Set("u_Shininess", 2.0f);
+		propMaterial->Set("u_TextureMix", 0.0f);
+
+		// The same look, but with the model matrices coming from each instance, for the instanced benchmark scenes
+		Shader::sptr instancedShader = Shader::Create();
+		instancedShader->LoadShaderPartFromFile("shaders/instanced_vert.glsl", GL_VERTEX_SHADER);
+		instancedShader->LoadShaderPartFromFile("shaders/frag_blinn_phong_textured.glsl", GL_FRAGMENT_SHADER);
+		instancedShader->Link();
+		ShaderMaterial::sptr propInstancedMaterial = ShaderMaterial::Create();
+		propInstancedMaterial->Shader = instancedShader;
+		propInstancedMaterial->Set("s_Diffuse", legoblockbrown);
+		propInstancedMaterial->Set("s_Specular", nospecular);
+		propInstancedMaterial->Set("u_Shininess", 2.0f);
+		propInstancedMaterial->Set("u_TextureMix", 0.0f);
+		EnvironmentGenerator::SetInstancedMaterial(propMaterial, propInstancedMaterial);
+
+		// Runs through each of the benchmark scenes with the same seed and camera path every time
+		std::unique_ptr<BenchmarkRunner> benchmark;
+		if (options.Benchmark) {
+			std::vector<BenchmarkRunner::Scene> scenes = BenchmarkRunner::FilterScenes(BenchmarkRunner::DefaultScenes(), options.Scenes);
+			if (scenes.empty()) {
+				printf("No benchmark scenes matched %s\n", options.Scenes.c_str());
+				exitCode = 1;
+			}
+			else {
+				benchmark = std::make_unique<BenchmarkRunner>(scenes, options.Frames);
+				// Each scene's frames have to still be in the frame stats ring when they get copied out
+				if (benchmark->GetFramesNeeded() > FrameStats::CAPACITY) {
+					printf("--frames %d is too many for a benchmark, each scene's frames and the next one's warmup have to fit in %zu\n",
+						options.Frames, FrameStats::CAPACITY);
+					exitCode = 1;
+					benchmark.reset();
+				}
+			}
+		}
+		if (benchmark) {
+			// Keep the props off of the table in the middle
+			std::vector<glm::vec2> avoidFrom = { glm::vec2(-6.0f, -6.0f) };
+			std::vector<glm::vec2> avoidTo = { glm::vec2(6.0f, 6.0f) };
+			EnvironmentGenerator::AddObjectToGeneration("models/simplePine.obj", propMaterial, 0, glm::vec2(-50.0f), glm::vec2(50.0f), avoidFrom, avoidTo);
+			EnvironmentGenerator::AddObjectToGeneration("models/simpleTree.obj", propMaterial, 0, glm::vec2(-50.0f), glm::vec2(50.0f), avoidFrom, avoidTo);
+			EnvironmentGenerator::AddObjectToGeneration("models/simpleRock.obj", propMaterial, 0, glm::vec2(-50.0f), glm::vec2(50.0f), avoidFrom, avoidTo);
+
+			// The camera flies a fixed loop around the scene instead of taking input
+			BehaviourBinding::Get<CameraControlBehaviour>(cameraObject)->Enabled = false;
+			auto cameraPath = BehaviourBinding::Bind<CameraPathBehaviour>(cameraObject);
+			cameraPath->Points.push_back({ 8.0f, 0.0f, 4.0f });
+			cameraPath->Points.push_back({ 0.0f, 8.0f, 6.0f });
+			cameraPath->Points.push_back({ -20.0f, 20.0f, 10.0f });
+			cameraPath->Points.push_back({ -8.0f, 0.0f, 4.0f });
+			cameraPath->Points.push_back({ 0.0f, -8.0f, 2.5f });
+			cameraPath->Points.push_back({ 20.0f, -20.0f, 10.0f });
+			cameraPath->Target = glm::vec3(0.0f, 0.0f, 1.0f);
+			cameraPath->Speed = 6.0f;
+
+			benchmark->SetupScene = [&, cameraPath](const BenchmarkRunner::Scene& benchmarkScene) {
+				// Same seed for every scene, so a scene always gets the same layout
+				Util::SetSeed(options.Seed);
+				if (benchmarkScene.TreesOnly) {
+					EnvironmentGenerator::SetNumToSpawn("models/simplePine.obj", benchmarkScene.Props / 2);
+					EnvironmentGenerator::SetNumToSpawn("models/simpleTree.obj", benchmarkScene.Props - benchmarkScene.Props / 2);
+					EnvironmentGenerator::SetNumToSpawn("models/simpleRock.obj", 0);
+				}
+				else {
+					EnvironmentGenerator::SetNumToSpawn("models/simplePine.obj", benchmarkScene.Props / 3);
+					EnvironmentGenerator::SetNumToSpawn("models/simpleTree.obj", benchmarkScene.Props / 3);
+					EnvironmentGenerator::SetNumToSpawn("models/simpleRock.obj", benchmarkScene.Props - (benchmarkScene.Props / 3) * 2);
+				}
+				// Space the props out as much as the count allows, so every scene still gets all of them
+				float spacing = benchmarkScene.Props > 0 ? 0.3f * sqrtf((100.0f * 100.0f - 12.0f * 12.0f) / benchmarkScene.Props) : 0.0f;
+				EnvironmentGenerator::SetSpawnRadius("models/simplePine.obj", spacing * 1.2f);
+				EnvironmentGenerator::SetSpawnRadius("models/simpleTree.obj", spacing);
+				EnvironmentGenerator::SetSpawnRadius("models/simpleRock.obj", spacing * 0.6f);
+				EnvironmentGenerator::BakeStaticProps = benchmarkScene.Baked;
+				EnvironmentGenerator::InstanceStaticProps = benchmarkScene.Instanced;
+				LodSystem::Enabled = benchmarkScene.Lod;
+				LodSystem::ImpostorsEnabled = benchmarkScene.Impostors;
+				EnvironmentGenerator::RegenerateEnvironment();
+				ResourceTracker::TrackScene(scene->Registry());
+				cameraPath->Reset();
+				// Every scene starts on the same tick boundary
+				fixedTimestep.Reset();
+				FixedTimestep::Snap(scene->Registry());
+			};
+		}
+		else if (options.Stream && !options.Benchmark) {
+			// A world far too big to spawn at once, only the chunks around the camera get made
+			const float worldSize = 4000.0f;
+			const float density = 0.5f;
+			int props = int(density * (worldSize * worldSize - 12.0f * 12.0f));
+			float spacing = 0.3f * sqrtf(1.0f / density);
+			std::vector<glm::vec2> avoidFrom = { glm::vec2(-6.0f, -6.0f) };
+			std::vector<glm::vec2> avoidTo = { glm::vec2(6.0f, 6.0f) };
+			EnvironmentGenerator::AddObjectToGeneration("models/simplePine.obj", propMaterial, props / 3, glm::vec2(-worldSize / 2.0f), glm::vec2(worldSize / 2.0f), avoidFrom, avoidTo, spacing * 1.2f);
+			EnvironmentGenerator::AddObjectToGeneration("models/simpleTree.obj", propMaterial, props / 3, glm::vec2(-worldSize / 2.0f), glm::vec2(worldSize / 2.0f), avoidFrom, avoidTo, spacing);
+			EnvironmentGenerator::AddObjectToGeneration("models/simpleRock.obj", propMaterial, props - (props / 3) * 2, glm::vec2(-worldSize / 2.0f), glm::vec2(worldSize / 2.0f), avoidFrom, avoidTo, spacing * 0.6f);
+			Util::SetSeed(options.Seed);
+			EnvironmentGenerator::StartStreaming(32.0f, 3);
+		}
+
+		// Hills all around the prop area, flattened out under the lego scene in the middle
+		if (options.Terrain && !options.Stream) {
+			Terrain::Settings terrainSettings;
+			terrainSettings.Fbm.Seed = options.Seed;
+			terrainSettings.FlatRadius = 14.0f;
+			terrainSettings.FlatBlend = 10.0f;
+			EnvironmentGenerator::CreateTerrain(terrainSettings);
+		}
+
 		int width, height;
-		glfwGetWindowSize(BackendHandler::window, &width, &height);
+		BackendHandler::GetWindowSize(width, height);
 
 		Framebuffer* colourCorrection;
 		GameObject colorCorrectionObject = scene->CreateEntity("Color Correction Effect");
@@ -522,12 +765,19 @@ int main() {
 			basicEffect->Init(width, height);
 		}
 
+		GameObject upscaleEffectObject = scene->CreateEntity("Upscale Effect");
+		{
+			upscaleEffect = &upscaleEffectObject.emplace<UpscaleEffect>();
+			upscaleEffect->Init(width, height);
+		}
+
 		GameObject greyscaleEffectObject = scene->CreateEntity("Greyscale Effect");
 		{
 			greyscaleEffect = &greyscaleEffectObject.emplace<GreyscaleEffect>();
 			greyscaleEffect->Init(width, height);
 		}
 		effects.push_back(greyscaleEffect);
+		effectNames.push_back("Greyscale Effect");
 
 		GameObject SepiaEffectObject = scene->CreateEntity("Sepia Effect");
 		{
@@ -535,6 +785,7 @@ int main() {
 			sepiaEffect->Init(width, height);
 		}
 		effects.push_back(sepiaEffect);
+		effectNames.push_back("Sepia Effect");
 
 		GameObject BloomEffectObject = scene->CreateEntity("Bloom Effect");
 		{
@@ -542,6 +793,15 @@ int main() {
 			bloomEffect->Init(width, height);
 		}
 		effects.push_back(bloomEffect);
+		effectNames.push_back("Bloom Effect");
+
+		if (options.Effect >= 0 && options.Effect < (int)effects.size())
+			activeEffect = options.Effect;
+
+		for (PostEffect* effect : std::initializer_list<PostEffect*>{ basicEffect, upscaleEffect, greyscaleEffect, sepiaEffect, bloomEffect }) {
+			for (const Shader::sptr& effectShader : effect->GetShaders())
+				ResourceTracker::TrackShader(effectShader);
+		}
 
 		#pragma endregion 
 		//////////////////////////////////////////////////////////////////////////////////////////
@@ -572,8 +832,56 @@ int main() {
 		////////////////////////////////////////////////////////////////////////////////////////
 
 
+		// Renders fixed views of a static scene and checks them against the stored goldens
+		std::unique_ptr<GoldenImageTest> goldenTest;
+		GoldenImageTest::Output goldenOutput = GoldenImageTest::Output::Effect;
+		if (options.Golden) {
+			GoldenImageTest::Settings settings;
+			settings.Directory = options.GoldenDirectory;
+			settings.OutputDirectory = options.GoldenOutput;
+			settings.Update = options.UpdateGolden;
+			settings.MinPSNR = options.MinPSNR;
+			settings.MinSSIM = options.MinSSIM;
+			settings.TimeTolerance = options.TimeTolerance;
+
+			std::vector<GoldenImageTest::Case> cases = GoldenImageTest::DefaultCases();
+			// There's nothing to check the colour correction with if the LUT didn't load
+			if (!testCube.isLoaded()) {
+				printf("LUT did not load, skipping the colour correction golden\n");
+				cases.erase(std::remove_if(cases.begin(), cases.end(), [](const GoldenImageTest::Case& c) {
+					return c.Source == GoldenImageTest::Output::ColourCorrection; }), cases.end());
+			}
+			goldenTest = std::make_unique<GoldenImageTest>(cases, settings);
+
+			// A fresh checkout has no goldens (they depend on the GPU and driver), so say how to make them rather than fail every case
+			std::vector<std::string> missing;
+			if (!settings.Update && !goldenTest->FindGoldens(missing)) {
+				std::string names;
+				for (const std::string& name : missing)
+					names += (names.empty() ? "" : ", ") + name;
+				printf("No goldens found in %s for %s\n", settings.Directory.c_str(), names.c_str());
+				printf("Make them with --update-golden on the machine that runs the checks\n");
+				exitCode = 1;
+				goldenTest.reset();
+			}
+		}
+		if (goldenTest) {
+			// The camera is placed by each case, and nothing else moves
+			BehaviourBinding::Get<CameraControlBehaviour>(cameraObject)->Enabled = false;
+			// The goldens are of the full meshes, so levels of detail can't change what gets compared
+			LodSystem::Enabled = false;
+			goldenTest->SetupCase = [&](const GoldenImageTest::Case& goldenCase) {
+				cameraObject.get<Transform>().SetLocalPosition(goldenCase.CameraPosition).LookAt(goldenCase.CameraTarget);
+				FixedTimestep::Snap(scene->Registry());
+				goldenOutput = goldenCase.Source;
+				if (goldenCase.Source == GoldenImageTest::Output::Effect)
+					activeEffect = goldenCase.Effect;
+			};
+		}
+
 		// We'll use a vector to store all our key press events for now (this should probably be a behaviour eventually)
-		std::vector<KeyPressWatcher> keyToggles;
+		// These are checked through Input rather than GLFW, so they're recorded and replayed with everything else
+		std::vector<std::pair<int, std::function<void()>>> keyToggles;
 		{
 			// This is an example of a key press handling helper. Look at InputHelpers.h an .cpp to see
 			// how this is implemented. Note that the ampersand here is capturing the variables within
@@ -607,45 +915,148 @@ int main() {
 
 		// Initialize our timing instance and grab a reference for our use
 		Timing& time = Timing::Instance();
-		time.LastFrame = glfwGetTime();
+		time.LastFrame = BackendHandler::GetTime();
+
+		// Headless runs render a fixed number of frames at a fixed resolution, and keep every frame's timings
+		int renderedFrames = 0;
+		std::vector<uint8_t> framePixels;
+		// Streams the final image to a video file from a writer thread
+		VideoCapture capture;
+		if (!options.CapturePath.empty()) {
+			VideoCapture::Format format = std::filesystem::path(options.CapturePath).extension() == ".y4m" ?
+				VideoCapture::Format::Y4M : VideoCapture::Format::Raw;
+			if (!capture.Start(options.CapturePath, width, height, options.CaptureFps, format, options.CaptureQueue))
+				printf("Could not start capturing to %s\n", options.CapturePath.c_str());
+		}
+
+		// Async readback hands frames over a few frames late, so we remember which buffer still has some in flight
+		bool readFrames = options.ForceReadback || !options.OutputDirectory.empty() || capture.IsCapturing();
+		bool asyncReadback = options.Readback == "async";
+		Framebuffer* readbackBuffer = nullptr;
+		// CPU time spent reading back (and writing out) each frame, and how late (in frames and ms) each one arrives
+		std::vector<float> readbackTimes;
+		std::vector<float> readbackDelays;
+		std::map<uint64_t, std::chrono::steady_clock::time_point> readbackStarts;
+		int readbackLatency = 0;
+		int readbacksDone = 0;
+		auto writeFrame = [&](const uint8_t* pixels, unsigned frameWidth, unsigned frameHeight, uint64_t frame) {
+			readbackLatency += renderedFrames - int(frame);
+			readbacksDone++;
+			auto start = readbackStarts.find(frame);
+			if (start != readbackStarts.end()) {
+				readbackDelays.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start->second).count());
+				readbackStarts.erase(start);
+			}
+			if (capture.IsCapturing())
+				capture.Submit(pixels, frameWidth, frameHeight);
+			if (options.OutputDirectory.empty())
+				return;
+			char fileName[32];
+			snprintf(fileName, sizeof(fileName), "frame_%05d.ppm", int(frame));
+			ImageIO::WritePPM((std::filesystem::path(options.OutputDirectory) / fileName).string(), frameWidth, frameHeight, pixels);
+		};
+		if (options.Headless || benchmark) {
+			dynamicResolution.Enabled = false;
+			// Benchmarks and goldens need to keep the frames of every scene
+			frameStats.SetWindowSize(benchmark || goldenTest ? FrameStats::CAPACITY : options.Frames);
+			if (!options.OutputDirectory.empty())
+				std::filesystem::create_directories(options.OutputDirectory);
+		}
+
+		// Start the loop from the seed as well, so the random numbers it gets don't depend on how many setup used
+		if (!options.ReplayPath.empty() || !options.RecordPath.empty())
+			Util::SetSeed(options.Seed);
+
+		// Everything that renders is in the scene by now, so its meshes and shaders can be counted
+		ResourceTracker::TrackScene(scene->Registry());
+
+		// Anything that failed during setup has already said why, so there's nothing to run or report
+		const bool setupFailed = exitCode != 0;
 
 		///// Game loop /////
-		while (!glfwWindowShouldClose(BackendHandler::window)) {
-			glfwPollEvents();
+		while (!BackendHandler::ShouldClose() && !setupFailed) {
+			// Replays run for exactly as many frames as were recorded
+			if (Input::IsReplaying() && Input::IsReplayFinished())
+				break;
+			if (benchmark) {
+				// The frame we're about to record is the next one in the stats
+				if (!benchmark->BeginFrame(frameStats.GetFrameCount()))
+					break;
+			}
+			else if (goldenTest) {
+				if (!goldenTest->BeginFrame(frameStats.GetFrameCount()))
+					break;
+			}
+			else if (options.Headless && !Input::IsReplaying() && renderedFrames >= options.Frames)
+				break;
+
+			frameStats.BeginFrame();
+			BackendHandler::PollEvents();
 
 			// Update the timing
-			time.CurrentFrame = glfwGetTime();
+			time.CurrentFrame = BackendHandler::GetTime();
 			time.DeltaTime = static_cast<float>(time.CurrentFrame - time.LastFrame);
 
+			// Feed the unclamped frame time to the resolution controller, and resize the scene buffer to match
+			dynamicResolution.Update(time.DeltaTime * 1000.0f);
+			BackendHandler::GetWindowSize(width, height);
+			dynamicResolution.Apply(basicEffect, width, height);
+
 			time.DeltaTime = time.DeltaTime > 1.0f ? 1.0f : time.DeltaTime;
+			// Benchmarks always step the same amount so every run sees the same frames
+			if (benchmark)
+				time.DeltaTime = benchmark->GetTimestep();
+			// Golden images are of a still scene
+			if (goldenTest)
+				time.DeltaTime = 0.0f;
 
-			// Update our FPS tracker data
-			fpsBuffer[frameIx] = 1.0f / time.DeltaTime;
-			frameIx++;
-			if (frameIx >= 128)
-				frameIx = 0;
+			// Grab this frame's input, a replay swaps in the recorded input and delta time here
+			Input::Update(BackendHandler::window, time.DeltaTime, !options.Headless && ImGui::IsAnyWindowFocused());
 
 			// We'll make sure our UI isn't focused before we start handling input for our game
-			if (!ImGui::IsAnyWindowFocused()) {
-				// We need to poll our key watchers so they can do their logic with the GLFW state
-				// Note that since we want to make sure we don't copy our key handlers, we need a const
-				// reference!
-				for (const KeyPressWatcher& watcher : keyToggles) {
-					watcher.Poll(BackendHandler::window);
+			if (!Input::IsUIFocused()) {
+				for (const auto& toggle : keyToggles) {
+					if (Input::WasKeyPressed(toggle.first))
+						toggle.second();
 				}
 			}
 
-			// Iterate over all the behaviour binding components
-			scene->Registry().view<BehaviourBinding>().each([&](entt::entity entity, BehaviourBinding& binding) {
-				// Iterate over all the behaviour scripts attached to the entity, and update them in sequence (if enabled)
-				for (const auto& behaviour : binding.Behaviours) {
-					if (behaviour->Enabled) {
-						behaviour->Update(entt::handle(scene->Registry(), entity));
+			// Run as many simulation ticks as fit in this frame, behaviours see the tick length as their delta time
+			float frameDeltaTime = time.DeltaTime;
+			int ticks = fixedTimestep.Advance(frameDeltaTime);
+			if (fixedTimestep.Enabled)
+				time.DeltaTime = fixedTimestep.GetStep();
+			for (int tick = 0; tick < ticks; tick++) {
+				if (fixedTimestep.Enabled)
+					FixedTimestep::StoreState(scene->Registry());
+
+				// Iterate over all the behaviour binding components
+				scene->Registry().view<BehaviourBinding>().each([&](entt::entity entity, BehaviourBinding& binding) {
+					// Iterate over all the behaviour scripts attached to the entity, and update them in sequence (if enabled)
+					for (const auto& behaviour : binding.Behaviours) {
+						if (behaviour->Enabled) {
+							behaviour->Update(entt::handle(scene->Registry(), entity));
+						}
 					}
-				}
-			});
+				});
+			}
+			time.DeltaTime = frameDeltaTime;
+
+			// Swap in the prop chunks around where the camera ended up
+			EnvironmentGenerator::UpdateStreaming(cameraObject.get<Transform>().GetLocalPosition());
+
+			// Render everything partway between the last two ticks, it gets put back once the scene is drawn
+			bool interpolated = fixedTimestep.Enabled && fixedTimestep.Interpolate;
+			if (interpolated)
+				FixedTimestep::ApplyInterpolation(scene->Registry(), fixedTimestep.GetAlpha());
+
+			// Start timing the GPU work for this frame, this also gives us the GPU time of an older frame
+			GpuProfiler::BeginFrame();
+			for (const GpuProfiler::FrameResult& result : GpuProfiler::GetCollectedFrames())
+				frameStats.RecordGpuTime(result.Frame, result.Time);
 
 			// Clear the screen
+			GpuProfiler::BeginPass("Clear");
 			basicEffect->Clear();
 			//colourCorrection->Clear();
 			/*greyscaleEffect->Clear();
@@ -660,6 +1071,7 @@ int main() {
 			glEnable(GL_DEPTH_TEST);
 			glClearDepth(1.0f);
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			GpuProfiler::EndPass();
 
 			// Update all world matrices for this frame
 			scene->Registry().view<Transform>().each([](entt::entity entity, Transform& t) {
@@ -671,6 +1083,9 @@ int main() {
 			glm::mat4 view = glm::inverse(camTransform.LocalTransform());
 			glm::mat4 projection = cameraObject.get<Camera>().GetProjection();
 			glm::mat4 viewProjection = projection * view;
+
+			// Swap in the level of detail that suits how big each mesh is on screen
+			LodSystem::Update(scene->Registry(), camTransform.GetLocalPosition(), projection);
 						
 			// Sort the renderers by shader and material, we will go for a minimizing context switches approach here,
 			// but you could for instance sort front to back to optimize for fill rate if you have intensive fragment shaders
@@ -695,24 +1110,74 @@ int main() {
 			ShaderMaterial::sptr currentMat = nullptr;
 
 			basicEffect->BindBuffer(0);
+			basicEffect->SetViewport(0);
 			//colourCorrection->Bind();
 
+			// The skybox is on its own render layer, so we time it separately from the rest of the scene
+			int currentLayer = INT_MIN;
+			int drawCalls = 0;
+			float currentFade = -1.0f;
+
 			// Iterate over the render group components and draw them
 			renderGroup.each( [&](entt::entity e, RendererComponent& renderer, Transform& transform) {
+				// Static batches cover a whole cell of props, so they're worth skipping when they're off screen
+				const StaticBatch::Bounds* bounds = scene->Registry().try_get<StaticBatch::Bounds>(e);
+				if (bounds != nullptr && !bounds->IsVisible(viewProjection))
+					return;
+				// Things that have fully turned into impostors have no mesh left to draw
+				if (renderer.Mesh == nullptr)
+					return;
+				if (currentLayer != renderer.Material->RenderLayer) {
+					if (currentLayer != INT_MIN)
+						GpuProfiler::EndPass();
+					currentLayer = renderer.Material->RenderLayer;
+					GpuProfiler::BeginPass(currentLayer >= 100 ? "Skybox" : "Scene");
+				}
 				// If the shader has changed, set up it's uniforms
 				if (current != renderer.Material->Shader) {
 					current = renderer.Material->Shader;
 					current->Bind();
 					BackendHandler::SetupShaderForFrame(current, view, projection);
+					currentFade = -1.0f;
+				}
+				// Meshes partway into their impostor get dithered out
+				const LodGroup* lod = scene->Registry().try_get<LodGroup>(e);
+				float fade = lod != nullptr ? lod->Fade : 0.0f;
+				if (fade != currentFade) {
+					currentFade = fade;
+					current->SetUniform("u_ImpostorFade", fade);
 				}
 				// If the material has changed, apply it
 				if (currentMat != renderer.Material) {
 					currentMat = renderer.Material;
 					currentMat->Apply();
 				}
-				// Render the mesh
-				BackendHandler::RenderVAO(renderer.Material->Shader, renderer.Mesh, viewProjection, transform);
+				// Render the mesh, instance batches draw every copy in one go
+				const InstanceBatch::Instances* instances = scene->Registry().try_get<InstanceBatch::Instances>(e);
+				if (instances != nullptr)
+					instances->Render(renderer.Mesh);
+				else
+					BackendHandler::RenderVAO(renderer.Material->Shader, renderer.Mesh, viewProjection, transform);
+				drawCalls++;
 			});
+			if (currentLayer != INT_MIN)
+				GpuProfiler::EndPass();
+
+			// The ground picks its own level of detail for every node it draws
+			const Terrain::sptr& terrain = EnvironmentGenerator::GetTerrain();
+			if (terrain != nullptr) {
+				GpuProfiler::BeginPass("Terrain");
+				drawCalls += terrain->Render(viewProjection, camTransform.GetLocalPosition());
+				GpuProfiler::EndPass();
+			}
+
+			// Far away props, drawn as cards facing the camera
+			GpuProfiler::BeginPass("Impostors");
+			drawCalls += LodSystem::RenderImpostors(viewProjection, camTransform.GetLocalPosition());
+			GpuProfiler::EndPass();
+
+			if (interpolated)
+				FixedTimestep::RestoreState(scene->Registry());
 
 			/*colourCorrection->Unbind();
 
@@ -725,25 +1190,177 @@ int main() {
 			colourCorrectionShader->UnBind();*/
 
 			basicEffect->UnbindBuffer();
-			effects[activeEffect]->ApplyEffect(basicEffect);
-			effects[activeEffect]->DrawToScreen();
 
-			// Draw our ImGui content
-			BackendHandler::RenderImGui();
+			// If the scene was rendered below full resolution, upscale it before the effect chain
+			PostEffect* sceneOutput = basicEffect;
+			if (dynamicResolution.IsScaled())
+			{
+				GpuProfiler::Scope upscaleTimer("Upscale");
+				upscaleEffect->ApplyEffect(basicEffect);
+				sceneOutput = upscaleEffect;
+			}
+
+			// The buffer that ends up being the frame, golden cases can look at the scene or the colour correction instead
+			Framebuffer* output = nullptr;
+			if (goldenTest && goldenOutput == GoldenImageTest::Output::Scene) {
+				output = sceneOutput->GetBuffer();
+			}
+			else if (goldenTest && goldenOutput == GoldenImageTest::Output::ColourCorrection) {
+				GpuProfiler::Scope colourTimer("Colour Correction");
+				colourCorrection->Clear();
+				colourCorrectionShader->Bind();
+				sceneOutput->BindColorAsTexture(0, 0, 0);
+				testCube.bind(30);
+				colourCorrection->RenderToFSQ();
+				testCube.unbind(30);
+				sceneOutput->UnbindTexture(0);
+				colourCorrectionShader->UnBind();
+				output = colourCorrection;
+			}
+			else {
+				GpuProfiler::Scope effectTimer(effectNames[activeEffect]);
+				effects[activeEffect]->ApplyEffect(sceneOutput);
+				output = effects[activeEffect]->GetBuffer();
+			}
+
+			// Golden images need this exact frame, so they're read back straight away
+			if (goldenTest && goldenTest->IsCaptureFrame()) {
+				output->ReadColorPixels(0, framePixels);
+				goldenTest->Capture(framePixels, output->_width, output->_height);
+			}
+			else if (readFrames) {
+				GpuProfiler::Scope readTimer("Readback");
+				auto readStart = std::chrono::steady_clock::now();
+				readbackStarts[renderedFrames] = readStart;
+				if (asyncReadback) {
+					// Anything left in the last buffer's ring has to come out before we switch
+					if (readbackBuffer != nullptr && readbackBuffer != output)
+						readbackBuffer->PollReadbacks(true);
+					readbackBuffer = output;
+					if (!output->ReadColorPixelsAsync(0, writeFrame, renderedFrames))
+						readbackStarts.erase(renderedFrames);
+				}
+				else {
+					output->ReadColorPixels(0, framePixels);
+					writeFrame(framePixels.data(), output->_width, output->_height, renderedFrames);
+				}
+				readbackTimes.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - readStart).count());
+			}
+
+			if (!options.Headless) {
+				{
+					GpuProfiler::Scope drawTimer("Draw To Screen");
+					effects[activeEffect]->DrawToScreen();
+				}
+
+				// Draw our ImGui content
+				{
+					GpuProfiler::Scope imGuiTimer("ImGui");
+					BackendHandler::RenderImGui();
+				}
+			}
+			GpuProfiler::EndFrame();
 
 			scene->Poll();
-			glfwSwapBuffers(BackendHandler::window);
+			ResourceTracker::Update();
+			frameStats.EndCpu();
+			BackendHandler::SwapBuffers();
+			frameStats.EndFrame();
+			if (benchmark)
+				benchmark->EndFrame(frameStats, drawCalls, LodSystem::GetTriangleCount());
+			if (goldenTest)
+				goldenTest->EndFrame();
 			time.LastFrame = time.CurrentFrame;
+			renderedFrames++;
+		}
+
+		Input::StopRecording();
+		Input::StopReplay();
+
+		if (readbackBuffer != nullptr)
+			readbackBuffer->PollReadbacks(true);
+		// Waits for the writer to get everything on disk
+		capture.Stop();
+
+		if (!setupFailed && (options.Headless || benchmark)) {
+			// Pick up the GPU times of the last few frames, everything is finished by now
+			GpuProfiler::BeginFrame();
+			GpuProfiler::EndFrame();
+			for (const GpuProfiler::FrameResult& result : GpuProfiler::GetCollectedFrames())
+				frameStats.RecordGpuTime(result.Frame, result.Time);
+
+			// Report the timing of every frame
+			if (benchmark) {
+				if (benchmark->WriteResults(options.BenchmarkOutput, frameStats, width, height, options.Seed))
+					printf("Wrote benchmark results to %s\n", options.BenchmarkOutput.c_str());
+			}
+			if (goldenTest) {
+				if (!goldenTest->Finish(frameStats))
+					exitCode = 1;
+			}
+
+			std::vector<FrameStats::Sample> samples;
+			frameStats.CopyWindow(samples);
+			std::string timingPath = options.OutputDirectory.empty() ? "frame_timings.csv" :
+				(std::filesystem::path(options.OutputDirectory) / "frame_timings.csv").string();
+			std::ofstream timings(timingPath);
+			timings << "frame,cpu_ms,gpu_ms,present_ms\n";
+			for (const FrameStats::Sample& sample : samples) {
+				timings << sample.Frame << "," << sample.CpuTime << "," << sample.GpuTime << "," << sample.PresentInterval << "\n";
+			}
+
+			FrameStats::Summary summary = frameStats.GetSummary();
+			printf("Rendered %d frames at %dx%d\n", renderedFrames, options.Width, options.Height);
+			printf("CPU     p50 %.3f ms  p95 %.3f ms  p99 %.3f ms\n", summary.Cpu.P50, summary.Cpu.P95, summary.Cpu.P99);
+			printf("GPU     p50 %.3f ms  p95 %.3f ms  p99 %.3f ms\n", summary.Gpu.P50, summary.Gpu.P95, summary.Gpu.P99);
+			printf("Frame   p50 %.3f ms  p95 %.3f ms  p99 %.3f ms\n", summary.Present.P50, summary.Present.P95, summary.Present.P99);
+			printf("Memory  GPU %.2f MB (peak %.2f MB)  CPU %.2f MB (peak %.2f MB)\n",
+				ResourceTracker::GetGpuBytes() / (1024.0 * 1024.0), ResourceTracker::GetPeakGpuBytes() / (1024.0 * 1024.0),
+				ResourceTracker::GetCpuBytes() / (1024.0 * 1024.0), ResourceTracker::GetPeakCpuBytes() / (1024.0 * 1024.0));
+			if (!readbackTimes.empty()) {
+				// Frame time and delivery are what to compare between the modes, the readback CPU time alone hides sync's stall in the swap
+				FrameStats::Distribution readback = FrameStats::Describe(readbackTimes);
+				FrameStats::Distribution delivery = FrameStats::Describe(readbackDelays);
+				printf("Readback (%s) p50 %.3f ms  p95 %.3f ms  max %.3f ms, %d frames, %.2f frames late",
+					options.Readback.c_str(), readback.P50, readback.P95, readback.Max, readbacksDone,
+					readbacksDone > 0 ? float(readbackLatency) / readbacksDone : 0.0f);
+				if (readbackBuffer != nullptr)
+					printf(", %llu dropped", (unsigned long long)readbackBuffer->GetDroppedReadbacks());
+				printf("\n");
+				printf("Delivery (%s) p50 %.3f ms  p95 %.3f ms  max %.3f ms, frame p50 %.3f ms  p95 %.3f ms\n",
+					options.Readback.c_str(), delivery.P50, delivery.P95, delivery.Max, summary.Present.P50, summary.Present.P95);
+			}
+		}
+
+		if (!setupFailed) {
+			// Dump the frame stats so we can compare between builds
+			frameStats.WriteJson(options.OutputDirectory.empty() ? "frame_stats.json" :
+				(std::filesystem::path(options.OutputDirectory) / "frame_stats.json").string());
+			// Along with what the resources were using (and the most they ever used)
+			ResourceTracker::WriteJson(options.OutputDirectory.empty() ? "resources.json" :
+				(std::filesystem::path(options.OutputDirectory) / "resources.json").string());
 		}
 
 		// Nullify scene so that we can release references
 		Application::Instance().ActiveScene = nullptr;
 		//Clean up the environment generator so we can release references
 		EnvironmentGenerator::CleanUpPointers();
-		BackendHandler::ShutdownImGui();
+		LodChain::ClearCache();
+		LodSystem::Release();
+		GpuProfiler::Shutdown();
+		if (!options.Headless)
+			BackendHandler::ShutdownImGui();
 	}	
 
+	// Nothing else is going to come through the debug callback, so write out whatever is left
+	glDebugMessageCallback(nullptr, nullptr);
+	GlDebugLog::Stop();
+
+	// The context has to outlive everything that was holding GL objects
+	if (options.Headless)
+		BackendHandler::ShutdownHeadless();
+
 	// Clean up the toolkit logger so we don't leak memory
 	Logger::Uninitialize();
-	return 0;
+	return exitCode;
 }
\ No newline at end of file